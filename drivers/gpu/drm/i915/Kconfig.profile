@@ -106,6 +106,20 @@ config DRM_I915_MAX_REQUEST_BUSYWAIT
 	  the cost of enabling the interrupt (if currently disabled) to be
 	  a few microseconds.
 
+config DRM_I915_ADAPTIVE_BUSYWAIT
+	bool "Learn the busywait budget from past request waits"
+	default n
+	depends on DRM_I915_MAX_REQUEST_BUSYWAIT != 0
+	help
+	  Keep a short history per engine of how long waiters had to wait
+	  for its requests to complete, and use that to choose how long to
+	  busywait. If the requests on an engine usually complete quickly,
+	  we only spin for about as long as they usually take; if they
+	  usually take longer than the busywait limit, we go straight to
+	  sleep rather than burn the CPU for nothing.
+
+	  The busywait limit above remains the upper bound on the spin.
+
 config DRM_I915_STOP_TIMEOUT
 	int "How long to wait for an engine to quiesce gracefully before reset (ms)"
 	default 100 # milliseconds
@@ -137,3 +151,21 @@ config DRM_I915_TIMESLICE_DURATION
 	  /sys/class/drm/card?/engine/*/timeslice_duration_ms
 
 	  May be 0 to disable timeslicing.
+
+config DRM_I915_DEFERRED_PRIORITY
+	bool "Defer priority inheritance to the submission tasklet"
+	default n
+	help
+	  Raising the priority of a request also raises the priority of all
+	  the requests it depends upon, walking the dependency graph under
+	  the scheduler locks. With deep dependency chains and frequent
+	  boosts, that walk may be repeated many times over the same
+	  requests.
+
+	  If enabled, boosts to requests already queued are recorded and
+	  propagated in a single batch from the engine's submission tasklet,
+	  coalescing repeated boosts of the same request and walking each
+	  request at most once per batch. The new priority then takes
+	  effect on the next tasklet run rather than immediately.
+
+	  If in doubt, say "N".
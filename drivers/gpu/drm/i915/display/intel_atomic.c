@@ -37,6 +37,7 @@
 #include "i915_reg.h"
 #include "intel_atomic.h"
 #include "intel_cdclk.h"
+#include "intel_color.h"
 #include "intel_display_types.h"
 #include "intel_global_state.h"
 #include "intel_hdcp.h"
@@ -258,6 +259,9 @@ intel_crtc_duplicate_state(struct drm_crtc *crtc)
 	if (crtc_state->post_csc_lut)
 		drm_property_blob_get(crtc_state->post_csc_lut);
 
+	intel_color_lut_image_get(crtc_state->pre_csc_lut_image);
+	intel_color_lut_image_get(crtc_state->post_csc_lut_image);
+
 	crtc_state->update_pipe = false;
 	crtc_state->update_m_n = false;
 	crtc_state->update_lrr = false;
@@ -272,6 +276,7 @@ intel_crtc_duplicate_state(struct drm_crtc *crtc)
 	crtc_state->fb_bits = 0;
 	crtc_state->update_planes = 0;
 	crtc_state->dsb = NULL;
+	crtc_state->dsb_commit = NULL;
 
 	return &crtc_state->uapi;
 }
@@ -284,6 +289,9 @@ static void intel_crtc_put_color_blobs(struct intel_crtc_state *crtc_state)
 
 	drm_property_blob_put(crtc_state->pre_csc_lut);
 	drm_property_blob_put(crtc_state->post_csc_lut);
+
+	intel_color_lut_image_put(crtc_state->pre_csc_lut_image);
+	intel_color_lut_image_put(crtc_state->post_csc_lut_image);
 }
 
 void intel_crtc_free_hw_state(struct intel_crtc_state *crtc_state)
@@ -306,6 +314,7 @@ intel_crtc_destroy_state(struct drm_crtc *crtc,
 	struct intel_crtc_state *crtc_state = to_intel_crtc_state(state);
 
 	drm_WARN_ON(crtc->dev, crtc_state->dsb);
+	drm_WARN_ON(crtc->dev, crtc_state->dsb_commit);
 
 	__drm_atomic_helper_crtc_destroy_state(&crtc_state->uapi);
 	intel_crtc_free_hw_state(crtc_state);
@@ -403,6 +403,48 @@ static bool intel_wm_need_update(const struct intel_plane_state *cur,
 	return false;
 }
 
+/**
+ * intel_plane_global_inputs_equal - check if a plane update affects global state
+ * @old_plane_state: the old plane state
+ * @new_plane_state: the new, already checked, plane state
+ *
+ * Compares everything that the watermark, DDB, bandwidth and cdclk
+ * computations derive from the plane state. An update that only swaps the
+ * framebuffer (keeping its format and modifier) or moves the source/destination
+ * rectangles around without resizing them doesn't change any of these.
+ *
+ * Returns: true if the derived global state of @old_plane_state still holds
+ * for @new_plane_state.
+ */
+bool intel_plane_global_inputs_equal(const struct intel_plane_state *old_plane_state,
+				     const struct intel_plane_state *new_plane_state)
+{
+	const struct drm_framebuffer *old_fb = old_plane_state->hw.fb;
+	const struct drm_framebuffer *new_fb = new_plane_state->hw.fb;
+
+	if (old_plane_state->hw.crtc != new_plane_state->hw.crtc ||
+	    old_plane_state->uapi.visible != new_plane_state->uapi.visible)
+		return false;
+
+	if (!old_fb != !new_fb)
+		return false;
+
+	if (new_fb &&
+	    (old_fb->format->format != new_fb->format->format ||
+	     old_fb->modifier != new_fb->modifier))
+		return false;
+
+	if (old_plane_state->hw.rotation != new_plane_state->hw.rotation ||
+	    drm_rect_width(&old_plane_state->uapi.src) != drm_rect_width(&new_plane_state->uapi.src) ||
+	    drm_rect_height(&old_plane_state->uapi.src) != drm_rect_height(&new_plane_state->uapi.src) ||
+	    drm_rect_width(&old_plane_state->uapi.dst) != drm_rect_width(&new_plane_state->uapi.dst) ||
+	    drm_rect_height(&old_plane_state->uapi.dst) != drm_rect_height(&new_plane_state->uapi.dst))
+		return false;
+
+	return old_plane_state->planar_linked_plane == new_plane_state->planar_linked_plane &&
+		old_plane_state->planar_slave == new_plane_state->planar_slave;
+}
+
 static bool intel_plane_is_scaled(const struct intel_plane_state *plane_state)
 {
 	int src_w = drm_rect_width(&plane_state->uapi.src) >> 16;
@@ -1176,3 +1218,9 @@ void intel_plane_helper_add(struct intel_plane *plane)
 {
 	drm_plane_helper_add(&plane->base, &intel_plane_helper_funcs);
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#ifdef I915
+#include "selftest_atomic_plane.c"
+#endif
+#endif
@@ -952,6 +952,202 @@ static void ilk_lut_12p4_pack(struct drm_color_lut *entry, u32 ldw, u32 udw)
 		REG_FIELD_GET(PREC_PALETTE_12P4_BLUE_LDW_MASK, ldw);
 }
 
+static int glk_degamma_lut_size(struct drm_i915_private *i915)
+{
+	if (DISPLAY_VER(i915) >= 13)
+		return 131;
+	else
+		return 35;
+}
+
+static u32 glk_degamma_lut(const struct drm_color_lut *color)
+{
+	return color->green;
+}
+
+static void glk_degamma_lut_pack(struct drm_color_lut *entry, u32 val)
+{
+	/* PRE_CSC_GAMC_DATA is 3.16, clamp to 0.16 */
+	entry->red = entry->green = entry->blue = min(val, 0xffffu);
+}
+
+static u32 mtl_degamma_lut(const struct drm_color_lut *color)
+{
+	return drm_color_lut_extract(color->green, 24);
+}
+
+static void mtl_degamma_lut_pack(struct drm_color_lut *entry, u32 val)
+{
+	/* PRE_CSC_GAMC_DATA is 3.24, clamp to 0.16 */
+	entry->red = entry->green = entry->blue =
+		intel_color_lut_pack(min(val, 0xffffffu), 24);
+}
+
+/* Layout of the ICL+ 12.4 multi segmented gamma LUT image */
+#define ICL_MULTI_SEG_SUPERFINE		0
+#define ICL_MULTI_SEG_SUPERFINE_SIZE	(9 * 2)
+#define ICL_MULTI_SEG_FINE		ICL_MULTI_SEG_SUPERFINE_SIZE
+#define ICL_MULTI_SEG_FINE_SIZE		(256 * 2)
+#define ICL_MULTI_SEG_COARSE		(ICL_MULTI_SEG_FINE + ICL_MULTI_SEG_FINE_SIZE)
+#define ICL_MULTI_SEG_COARSE_SIZE	(256 * 2)
+#define ICL_MULTI_SEG_SIZE		(ICL_MULTI_SEG_COARSE + ICL_MULTI_SEG_COARSE_SIZE)
+
+enum intel_lut_format {
+	INTEL_LUT_FORMAT_NONE,
+	INTEL_LUT_FORMAT_8,
+	INTEL_LUT_FORMAT_10,
+	INTEL_LUT_FORMAT_GLK_DEGAMMA,
+	INTEL_LUT_FORMAT_MTL_DEGAMMA,
+	INTEL_LUT_FORMAT_ICL_MULTI_SEG,
+};
+
+/*
+ * A LUT blob packed into the exact sequence of register values
+ * the load_luts() hooks write, so that reloading the same blob
+ * doesn't need to convert every entry again.
+ */
+struct intel_lut_image {
+	struct kref ref;
+	/* holds a reference, so the key can't be reused under us */
+	struct drm_property_blob *blob;
+	enum intel_lut_format format;
+	int num_words;
+	u32 words[];
+};
+
+static int lut_image_size(struct drm_i915_private *i915,
+			  enum intel_lut_format format,
+			  const struct drm_property_blob *blob)
+{
+	switch (format) {
+	case INTEL_LUT_FORMAT_8:
+		return LEGACY_LUT_LENGTH;
+	case INTEL_LUT_FORMAT_10:
+		return drm_color_lut_size(blob);
+	case INTEL_LUT_FORMAT_GLK_DEGAMMA:
+	case INTEL_LUT_FORMAT_MTL_DEGAMMA:
+		/* the extended range entries are clamped to 1.0 */
+		return max(drm_color_lut_size(blob), glk_degamma_lut_size(i915));
+	case INTEL_LUT_FORMAT_ICL_MULTI_SEG:
+		return ICL_MULTI_SEG_SIZE;
+	default:
+		MISSING_CASE(format);
+		return 0;
+	}
+}
+
+static u32 icl_multi_seg_word(const struct drm_color_lut *lut, int i)
+{
+	const struct drm_color_lut *entry;
+
+	if (i < ICL_MULTI_SEG_FINE)
+		/* superfine: the first 9 entries */
+		entry = &lut[(i - ICL_MULTI_SEG_SUPERFINE) / 2];
+	else if (i < ICL_MULTI_SEG_COARSE)
+		/* fine: every 8th entry, skipping the unused seg2[0] */
+		entry = &lut[((i - ICL_MULTI_SEG_FINE) / 2 + 1) * 8];
+	else
+		/* coarse: every (8 * 128)th entry */
+		entry = &lut[(i - ICL_MULTI_SEG_COARSE) / 2 * 8 * 128];
+
+	return i & 1 ? ilk_lut_12p4_udw(entry) : ilk_lut_12p4_ldw(entry);
+}
+
+/* The @i'th register value of @blob converted to @format */
+static u32 lut_image_word(struct drm_i915_private *i915,
+			  enum intel_lut_format format,
+			  const struct drm_property_blob *blob, int i)
+{
+	const struct drm_color_lut *lut = blob->data;
+
+	switch (format) {
+	case INTEL_LUT_FORMAT_8:
+		return i9xx_lut_8(&lut[i]);
+	case INTEL_LUT_FORMAT_10:
+		return ilk_lut_10(&lut[i]);
+	case INTEL_LUT_FORMAT_GLK_DEGAMMA:
+		if (i >= drm_color_lut_size(blob))
+			return 1 << 16;
+		return glk_degamma_lut(&lut[i]);
+	case INTEL_LUT_FORMAT_MTL_DEGAMMA:
+		if (i >= drm_color_lut_size(blob))
+			return 1 << 24;
+		return mtl_degamma_lut(&lut[i]);
+	case INTEL_LUT_FORMAT_ICL_MULTI_SEG:
+		return icl_multi_seg_word(lut, i);
+	default:
+		MISSING_CASE(format);
+		return 0;
+	}
+}
+
+static struct intel_lut_image *
+intel_lut_image_create(struct drm_i915_private *i915,
+		       struct drm_property_blob *blob,
+		       enum intel_lut_format format)
+{
+	struct intel_lut_image *image;
+	int i, num_words;
+
+	num_words = lut_image_size(i915, format, blob);
+
+	image = kvmalloc(struct_size(image, words, num_words), GFP_KERNEL);
+	if (!image)
+		return ERR_PTR(-ENOMEM);
+
+	kref_init(&image->ref);
+	image->blob = drm_property_blob_get(blob);
+	image->format = format;
+	image->num_words = num_words;
+
+	for (i = 0; i < num_words; i++)
+		image->words[i] = lut_image_word(i915, format, blob, i);
+
+	return image;
+}
+
+static void intel_lut_image_release(struct kref *ref)
+{
+	struct intel_lut_image *image = container_of(ref, typeof(*image), ref);
+
+	drm_property_blob_put(image->blob);
+	kvfree(image);
+}
+
+struct intel_lut_image *intel_color_lut_image_get(struct intel_lut_image *image)
+{
+	if (image)
+		kref_get(&image->ref);
+
+	return image;
+}
+
+void intel_color_lut_image_put(struct intel_lut_image *image)
+{
+	if (image)
+		kref_put(&image->ref, intel_lut_image_release);
+}
+
+static bool lut_image_matches(const struct intel_lut_image *image,
+			      const struct drm_property_blob *blob,
+			      enum intel_lut_format format)
+{
+	return image && image->blob == blob && image->format == format;
+}
+
+static const u32 *lut_image_words(const struct intel_crtc_state *crtc_state,
+				  const struct drm_property_blob *blob,
+				  enum intel_lut_format format)
+{
+	if (lut_image_matches(crtc_state->pre_csc_lut_image, blob, format))
+		return crtc_state->pre_csc_lut_image->words;
+
+	if (lut_image_matches(crtc_state->post_csc_lut_image, blob, format))
+		return crtc_state->post_csc_lut_image->words;
+
+	return NULL;
+}
+
 static void icl_color_commit_noarm(const struct intel_crtc_state *crtc_state)
 {
 	/*
@@ -1314,18 +1510,52 @@ static void ilk_lut_write(const struct intel_crtc_state *crtc_state,
 		intel_de_write_fw(i915, reg, val);
 }
 
+/*
+ * Write words [@start, @start + @count) of the @format image
+ * of @blob to the auto-incrementing data register @reg.
+ */
+static void ilk_lut_write_image(const struct intel_crtc_state *crtc_state,
+				i915_reg_t reg,
+				const struct drm_property_blob *blob,
+				enum intel_lut_format format,
+				int start, int count)
+{
+	struct drm_i915_private *i915 = to_i915(crtc_state->uapi.crtc->dev);
+	const u32 *words = lut_image_words(crtc_state, blob, format);
+	int i;
+
+	/* Not packed by intel_color_check(), eg. read out from the hardware */
+	if (!words) {
+		for (i = start; i < start + count; i++)
+			ilk_lut_write(crtc_state, reg,
+				      lut_image_word(i915, format, blob, i));
+		return;
+	}
+
+	if (crtc_state->dsb) {
+		intel_dsb_reg_write_indexed(crtc_state->dsb, reg,
+					    words + start, count);
+		return;
+	}
+
+	for (i = start; i < start + count; i++)
+		intel_de_write_fw(i915, reg, words[i]);
+}
+
 static void ilk_load_lut_8(const struct intel_crtc_state *crtc_state,
 			   const struct drm_property_blob *blob)
 {
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
 	const struct drm_color_lut *lut;
 	enum pipe pipe = crtc->pipe;
+	const u32 *words;
 	int i;
 
 	if (!blob)
 		return;
 
 	lut = blob->data;
+	words = lut_image_words(crtc_state, blob, INTEL_LUT_FORMAT_8);
 
 	/*
 	 * DSB fails to correctly load the legacy LUT
@@ -1337,7 +1567,7 @@ static void ilk_load_lut_8(const struct intel_crtc_state *crtc_state,
 
 	for (i = 0; i < 256; i++)
 		ilk_lut_write(crtc_state, LGC_PALETTE(pipe, i),
-			      i9xx_lut_8(&lut[i]));
+			      words ? words[i] : i9xx_lut_8(&lut[i]));
 
 	if (crtc_state->dsb)
 		intel_dsb_nonpost_end(crtc_state->dsb);
@@ -1348,12 +1578,13 @@ static void ilk_load_lut_10(const struct intel_crtc_state *crtc_state,
 {
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
 	const struct drm_color_lut *lut = blob->data;
+	const u32 *words = lut_image_words(crtc_state, blob, INTEL_LUT_FORMAT_10);
 	int i, lut_size = drm_color_lut_size(blob);
 	enum pipe pipe = crtc->pipe;
 
 	for (i = 0; i < lut_size; i++)
 		ilk_lut_write(crtc_state, PREC_PALETTE(pipe, i),
-			      ilk_lut_10(&lut[i]));
+			      words ? words[i] : ilk_lut_10(&lut[i]));
 }
 
 static void ilk_load_luts(const struct intel_crtc_state *crtc_state)
@@ -1394,6 +1625,7 @@ static void ivb_load_lut_10(const struct intel_crtc_state *crtc_state,
 {
 	const struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
 	const struct drm_color_lut *lut = blob->data;
+	const u32 *words = lut_image_words(crtc_state, blob, INTEL_LUT_FORMAT_10);
 	int i, lut_size = drm_color_lut_size(blob);
 	enum pipe pipe = crtc->pipe;
 
@@ -1401,7 +1633,7 @@ static void ivb_load_lut_10(const struct intel_crtc_state *crtc_state,
 		ilk_lut_write(crtc_state, PREC_PAL_INDEX(pipe),
 			      prec_index + i);
 		ilk_lut_write(crtc_state, PREC_PAL_DATA(pipe),
-			      ilk_lut_10(&lut[i]));
+			      words ? words[i] : ilk_lut_10(&lut[i]));
 	}
 
 	/*
@@ -1418,8 +1650,7 @@ static void bdw_load_lut_10(const struct intel_crtc_state *crtc_state,
 			    u32 prec_index)
 {
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
-	const struct drm_color_lut *lut = blob->data;
-	int i, lut_size = drm_color_lut_size(blob);
+	int lut_size = drm_color_lut_size(blob);
 	enum pipe pipe = crtc->pipe;
 
 	ilk_lut_write(crtc_state, PREC_PAL_INDEX(pipe),
@@ -1428,9 +1659,8 @@ static void bdw_load_lut_10(const struct intel_crtc_state *crtc_state,
 		      PAL_PREC_AUTO_INCREMENT |
 		      prec_index);
 
-	for (i = 0; i < lut_size; i++)
-		ilk_lut_write(crtc_state, PREC_PAL_DATA(pipe),
-			      ilk_lut_10(&lut[i]));
+	ilk_lut_write_image(crtc_state, PREC_PAL_DATA(pipe), blob,
+			    INTEL_LUT_FORMAT_10, 0, lut_size);
 
 	/*
 	 * Reset the index, otherwise it prevents the legacy palette to be
@@ -1518,44 +1748,13 @@ static void bdw_load_luts(const struct intel_crtc_state *crtc_state)
 	}
 }
 
-static int glk_degamma_lut_size(struct drm_i915_private *i915)
-{
-	if (DISPLAY_VER(i915) >= 13)
-		return 131;
-	else
-		return 35;
-}
-
-static u32 glk_degamma_lut(const struct drm_color_lut *color)
-{
-	return color->green;
-}
-
-static void glk_degamma_lut_pack(struct drm_color_lut *entry, u32 val)
-{
-	/* PRE_CSC_GAMC_DATA is 3.16, clamp to 0.16 */
-	entry->red = entry->green = entry->blue = min(val, 0xffffu);
-}
-
-static u32 mtl_degamma_lut(const struct drm_color_lut *color)
-{
-	return drm_color_lut_extract(color->green, 24);
-}
-
-static void mtl_degamma_lut_pack(struct drm_color_lut *entry, u32 val)
-{
-	/* PRE_CSC_GAMC_DATA is 3.24, clamp to 0.16 */
-	entry->red = entry->green = entry->blue =
-		intel_color_lut_pack(min(val, 0xffffffu), 24);
-}
-
 static void glk_load_degamma_lut(const struct intel_crtc_state *crtc_state,
 				 const struct drm_property_blob *blob)
 {
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
 	struct drm_i915_private *i915 = to_i915(crtc->base.dev);
-	const struct drm_color_lut *lut = blob->data;
-	int i, lut_size = drm_color_lut_size(blob);
+	enum intel_lut_format format = DISPLAY_VER(i915) >= 14 ?
+		INTEL_LUT_FORMAT_MTL_DEGAMMA : INTEL_LUT_FORMAT_GLK_DEGAMMA;
 	enum pipe pipe = crtc->pipe;
 
 	/*
@@ -1569,30 +1768,21 @@ static void glk_load_degamma_lut(const struct intel_crtc_state *crtc_state,
 		      PRE_CSC_GAMC_AUTO_INCREMENT |
 		      PRE_CSC_GAMC_INDEX_VALUE(0));
 
-	for (i = 0; i < lut_size; i++) {
-		/*
-		 * First lut_size entries represent range from 0 to 1.0
-		 * 3 additional lut entries will represent extended range
-		 * inputs 3.0 and 7.0 respectively, currently clamped
-		 * at 1.0. Since the precision is 16bit, the user
-		 * value can be directly filled to register.
-		 * The pipe degamma table in GLK+ onwards doesn't
-		 * support different values per channel, so this just
-		 * programs green value which will be equal to Red and
-		 * Blue into the lut registers.
-		 * ToDo: Extend to max 7.0. Enable 32 bit input value
-		 * as compared to just 16 to achieve this.
-		 */
-		ilk_lut_write(crtc_state, PRE_CSC_GAMC_DATA(pipe),
-			      DISPLAY_VER(i915) >= 14 ?
-			      mtl_degamma_lut(&lut[i]) : glk_degamma_lut(&lut[i]));
-	}
-
-	/* Clamp values > 1.0. */
-	while (i++ < glk_degamma_lut_size(i915))
-		ilk_lut_write(crtc_state, PRE_CSC_GAMC_DATA(pipe),
-			      DISPLAY_VER(i915) >= 14 ?
-			      1 << 24 : 1 << 16);
+	/*
+	 * First lut_size entries represent range from 0 to 1.0
+	 * 3 additional lut entries will represent extended range
+	 * inputs 3.0 and 7.0 respectively, currently clamped
+	 * at 1.0. Since the precision is 16bit, the user
+	 * value can be directly filled to register.
+	 * The pipe degamma table in GLK+ onwards doesn't
+	 * support different values per channel, so this just
+	 * programs green value which will be equal to Red and
+	 * Blue into the lut registers.
+	 * ToDo: Extend to max 7.0. Enable 32 bit input value
+	 * as compared to just 16 to achieve this.
+	 */
+	ilk_lut_write_image(crtc_state, PRE_CSC_GAMC_DATA(pipe), blob, format,
+			    0, lut_image_size(i915, format, blob));
 
 	ilk_lut_write(crtc_state, PRE_CSC_GAMC_INDEX(pipe), 0);
 }
@@ -1638,9 +1828,7 @@ icl_program_gamma_superfine_segment(const struct intel_crtc_state *crtc_state)
 {
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
 	const struct drm_property_blob *blob = crtc_state->post_csc_lut;
-	const struct drm_color_lut *lut = blob->data;
 	enum pipe pipe = crtc->pipe;
-	int i;
 
 	/*
 	 * Program Super Fine segment (let's call it seg1)...
@@ -1655,14 +1843,9 @@ icl_program_gamma_superfine_segment(const struct intel_crtc_state *crtc_state)
 		      PAL_PREC_AUTO_INCREMENT |
 		      PAL_PREC_MULTI_SEG_INDEX_VALUE(0));
 
-	for (i = 0; i < 9; i++) {
-		const struct drm_color_lut *entry = &lut[i];
-
-		ilk_lut_write(crtc_state, PREC_PAL_MULTI_SEG_DATA(pipe),
-			      ilk_lut_12p4_ldw(entry));
-		ilk_lut_write(crtc_state, PREC_PAL_MULTI_SEG_DATA(pipe),
-			      ilk_lut_12p4_udw(entry));
-	}
+	ilk_lut_write_image(crtc_state, PREC_PAL_MULTI_SEG_DATA(pipe), blob,
+			    INTEL_LUT_FORMAT_ICL_MULTI_SEG,
+			    ICL_MULTI_SEG_SUPERFINE, ICL_MULTI_SEG_SUPERFINE_SIZE);
 
 	ilk_lut_write(crtc_state, PREC_PAL_MULTI_SEG_INDEX(pipe),
 		      PAL_PREC_MULTI_SEG_INDEX_VALUE(0));
@@ -1674,9 +1857,7 @@ icl_program_gamma_multi_segment(const struct intel_crtc_state *crtc_state)
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
 	const struct drm_property_blob *blob = crtc_state->post_csc_lut;
 	const struct drm_color_lut *lut = blob->data;
-	const struct drm_color_lut *entry;
 	enum pipe pipe = crtc->pipe;
-	int i;
 
 	/*
 	 * Program Fine segment (let's call it seg2)...
@@ -1694,14 +1875,9 @@ icl_program_gamma_multi_segment(const struct intel_crtc_state *crtc_state)
 		      PAL_PREC_AUTO_INCREMENT |
 		      PAL_PREC_INDEX_VALUE(0));
 
-	for (i = 1; i < 257; i++) {
-		entry = &lut[i * 8];
-
-		ilk_lut_write(crtc_state, PREC_PAL_DATA(pipe),
-			      ilk_lut_12p4_ldw(entry));
-		ilk_lut_write(crtc_state, PREC_PAL_DATA(pipe),
-			      ilk_lut_12p4_udw(entry));
-	}
+	ilk_lut_write_image(crtc_state, PREC_PAL_DATA(pipe), blob,
+			    INTEL_LUT_FORMAT_ICL_MULTI_SEG,
+			    ICL_MULTI_SEG_FINE, ICL_MULTI_SEG_FINE_SIZE);
 
 	/*
 	 * Program Coarse segment (let's call it seg3)...
@@ -1715,21 +1891,15 @@ icl_program_gamma_multi_segment(const struct intel_crtc_state *crtc_state)
 	 * being used or not, but we still need to program these to advance
 	 * the index.
 	 */
-	for (i = 0; i < 256; i++) {
-		entry = &lut[i * 8 * 128];
-
-		ilk_lut_write(crtc_state, PREC_PAL_DATA(pipe),
-			      ilk_lut_12p4_ldw(entry));
-		ilk_lut_write(crtc_state, PREC_PAL_DATA(pipe),
-			      ilk_lut_12p4_udw(entry));
-	}
+	ilk_lut_write_image(crtc_state, PREC_PAL_DATA(pipe), blob,
+			    INTEL_LUT_FORMAT_ICL_MULTI_SEG,
+			    ICL_MULTI_SEG_COARSE, ICL_MULTI_SEG_COARSE_SIZE);
 
 	ilk_lut_write(crtc_state, PREC_PAL_INDEX(pipe),
 		      PAL_PREC_INDEX_VALUE(0));
 
 	/* The last entry in the LUT is to be programmed in GCMAX */
-	entry = &lut[256 * 8 * 128];
-	ivb_load_lut_max(crtc_state, entry);
+	ivb_load_lut_max(crtc_state, &lut[256 * 8 * 128]);
 }
 
 static void icl_load_luts(const struct intel_crtc_state *crtc_state)
@@ -1909,7 +2079,7 @@ void intel_color_prepare_commit(struct intel_crtc_state *crtc_state)
 	if (!crtc_state->pre_csc_lut && !crtc_state->post_csc_lut)
 		return;
 
-	crtc_state->dsb = intel_dsb_prepare(crtc_state, 1024);
+	crtc_state->dsb = intel_dsb_prepare(crtc_state, INTEL_DSB_0, 1024);
 	if (!crtc_state->dsb)
 		return;
 
@@ -1981,11 +2151,101 @@ static bool chv_can_preload_luts(const struct intel_crtc_state *new_crtc_state)
 	return vlv_can_preload_luts(new_crtc_state);
 }
 
+static enum intel_lut_format
+ilk_lut_format(const struct intel_crtc_state *crtc_state, bool is_pre_csc_lut)
+{
+	struct drm_i915_private *i915 = to_i915(crtc_state->uapi.crtc->dev);
+	u32 gamma_mode = crtc_state->gamma_mode & GAMMA_MODE_MODE_MASK;
+
+	/* The GMCH platforms don't load enough entries to be worth it */
+	if (HAS_GMCH(i915))
+		return INTEL_LUT_FORMAT_NONE;
+
+	if (is_pre_csc_lut && DISPLAY_VER(i915) >= 10)
+		return DISPLAY_VER(i915) >= 14 ?
+			INTEL_LUT_FORMAT_MTL_DEGAMMA : INTEL_LUT_FORMAT_GLK_DEGAMMA;
+
+	/* Pre-GLK only load the pre-csc LUT in split gamma mode, or alone */
+	if (is_pre_csc_lut && crtc_state->post_csc_lut &&
+	    gamma_mode != GAMMA_MODE_MODE_SPLIT)
+		return INTEL_LUT_FORMAT_NONE;
+
+	switch (gamma_mode) {
+	case GAMMA_MODE_MODE_8BIT:
+		return INTEL_LUT_FORMAT_8;
+	case GAMMA_MODE_MODE_10BIT:
+	case GAMMA_MODE_MODE_SPLIT:
+		return INTEL_LUT_FORMAT_10;
+	case GAMMA_MODE_MODE_12BIT_MULTI_SEG:
+		return INTEL_LUT_FORMAT_ICL_MULTI_SEG;
+	default:
+		return INTEL_LUT_FORMAT_NONE;
+	}
+}
+
+static int intel_color_pack_lut(struct intel_crtc_state *crtc_state,
+				struct intel_lut_image **image,
+				struct drm_property_blob *blob,
+				bool is_pre_csc_lut)
+{
+	struct drm_i915_private *i915 = to_i915(crtc_state->uapi.crtc->dev);
+	enum intel_lut_format format = INTEL_LUT_FORMAT_NONE;
+	struct intel_lut_image *new_image = NULL;
+
+	if (blob)
+		format = ilk_lut_format(crtc_state, is_pre_csc_lut);
+
+	if (format != INTEL_LUT_FORMAT_NONE) {
+		/* Still the same blob as in the old state? */
+		if (lut_image_matches(*image, blob, format))
+			return 0;
+
+		/* Or moved over from the other LUT? */
+		if (lut_image_matches(crtc_state->pre_csc_lut_image, blob, format))
+			new_image = intel_color_lut_image_get(crtc_state->pre_csc_lut_image);
+		else if (lut_image_matches(crtc_state->post_csc_lut_image, blob, format))
+			new_image = intel_color_lut_image_get(crtc_state->post_csc_lut_image);
+		else
+			new_image = intel_lut_image_create(i915, blob, format);
+		if (IS_ERR(new_image))
+			return PTR_ERR(new_image);
+	}
+
+	intel_color_lut_image_put(*image);
+	*image = new_image;
+
+	return 0;
+}
+
+/*
+ * Convert the LUTs to the register values load_luts() will write, so
+ * that doesn't have to happen (again) in the commit. The images live in
+ * the crtc state, and so carry over to the next commit as long as the
+ * same blobs stay assigned.
+ */
+static int intel_color_pack_luts(struct intel_crtc_state *crtc_state)
+{
+	int ret;
+
+	ret = intel_color_pack_lut(crtc_state, &crtc_state->pre_csc_lut_image,
+				   crtc_state->pre_csc_lut, true);
+	if (ret)
+		return ret;
+
+	return intel_color_pack_lut(crtc_state, &crtc_state->post_csc_lut_image,
+				    crtc_state->post_csc_lut, false);
+}
+
 int intel_color_check(struct intel_crtc_state *crtc_state)
 {
 	struct drm_i915_private *i915 = to_i915(crtc_state->uapi.crtc->dev);
+	int ret;
+
+	ret = i915->display.funcs.color->color_check(crtc_state);
+	if (ret)
+		return ret;
 
-	return i915->display.funcs.color->color_check(crtc_state);
+	return intel_color_pack_luts(crtc_state);
 }
 
 void intel_color_get_config(struct intel_crtc_state *crtc_state)
@@ -3883,3 +4143,9 @@ void intel_color_init_hooks(struct drm_i915_private *i915)
 			i915->display.funcs.color = &ilk_color_funcs;
 	}
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#ifdef I915
+#include "selftest_color.c"
+#endif
+#endif
@@ -10,6 +10,7 @@
 
 struct intel_crtc_state;
 struct intel_crtc;
+struct intel_lut_image;
 struct drm_i915_private;
 struct drm_property_blob;
 
@@ -31,5 +32,7 @@ bool intel_color_lut_equal(const struct intel_crtc_state *crtc_state,
 			   const struct drm_property_blob *blob2,
 			   bool is_pre_csc_lut);
 void intel_color_assert_luts(const struct intel_crtc_state *crtc_state);
+struct intel_lut_image *intel_color_lut_image_get(struct intel_lut_image *image);
+void intel_color_lut_image_put(struct intel_lut_image *image);
 
 #endif /* __INTEL_COLOR_H__ */
@@ -503,12 +503,13 @@ static void i9xx_cursor_disable_sel_fetch_arm(struct intel_plane *plane,
 					      const struct intel_crtc_state *crtc_state)
 {
 	struct drm_i915_private *dev_priv = to_i915(plane->base.dev);
+	struct intel_dsb *dsb = crtc_state->dsb_commit;
 	enum pipe pipe = plane->pipe;
 
 	if (!crtc_state->enable_psr2_sel_fetch)
 		return;
 
-	intel_de_write_fw(dev_priv, PLANE_SEL_FETCH_CTL(pipe, plane->id), 0);
+	intel_de_write_dsb(dev_priv, dsb, PLANE_SEL_FETCH_CTL(pipe, plane->id), 0);
 }
 
 static void i9xx_cursor_update_sel_fetch_arm(struct intel_plane *plane,
@@ -516,6 +517,7 @@ static void i9xx_cursor_update_sel_fetch_arm(struct intel_plane *plane,
 					     const struct intel_plane_state *plane_state)
 {
 	struct drm_i915_private *dev_priv = to_i915(plane->base.dev);
+	struct intel_dsb *dsb = crtc_state->dsb_commit;
 	enum pipe pipe = plane->pipe;
 
 	if (!crtc_state->enable_psr2_sel_fetch)
@@ -525,11 +527,11 @@ static void i9xx_cursor_update_sel_fetch_arm(struct intel_plane *plane,
 		if (crtc_state->enable_psr2_su_region_et) {
 			u32 val = intel_cursor_position(crtc_state, plane_state,
 				true);
-			intel_de_write_fw(dev_priv, CURPOS_ERLY_TPT(pipe), val);
+			intel_de_write_dsb(dev_priv, dsb, CURPOS_ERLY_TPT(pipe), val);
 		}
 
-		intel_de_write_fw(dev_priv, PLANE_SEL_FETCH_CTL(pipe, plane->id),
-				  plane_state->ctl);
+		intel_de_write_dsb(dev_priv, dsb, PLANE_SEL_FETCH_CTL(pipe, plane->id),
+				   plane_state->ctl);
 	} else {
 		i9xx_cursor_disable_sel_fetch_arm(plane, crtc_state);
 	}
@@ -541,6 +543,7 @@ static void i9xx_cursor_update_arm(struct intel_plane *plane,
 				   const struct intel_plane_state *plane_state)
 {
 	struct drm_i915_private *dev_priv = to_i915(plane->base.dev);
+	struct intel_dsb *dsb = crtc_state->dsb_commit;
 	enum pipe pipe = plane->pipe;
 	u32 cntl = 0, base = 0, pos = 0, fbc_ctl = 0;
 
@@ -591,18 +594,18 @@ static void i9xx_cursor_update_arm(struct intel_plane *plane,
 	    plane->cursor.size != fbc_ctl ||
 	    plane->cursor.cntl != cntl) {
 		if (HAS_CUR_FBC(dev_priv))
-			intel_de_write_fw(dev_priv, CUR_FBC_CTL(pipe),
-					  fbc_ctl);
-		intel_de_write_fw(dev_priv, CURCNTR(pipe), cntl);
-		intel_de_write_fw(dev_priv, CURPOS(pipe), pos);
-		intel_de_write_fw(dev_priv, CURBASE(pipe), base);
+			intel_de_write_dsb(dev_priv, dsb, CUR_FBC_CTL(pipe),
+					   fbc_ctl);
+		intel_de_write_dsb(dev_priv, dsb, CURCNTR(pipe), cntl);
+		intel_de_write_dsb(dev_priv, dsb, CURPOS(pipe), pos);
+		intel_de_write_dsb(dev_priv, dsb, CURBASE(pipe), base);
 
 		plane->cursor.base = base;
 		plane->cursor.size = fbc_ctl;
 		plane->cursor.cntl = cntl;
 	} else {
-		intel_de_write_fw(dev_priv, CURPOS(pipe), pos);
-		intel_de_write_fw(dev_priv, CURBASE(pipe), base);
+		intel_de_write_dsb(dev_priv, dsb, CURPOS(pipe), pos);
+		intel_de_write_dsb(dev_priv, dsb, CURBASE(pipe), base);
 	}
 }
 
@@ -4493,6 +4493,9 @@ copy_bigjoiner_crtc_state_modeset(struct intel_atomic_state *state,
 	memcpy(slave_crtc_state, saved_state, sizeof(*slave_crtc_state));
 	kfree(saved_state);
 
+	intel_color_lut_image_get(slave_crtc_state->pre_csc_lut_image);
+	intel_color_lut_image_get(slave_crtc_state->post_csc_lut_image);
+
 	/* Re-init hw state */
 	memset(&slave_crtc_state->hw, 0, sizeof(slave_crtc_state->hw));
 	slave_crtc_state->hw.enable = master_crtc_state->hw.enable;
@@ -5738,6 +5741,46 @@ static int intel_atomic_check_planes(struct intel_atomic_state *state)
 	return 0;
 }
 
+/*
+ * A plain page flip changes the fb, and perhaps the offset into it, but
+ * nothing that the watermarks, DDB, bandwidth or cdclk are derived from. In
+ * that case the derived state duplicated from the old crtc state still holds
+ * and recomputing it (along with pulling in the global state objects) would
+ * only arrive at the same answer.
+ */
+static bool intel_atomic_needs_global_check(struct intel_atomic_state *state)
+{
+	const struct intel_crtc_state *old_crtc_state, *new_crtc_state;
+	const struct intel_plane_state *old_plane_state, *new_plane_state;
+	struct intel_plane *plane;
+	struct intel_crtc *crtc;
+	int i;
+
+	/* Something already asked for the global state to be updated */
+	if (state->num_global_objs)
+		return true;
+
+	for_each_oldnew_intel_crtc_in_state(state, crtc, old_crtc_state,
+					    new_crtc_state, i) {
+		if (intel_crtc_needs_modeset(new_crtc_state) ||
+		    intel_crtc_needs_fastset(new_crtc_state))
+			return true;
+
+		/* Async flips get a minimal DDB allocation on some platforms */
+		if (old_crtc_state->uapi.async_flip != new_crtc_state->uapi.async_flip)
+			return true;
+	}
+
+	for_each_oldnew_intel_plane_in_state(state, plane, old_plane_state,
+					     new_plane_state, i) {
+		if (!intel_plane_global_inputs_equal(old_plane_state,
+						     new_plane_state))
+			return true;
+	}
+
+	return false;
+}
+
 static int intel_atomic_check_crtcs(struct intel_atomic_state *state)
 {
 	struct intel_crtc_state __maybe_unused *crtc_state;
@@ -6425,17 +6468,19 @@ int intel_atomic_check(struct drm_device *dev,
 	if (ret)
 		goto fail;
 
-	ret = intel_compute_global_watermarks(state);
-	if (ret)
-		goto fail;
+	if (any_ms || intel_atomic_needs_global_check(state)) {
+		ret = intel_compute_global_watermarks(state);
+		if (ret)
+			goto fail;
 
-	ret = intel_bw_atomic_check(state);
-	if (ret)
-		goto fail;
+		ret = intel_bw_atomic_check(state);
+		if (ret)
+			goto fail;
 
-	ret = intel_cdclk_atomic_check(state, &any_ms);
-	if (ret)
-		goto fail;
+		ret = intel_cdclk_atomic_check(state, &any_ms);
+		if (ret)
+			goto fail;
+	}
 
 	if (intel_any_crtc_needs_modeset(state))
 		any_ms = true;
@@ -6501,6 +6546,64 @@ int intel_atomic_check(struct drm_device *dev,
 	return ret;
 }
 
+static void intel_atomic_dsb_prepare(struct intel_atomic_state *state,
+				     struct intel_crtc *crtc)
+{
+	struct drm_i915_private *i915 = to_i915(state->base.dev);
+	struct intel_crtc_state *new_crtc_state =
+		intel_atomic_get_new_crtc_state(state, crtc);
+
+	if (!i915->display.params.enable_dsb_commit)
+		return;
+
+	/*
+	 * Only plain plane updates for now. Modesets and fastsets
+	 * program a lot more than just the planes, async flips don't
+	 * do vblank evasion at all, and PSR2 selective fetch has to
+	 * update PSR2_MAN_TRK_CTL along with the planes.
+	 */
+	if (!new_crtc_state->hw.active ||
+	    !new_crtc_state->update_planes ||
+	    intel_crtc_needs_modeset(new_crtc_state) ||
+	    intel_crtc_needs_fastset(new_crtc_state) ||
+	    new_crtc_state->do_async_flip ||
+	    new_crtc_state->enable_psr2_sel_fetch)
+		return;
+
+	new_crtc_state->dsb_commit = intel_dsb_prepare(new_crtc_state,
+						       INTEL_DSB_1, 1024);
+}
+
+static void intel_atomic_dsb_finish(struct intel_atomic_state *state,
+				    struct intel_crtc *crtc)
+{
+	struct intel_crtc_state *new_crtc_state =
+		intel_atomic_get_new_crtc_state(state, crtc);
+
+	if (!new_crtc_state->dsb_commit)
+		return;
+
+	/*
+	 * The noarm updates were already recorded by
+	 * intel_pre_update_crtc(), add the rest so that
+	 * the critical section only needs to kick the DSB.
+	 */
+	intel_crtc_planes_update_arm(state, crtc);
+
+	skl_detach_scalers(new_crtc_state);
+
+	intel_dsb_finish(new_crtc_state->dsb_commit);
+}
+
+static void intel_atomic_dsb_cleanup(struct intel_crtc_state *crtc_state)
+{
+	if (!crtc_state->dsb_commit)
+		return;
+
+	intel_dsb_cleanup(crtc_state->dsb_commit);
+	crtc_state->dsb_commit = NULL;
+}
+
 static int intel_atomic_prepare_commit(struct intel_atomic_state *state)
 {
 	struct intel_crtc_state *crtc_state;
@@ -6514,6 +6617,8 @@ static int intel_atomic_prepare_commit(struct intel_atomic_state *state)
 	for_each_new_intel_crtc_in_state(state, crtc, crtc_state, i) {
 		if (intel_crtc_needs_color_update(crtc_state))
 			intel_color_prepare_commit(crtc_state);
+
+		intel_atomic_dsb_prepare(state, crtc);
 	}
 
 	return 0;
@@ -6627,7 +6732,8 @@ static void commit_pipe_post_planes(struct intel_atomic_state *state,
 	 * end up happening in two different frames.
 	 */
 	if (DISPLAY_VER(dev_priv) >= 9 &&
-	    !intel_crtc_needs_modeset(new_crtc_state))
+	    !intel_crtc_needs_modeset(new_crtc_state) &&
+	    !new_crtc_state->dsb_commit)
 		skl_detach_scalers(new_crtc_state);
 
 	if (vrr_enabling(old_crtc_state, new_crtc_state))
@@ -6709,12 +6815,19 @@ static void intel_update_crtc(struct intel_atomic_state *state,
 	struct intel_crtc_state *new_crtc_state =
 		intel_atomic_get_new_crtc_state(state, crtc);
 
+	intel_atomic_dsb_finish(state, crtc);
+
 	/* Perform vblank evasion around commit operation */
 	intel_pipe_update_start(state, crtc);
 
 	commit_pipe_pre_planes(state, crtc);
 
-	intel_crtc_planes_update_arm(state, crtc);
+	if (new_crtc_state->dsb_commit) {
+		intel_dsb_commit(new_crtc_state->dsb_commit, false);
+		intel_dsb_wait_atomic(new_crtc_state->dsb_commit);
+	} else {
+		intel_crtc_planes_update_arm(state, crtc);
+	}
 
 	commit_pipe_post_planes(state, crtc);
 
@@ -7012,8 +7125,10 @@ static void intel_atomic_cleanup_work(struct work_struct *work)
 	struct intel_crtc *crtc;
 	int i;
 
-	for_each_old_intel_crtc_in_state(state, crtc, old_crtc_state, i)
+	for_each_old_intel_crtc_in_state(state, crtc, old_crtc_state, i) {
 		intel_color_cleanup_commit(old_crtc_state);
+		intel_atomic_dsb_cleanup(old_crtc_state);
+	}
 
 	drm_atomic_helper_cleanup_planes(&i915->drm, &state->base);
 	drm_atomic_helper_commit_cleanup_done(&state->base);
@@ -7189,6 +7304,9 @@ static void intel_atomic_commit_tail(struct intel_atomic_state *state)
 			intel_crtc_disable_flip_done(state, crtc);
 
 		intel_color_wait_commit(new_crtc_state);
+
+		if (new_crtc_state->dsb_commit)
+			intel_dsb_wait(new_crtc_state->dsb_commit);
 	}
 
 	/*
@@ -7240,6 +7358,7 @@ static void intel_atomic_commit_tail(struct intel_atomic_state *state)
 		 * FIXME get rid of this funny new->old swapping
 		 */
 		old_crtc_state->dsb = fetch_and_zero(&new_crtc_state->dsb);
+		old_crtc_state->dsb_commit = fetch_and_zero(&new_crtc_state->dsb_commit);
 	}
 
 	/* Underruns don't always raise interrupts, so check manually */
@@ -7359,8 +7478,10 @@ int intel_atomic_commit(struct drm_device *dev, struct drm_atomic_state *_state,
 		struct intel_crtc *crtc;
 		int i;
 
-		for_each_new_intel_crtc_in_state(state, crtc, new_crtc_state, i)
+		for_each_new_intel_crtc_in_state(state, crtc, new_crtc_state, i) {
 			intel_color_cleanup_commit(new_crtc_state);
+			intel_atomic_dsb_cleanup(new_crtc_state);
+		}
 
 		drm_atomic_helper_unprepare_planes(dev, &state->base);
 		intel_runtime_pm_put(&dev_priv->runtime_pm, state->wakeref);
@@ -116,6 +116,11 @@ intel_display_param_named_unsafe(enable_psr2_sel_fetch, bool, 0400,
 	"(0=disabled, 1=enabled) "
 	"Default: 1");
 
+intel_display_param_named_unsafe(enable_dsb_commit, bool, 0400,
+	"Use the DSB to program plane, watermark and scaler updates "
+	"of page flips, instead of MMIO under vblank evasion "
+	"(default: false)");
+
 __maybe_unused
 static void _param_print_bool(struct drm_printer *p, const char *driver_name,
 			      const char *name, bool val)
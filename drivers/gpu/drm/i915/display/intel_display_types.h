@@ -59,6 +59,7 @@ struct drm_printer;
 struct __intel_global_objs_state;
 struct intel_ddi_buf_trans;
 struct intel_fbc;
+struct intel_lut_image;
 struct intel_connector;
 struct intel_tc_port;
 
@@ -1077,6 +1078,8 @@ struct intel_crtc_state {
 
 	/* actual state of LUTs */
 	struct drm_property_blob *pre_csc_lut, *post_csc_lut;
+	/* ...and the same packed into register values, if any */
+	struct intel_lut_image *pre_csc_lut_image, *post_csc_lut_image;
 
 	struct intel_csc_matrix csc, output_csc;
 
@@ -1399,6 +1402,8 @@ struct intel_crtc_state {
 
 	/* For DSB related info */
 	struct intel_dsb *dsb;
+	/* plane/wm/ddb/scaler updates, kicked once under vblank evasion */
+	struct intel_dsb *dsb_commit;
 
 	u32 psr2_man_track_ctl;
 
@@ -19,16 +19,8 @@
 
 #define CACHELINE_BYTES 64
 
-enum dsb_id {
-	INVALID_DSB = -1,
-	DSB1,
-	DSB2,
-	DSB3,
-	MAX_DSB_PER_PIPE
-};
-
 struct intel_dsb {
-	enum dsb_id id;
+	enum intel_dsb_id id;
 
 	struct intel_dsb_buffer dsb_buf;
 	struct intel_crtc *crtc;
@@ -121,7 +113,7 @@ static void intel_dsb_dump(struct intel_dsb *dsb)
 }
 
 static bool is_dsb_busy(struct drm_i915_private *i915, enum pipe pipe,
-			enum dsb_id id)
+			enum intel_dsb_id id)
 {
 	return intel_de_read_fw(i915, DSB_CTRL(pipe, id)) & DSB_STATUS_BUSY;
 }
@@ -243,6 +235,54 @@ void intel_dsb_reg_write(struct intel_dsb *dsb,
 	}
 }
 
+/**
+ * intel_dsb_reg_write_indexed() - Emit an indexed write to the DSB context
+ * @dsb: DSB context
+ * @reg: auto-incrementing register address
+ * @val: values
+ * @count: number of values
+ *
+ * Same as calling intel_dsb_reg_write() for each value in turn, except
+ * that the values are copied into the command buffer in one go.
+ */
+void intel_dsb_reg_write_indexed(struct intel_dsb *dsb,
+				 i915_reg_t reg, const u32 *val, int count)
+{
+	struct intel_crtc *crtc = dsb->crtc;
+	struct drm_i915_private *i915 = to_i915(crtc->base.dev);
+	u32 old_count;
+
+	if (count < 2 || intel_dsb_prev_ins_is_mmio_write(dsb, reg)) {
+		while (count--)
+			intel_dsb_reg_write(dsb, reg, *val++);
+		return;
+	}
+
+	/* worst case: alignment, header, values and padding */
+	if (drm_WARN(&i915->drm, dsb->free_pos + 1 + 2 + count + 1 > dsb->size,
+		     "[CRTC:%d:%s] DSB %d buffer overflow\n",
+		     crtc->base.base.id, crtc->base.name, dsb->id))
+		return;
+
+	/* extend the previous indexed write if we can */
+	if (!intel_dsb_prev_ins_is_indexed_write(dsb, reg))
+		intel_dsb_emit(dsb, 0,
+			       (DSB_OPCODE_INDEXED_WRITE << DSB_OPCODE_SHIFT) |
+			       i915_mmio_reg_offset(reg));
+
+	intel_dsb_buffer_memcpy(&dsb->dsb_buf, dsb->free_pos, val,
+				count * sizeof(*val));
+	dsb->free_pos += count;
+
+	old_count = intel_dsb_buffer_read(&dsb->dsb_buf, dsb->ins_start_offset);
+	intel_dsb_buffer_write(&dsb->dsb_buf, dsb->ins_start_offset,
+			       old_count + count);
+
+	/* if number of data words is odd, then the last dword should be 0.*/
+	if (dsb->free_pos & 0x1)
+		intel_dsb_buffer_write(&dsb->dsb_buf, dsb->free_pos, 0);
+}
+
 static u32 intel_dsb_mask_to_byte_en(u32 mask)
 {
 	return (!!(mask & 0xff000000) << 3 |
@@ -430,9 +470,30 @@ void intel_dsb_wait(struct intel_dsb *dsb)
 	intel_de_write_fw(dev_priv, DSB_CTRL(pipe, dsb->id), 0);
 }
 
+/**
+ * intel_dsb_wait_atomic() - Busy wait for DSB execution to complete
+ * @dsb: DSB context
+ *
+ * Like intel_dsb_wait(), but usable from within the vblank evasion
+ * critical section. The DSB is left as is, intel_dsb_wait() must
+ * still be called before it can be reused.
+ */
+void intel_dsb_wait_atomic(struct intel_dsb *dsb)
+{
+	struct intel_crtc *crtc = dsb->crtc;
+	struct drm_i915_private *dev_priv = to_i915(crtc->base.dev);
+	enum pipe pipe = crtc->pipe;
+
+	if (wait_for_atomic_us(!is_dsb_busy(dev_priv, pipe, dsb->id), 100))
+		drm_err(&dev_priv->drm,
+			"[CRTC:%d:%s] DSB %d timed out waiting for idle\n",
+			crtc->base.base.id, crtc->base.name, dsb->id);
+}
+
 /**
  * intel_dsb_prepare() - Allocate, pin and map the DSB command buffer.
  * @crtc_state: the CRTC state
+ * @dsb_id: the DSB engine to use
  * @max_cmds: number of commands we need to fit into command buffer
  *
  * This function prepare the command buffer which is used to store dsb
@@ -442,6 +503,7 @@ void intel_dsb_wait(struct intel_dsb *dsb)
  * DSB context, NULL on failure
  */
 struct intel_dsb *intel_dsb_prepare(const struct intel_crtc_state *crtc_state,
+				    enum intel_dsb_id dsb_id,
 				    unsigned int max_cmds)
 {
 	struct intel_crtc *crtc = to_intel_crtc(crtc_state->uapi.crtc);
@@ -471,7 +533,7 @@ struct intel_dsb *intel_dsb_prepare(const struct intel_crtc_state *crtc_state,
 
 	intel_runtime_pm_put(&i915->runtime_pm, wakeref);
 
-	dsb->id = DSB1;
+	dsb->id = dsb_id;
 	dsb->crtc = crtc;
 	dsb->size = size / 4; /* in dwords */
 	dsb->free_pos = 0;
@@ -486,7 +548,7 @@ struct intel_dsb *intel_dsb_prepare(const struct intel_crtc_state *crtc_state,
 out:
 	drm_info_once(&i915->drm,
 		      "[CRTC:%d:%s] DSB %d queue setup failed, will fallback to MMIO for display HW programming\n",
-		      crtc->base.base.id, crtc->base.name, DSB1);
+		      crtc->base.base.id, crtc->base.name, dsb_id);
 
 	return NULL;
 }
@@ -503,3 +565,9 @@ void intel_dsb_cleanup(struct intel_dsb *dsb)
 	intel_dsb_buffer_cleanup(&dsb->dsb_buf);
 	kfree(dsb);
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#ifdef I915
+#include "selftest_dsb.c"
+#endif
+#endif
@@ -32,6 +32,13 @@ void intel_dsb_buffer_memset(struct intel_dsb_buffer *dsb_buf, u32 idx, u32 val,
 	memset(&dsb_buf->cmd_buf[idx], val, size);
 }
 
+void intel_dsb_buffer_memcpy(struct intel_dsb_buffer *dsb_buf, u32 idx, const u32 *val, size_t size)
+{
+	WARN_ON(idx > (dsb_buf->buf_size - size) / sizeof(*dsb_buf->cmd_buf));
+
+	memcpy(&dsb_buf->cmd_buf[idx], val, size);
+}
+
 bool intel_dsb_buffer_create(struct intel_crtc *crtc, struct intel_dsb_buffer *dsb_buf, size_t size)
 {
 	struct drm_i915_private *i915 = to_i915(crtc->base.dev);
@@ -21,6 +21,7 @@ u32 intel_dsb_buffer_ggtt_offset(struct intel_dsb_buffer *dsb_buf);
 void intel_dsb_buffer_write(struct intel_dsb_buffer *dsb_buf, u32 idx, u32 val);
 u32 intel_dsb_buffer_read(struct intel_dsb_buffer *dsb_buf, u32 idx);
 void intel_dsb_buffer_memset(struct intel_dsb_buffer *dsb_buf, u32 idx, u32 val, size_t size);
+void intel_dsb_buffer_memcpy(struct intel_dsb_buffer *dsb_buf, u32 idx, const u32 *val, size_t size);
 bool intel_dsb_buffer_create(struct intel_crtc *crtc, struct intel_dsb_buffer *dsb_buf,
 			     size_t size);
 void intel_dsb_buffer_cleanup(struct intel_dsb_buffer *dsb_buf);
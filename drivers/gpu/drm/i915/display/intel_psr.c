@@ -2023,6 +2023,13 @@ static void clip_area_update(struct drm_rect *overlap_damage_area,
 		overlap_damage_area->y2 = damage_area->y2;
 }
 
+static void psr2_su_area_align(struct drm_rect *su_area, u16 y_alignment)
+{
+	su_area->y1 -= su_area->y1 % y_alignment;
+	if (su_area->y2 % y_alignment)
+		su_area->y2 = ((su_area->y2 / y_alignment) + 1) * y_alignment;
+}
+
 static void intel_psr2_sel_fetch_pipe_alignment(struct intel_crtc_state *crtc_state)
 {
 	struct drm_i915_private *dev_priv = to_i915(crtc_state->uapi.crtc->dev);
@@ -2036,10 +2043,21 @@ static void intel_psr2_sel_fetch_pipe_alignment(struct intel_crtc_state *crtc_st
 	else
 		y_alignment = crtc_state->su_y_granularity;
 
-	crtc_state->psr2_su_area.y1 -= crtc_state->psr2_su_area.y1 % y_alignment;
-	if (crtc_state->psr2_su_area.y2 % y_alignment)
-		crtc_state->psr2_su_area.y2 = ((crtc_state->psr2_su_area.y2 /
-						y_alignment) + 1) * y_alignment;
+	psr2_su_area_align(&crtc_state->psr2_su_area, y_alignment);
+}
+
+/*
+ * The hardware has a single SU region, so damage at the top and at the
+ * bottom of the pipe ends up fetching everything in between. Once the
+ * aligned SU region spans the whole pipe a selective update fetches as
+ * many lines as a single full frame update, but additionally needs the
+ * selective fetch area of every plane programmed, so go with the full
+ * frame update instead.
+ */
+static bool psr2_su_area_covers_pipe(const struct drm_rect *su_area,
+				     const struct drm_rect *pipe_src)
+{
+	return su_area->y1 <= pipe_src->y1 && su_area->y2 >= pipe_src->y2;
 }
 
 /*
@@ -2221,16 +2239,22 @@ int intel_psr2_sel_fetch_update(struct intel_atomic_state *state,
 	    crtc_state->splitter.enable)
 		crtc_state->psr2_su_area.y1 = 0;
 
-	ret = drm_atomic_add_affected_planes(&state->base, &crtc->base);
-	if (ret)
-		return ret;
-
 	/* Adjust su area to cover cursor fully as necessary */
 	if (cursor_plane_state)
 		intel_psr2_sel_fetch_et_alignment(crtc_state, cursor_plane_state);
 
 	intel_psr2_sel_fetch_pipe_alignment(crtc_state);
 
+	if (psr2_su_area_covers_pipe(&crtc_state->psr2_su_area,
+				     &crtc_state->pipe_src)) {
+		full_update = true;
+		goto skip_sel_fetch_set_loop;
+	}
+
+	ret = drm_atomic_add_affected_planes(&state->base, &crtc->base);
+	if (ret)
+		return ret;
+
 	/*
 	 * Now that we have the pipe damaged area check if it intersect with
 	 * every plane, if it does set the plane selective fetch area.
@@ -3404,3 +3428,9 @@ void intel_psr_connector_debugfs_add(struct intel_connector *connector)
 		debugfs_create_file("i915_psr_status", 0444, root,
 				    connector, &i915_psr_status_fops);
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#ifdef I915
+#include "selftest_psr.c"
+#endif
+#endif
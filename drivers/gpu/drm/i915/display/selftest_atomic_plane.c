@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "i915_selftest.h"
+
+#include "selftests/i915_random.h"
+#include "selftests/mock_gem_device.h"
+
+static const u32 fb_formats[] = {
+	DRM_FORMAT_XRGB8888,
+	DRM_FORMAT_RGB565,
+	DRM_FORMAT_NV12,
+};
+
+static const u64 fb_modifiers[] = {
+	DRM_FORMAT_MOD_LINEAR,
+	I915_FORMAT_MOD_Y_TILED,
+};
+
+/*
+ * Two framebuffers of each format/modifier pair, so that we can flip
+ * between them, laid out as fbs[(format * 2 + modifier) * 2 + copy].
+ */
+#define NUM_FBS (ARRAY_SIZE(fb_formats) * ARRAY_SIZE(fb_modifiers) * 2)
+#define FB_FORMAT(idx) ((idx) / 4)
+#define FB_MODIFIER(idx) ((idx) / 2 % 2)
+#define FB_COPY(idx) ((idx) % 2)
+#define FB_INDEX(format, modifier, copy) (((format) * 2 + (modifier)) * 2 + (copy))
+
+enum plane_transition {
+	/* Changes that leave the derived global state alone */
+	FLIP_FB,
+	PAN_SRC,
+	MOVE_DST,
+	NUM_BENIGN,
+
+	/* Changes that must go through the full check */
+	CHANGE_FORMAT = NUM_BENIGN,
+	CHANGE_MODIFIER,
+	ROTATE,
+	RESIZE_SRC,
+	RESIZE_DST,
+	TOGGLE_VISIBLE,
+	CHANGE_CRTC,
+	NUM_TRANSITIONS
+};
+
+struct plane_derived {
+	const struct drm_crtc *crtc;
+	unsigned int pixel_rate;
+	unsigned int data_rate[2];
+	unsigned int rel_data_rate[2];
+	unsigned int rotation;
+	u64 modifier;
+	u32 format;
+	bool visible;
+	bool scaled;
+};
+
+/* Everything intel_atomic_check() feeds into wm/ddb/bw/cdclk for a plane */
+static void plane_derived(struct plane_derived *d,
+			  const struct intel_crtc_state *crtc_state,
+			  const struct intel_plane_state *plane_state)
+{
+	const struct drm_framebuffer *fb = plane_state->hw.fb;
+	int i;
+
+	memset(d, 0, sizeof(*d));
+
+	d->crtc = plane_state->hw.crtc;
+	d->visible = plane_state->uapi.visible;
+	d->rotation = plane_state->hw.rotation;
+	d->format = fb->format->format;
+	d->modifier = fb->modifier;
+	d->pixel_rate = intel_plane_pixel_rate(crtc_state, plane_state);
+	d->scaled = intel_plane_is_scaled(plane_state);
+
+	for (i = 0; i < min_t(int, fb->format->num_planes, 2); i++) {
+		d->data_rate[i] =
+			intel_plane_data_rate(crtc_state, plane_state, i);
+		d->rel_data_rate[i] =
+			intel_plane_relative_data_rate(crtc_state, plane_state, i);
+	}
+}
+
+static void random_rect(struct drm_rect *r, int max_w, int max_h,
+			int shift, struct rnd_state *prng)
+{
+	int w = 64 + i915_prandom_u32_max_state(max_w - 64, prng);
+	int h = 64 + i915_prandom_u32_max_state(max_h - 64, prng);
+	int x = i915_prandom_u32_max_state(max_w - w + 1, prng);
+	int y = i915_prandom_u32_max_state(max_h - h + 1, prng);
+
+	drm_rect_init(r, x << shift, y << shift, w << shift, h << shift);
+}
+
+static void apply_transition(struct intel_plane_state *plane_state,
+			     enum plane_transition t,
+			     struct drm_framebuffer *fbs,
+			     struct drm_crtc *crtcs,
+			     struct rnd_state *prng)
+{
+	unsigned int idx = plane_state->hw.fb - fbs;
+
+	/* Each transition is applied at most once, none may undo another */
+	switch (t) {
+	case FLIP_FB:
+		plane_state->hw.fb = &fbs[FB_INDEX(FB_FORMAT(idx),
+						   FB_MODIFIER(idx),
+						   !FB_COPY(idx))];
+		break;
+	case PAN_SRC:
+		drm_rect_translate(&plane_state->uapi.src,
+				   (1 + i915_prandom_u32_max_state(64, prng)) << 16,
+				   (1 + i915_prandom_u32_max_state(64, prng)) << 16);
+		break;
+	case MOVE_DST:
+		drm_rect_translate(&plane_state->uapi.dst,
+				   1 + i915_prandom_u32_max_state(64, prng),
+				   1 + i915_prandom_u32_max_state(64, prng));
+		break;
+	case CHANGE_FORMAT:
+		plane_state->hw.fb =
+			&fbs[FB_INDEX((FB_FORMAT(idx) + 1) % ARRAY_SIZE(fb_formats),
+				      FB_MODIFIER(idx), FB_COPY(idx))];
+		break;
+	case CHANGE_MODIFIER:
+		plane_state->hw.fb = &fbs[FB_INDEX(FB_FORMAT(idx),
+						   !FB_MODIFIER(idx),
+						   FB_COPY(idx))];
+		break;
+	case ROTATE:
+		plane_state->hw.rotation ^= DRM_MODE_ROTATE_0 | DRM_MODE_ROTATE_180;
+		break;
+	case RESIZE_SRC:
+		plane_state->uapi.src.x2 +=
+			(1 + i915_prandom_u32_max_state(16, prng)) << 16;
+		break;
+	case RESIZE_DST:
+		plane_state->uapi.dst.y2 += 1 + i915_prandom_u32_max_state(16, prng);
+		break;
+	case TOGGLE_VISIBLE:
+		plane_state->uapi.visible = !plane_state->uapi.visible;
+		break;
+	case CHANGE_CRTC:
+		plane_state->hw.crtc = plane_state->hw.crtc == &crtcs[0] ?
+			&crtcs[1] : &crtcs[0];
+		break;
+	default:
+		MISSING_CASE(t);
+		break;
+	}
+}
+
+static int igt_plane_global_inputs(void *arg)
+{
+	struct drm_i915_private *i915 = arg;
+	struct intel_plane_state *old_plane_state, *new_plane_state;
+	struct intel_crtc_state *crtc_state;
+	struct plane_derived old_d, new_d;
+	struct drm_framebuffer *fbs;
+	struct intel_plane *plane;
+	struct drm_crtc *crtcs;
+	unsigned int pass, n;
+	I915_RND_STATE(prng);
+	int err = 0;
+
+	/*
+	 * Apply random combinations of changes to a plane and check that
+	 * intel_plane_global_inputs_equal() only lets through those after
+	 * which the full path would derive exactly the same plane inputs to
+	 * the watermark, DDB, bandwidth and cdclk computations.
+	 */
+
+	fbs = kcalloc(NUM_FBS, sizeof(*fbs), GFP_KERNEL);
+	crtcs = kcalloc(2, sizeof(*crtcs), GFP_KERNEL);
+	plane = kzalloc(sizeof(*plane), GFP_KERNEL);
+	crtc_state = kzalloc(sizeof(*crtc_state), GFP_KERNEL);
+	old_plane_state = kzalloc(sizeof(*old_plane_state), GFP_KERNEL);
+	new_plane_state = kzalloc(sizeof(*new_plane_state), GFP_KERNEL);
+	if (!fbs || !crtcs || !plane || !crtc_state ||
+	    !old_plane_state || !new_plane_state) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	for (n = 0; n < NUM_FBS; n++) {
+		fbs[n].format = drm_format_info(fb_formats[FB_FORMAT(n)]);
+		fbs[n].modifier = fb_modifiers[FB_MODIFIER(n)];
+	}
+
+	plane->base.dev = &i915->drm;
+	plane->id = PLANE_PRIMARY;
+	crtc_state->pixel_rate = 594000;
+
+	for (pass = 0; pass < 4096; pass++) {
+		unsigned long mask;
+		bool expected, equal;
+
+		memset(old_plane_state, 0, sizeof(*old_plane_state));
+		old_plane_state->uapi.plane = &plane->base;
+		old_plane_state->uapi.visible = true;
+		old_plane_state->hw.crtc = &crtcs[0];
+		old_plane_state->hw.fb =
+			&fbs[i915_prandom_u32_max_state(NUM_FBS, &prng)];
+		old_plane_state->hw.rotation = DRM_MODE_ROTATE_0;
+		random_rect(&old_plane_state->uapi.src, 3840, 2160, 16, &prng);
+		random_rect(&old_plane_state->uapi.dst, 3840, 2160, 0, &prng);
+
+		memcpy(new_plane_state, old_plane_state, sizeof(*new_plane_state));
+
+		mask = i915_prandom_u32_max_state(BIT(NUM_TRANSITIONS), &prng);
+		for_each_set_bit(n, &mask, NUM_TRANSITIONS)
+			apply_transition(new_plane_state, n, fbs, crtcs, &prng);
+
+		expected = !(mask & ~(BIT(NUM_BENIGN) - 1));
+		equal = intel_plane_global_inputs_equal(old_plane_state,
+							new_plane_state);
+		if (equal != expected) {
+			pr_err("Transitions %lx %s the global check, expected it to be %s\n",
+			       mask, equal ? "skipped" : "required",
+			       expected ? "skipped" : "required");
+			err = -EINVAL;
+			break;
+		}
+
+		if (!equal)
+			continue;
+
+		plane_derived(&old_d, crtc_state, old_plane_state);
+		plane_derived(&new_d, crtc_state, new_plane_state);
+		if (memcmp(&old_d, &new_d, sizeof(old_d)) ||
+		    intel_wm_need_update(old_plane_state, new_plane_state)) {
+			pr_err("Transitions %lx skipped the global check, but changed its inputs\n",
+			       mask);
+			err = -EINVAL;
+			break;
+		}
+	}
+
+out:
+	kfree(new_plane_state);
+	kfree(old_plane_state);
+	kfree(crtc_state);
+	kfree(plane);
+	kfree(crtcs);
+	kfree(fbs);
+	return err;
+}
+
+int intel_atomic_plane_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_plane_global_inputs),
+	};
+
+	return mock_gem_device_subtests(tests);
+}
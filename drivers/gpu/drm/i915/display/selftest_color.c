@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "i915_selftest.h"
+
+#include "selftests/i915_random.h"
+#include "selftests/mock_gem_device.h"
+
+static void random_lut_entry(struct drm_color_lut *entry, struct rnd_state *prng)
+{
+	u32 x = prandom_u32_state(prng);
+
+	entry->red = x;
+	entry->green = x >> 16;
+	entry->blue = prandom_u32_state(prng);
+	entry->reserved = 0;
+}
+
+static bool lut_entry_equal(const struct drm_color_lut *a,
+			    const struct drm_color_lut *b)
+{
+	return a->red == b->red && a->green == b->green && a->blue == b->blue;
+}
+
+static int igt_lut_pack_roundtrip(void *arg)
+{
+	struct drm_color_lut entry, unpacked;
+	unsigned int pass;
+	I915_RND_STATE(prng);
+
+	/*
+	 * Converting an entry to its register value(s) and reading it back
+	 * must give us the entry at the hardware precision, which in turn
+	 * must convert to the exact same register value(s). The 16 bit (or
+	 * better) formats must return the entry unchanged.
+	 */
+
+	for (pass = 0; pass < 65536; pass++) {
+		u32 val, ldw, udw;
+
+		random_lut_entry(&entry, &prng);
+
+		val = i9xx_lut_8(&entry);
+		i9xx_lut_8_pack(&unpacked, val);
+		if (i9xx_lut_8(&unpacked) != val) {
+			pr_err("8 bit LUT entry %04x,%04x,%04x -> %08x -> %08x\n",
+			       entry.red, entry.green, entry.blue,
+			       val, i9xx_lut_8(&unpacked));
+			return -EINVAL;
+		}
+
+		val = ilk_lut_10(&entry);
+		ilk_lut_10_pack(&unpacked, val);
+		if (ilk_lut_10(&unpacked) != val) {
+			pr_err("10 bit LUT entry %04x,%04x,%04x -> %08x -> %08x\n",
+			       entry.red, entry.green, entry.blue,
+			       val, ilk_lut_10(&unpacked));
+			return -EINVAL;
+		}
+
+		ldw = ilk_lut_12p4_ldw(&entry);
+		udw = ilk_lut_12p4_udw(&entry);
+		ilk_lut_12p4_pack(&unpacked, ldw, udw);
+		if (!lut_entry_equal(&unpacked, &entry)) {
+			pr_err("12.4 LUT entry %04x,%04x,%04x -> %08x,%08x -> %04x,%04x,%04x\n",
+			       entry.red, entry.green, entry.blue, ldw, udw,
+			       unpacked.red, unpacked.green, unpacked.blue);
+			return -EINVAL;
+		}
+
+		val = glk_degamma_lut(&entry);
+		glk_degamma_lut_pack(&unpacked, val);
+		if (unpacked.green != entry.green) {
+			pr_err("GLK degamma LUT entry %04x -> %08x -> %04x\n",
+			       entry.green, val, unpacked.green);
+			return -EINVAL;
+		}
+
+		val = mtl_degamma_lut(&entry);
+		mtl_degamma_lut_pack(&unpacked, val);
+		if (unpacked.green != entry.green) {
+			pr_err("MTL degamma LUT entry %04x -> %08x -> %04x\n",
+			       entry.green, val, unpacked.green);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static struct drm_property_blob *
+random_lut(struct drm_i915_private *i915, int lut_size, struct rnd_state *prng)
+{
+	struct drm_property_blob *blob;
+	struct drm_color_lut *lut;
+	int i;
+
+	blob = drm_property_create_blob(&i915->drm,
+					sizeof(lut[0]) * lut_size, NULL);
+	if (IS_ERR(blob))
+		return blob;
+
+	lut = blob->data;
+	for (i = 0; i < lut_size; i++)
+		random_lut_entry(&lut[i], prng);
+
+	return blob;
+}
+
+/* The register values in the order the old per-entry loops wrote them */
+static u32 expected_word(enum intel_lut_format format,
+			 const struct drm_property_blob *blob, int i)
+{
+	const struct drm_color_lut *lut = blob->data;
+	int lut_size = drm_color_lut_size(blob);
+	const struct drm_color_lut *entry;
+
+	switch (format) {
+	case INTEL_LUT_FORMAT_8:
+		return i9xx_lut_8(&lut[i]);
+	case INTEL_LUT_FORMAT_10:
+		return ilk_lut_10(&lut[i]);
+	case INTEL_LUT_FORMAT_GLK_DEGAMMA:
+		return i < lut_size ? glk_degamma_lut(&lut[i]) : 1 << 16;
+	case INTEL_LUT_FORMAT_MTL_DEGAMMA:
+		return i < lut_size ? mtl_degamma_lut(&lut[i]) : 1 << 24;
+	case INTEL_LUT_FORMAT_ICL_MULTI_SEG:
+		if (i < 9 * 2)
+			entry = &lut[i / 2];
+		else if (i < 9 * 2 + 256 * 2)
+			entry = &lut[(1 + (i - 9 * 2) / 2) * 8];
+		else
+			entry = &lut[(i - 9 * 2 - 256 * 2) / 2 * 8 * 128];
+		return i & 1 ? ilk_lut_12p4_udw(entry) : ilk_lut_12p4_ldw(entry);
+	default:
+		return 0;
+	}
+}
+
+static int igt_lut_image(void *arg)
+{
+	static const struct {
+		enum intel_lut_format format;
+		int lut_size, num_words;
+	} tests[] = {
+		{ INTEL_LUT_FORMAT_8, 256, 256 },
+		{ INTEL_LUT_FORMAT_8, 1024, 256 },
+		{ INTEL_LUT_FORMAT_10, 1024, 1024 },
+		{ INTEL_LUT_FORMAT_10, 512, 512 },
+		{ INTEL_LUT_FORMAT_GLK_DEGAMMA, 33, -1 },
+		{ INTEL_LUT_FORMAT_MTL_DEGAMMA, 128, -1 },
+		{ INTEL_LUT_FORMAT_ICL_MULTI_SEG, 262145, 9 * 2 + 256 * 2 + 256 * 2 },
+	};
+	struct drm_i915_private *i915 = arg;
+	I915_RND_STATE(prng);
+	int n, i, err = 0;
+
+	/*
+	 * The LUT images are written out verbatim by load_luts(), so
+	 * they must contain exactly what the per-entry conversion wrote,
+	 * sampled and padded the same way.
+	 */
+
+	for (n = 0; n < ARRAY_SIZE(tests); n++) {
+		struct drm_property_blob *blob;
+		struct intel_lut_image *image;
+		int num_words = tests[n].num_words;
+
+		if (num_words < 0)
+			num_words = max(tests[n].lut_size,
+					glk_degamma_lut_size(i915));
+
+		blob = random_lut(i915, tests[n].lut_size, &prng);
+		if (IS_ERR(blob))
+			return PTR_ERR(blob);
+
+		image = intel_lut_image_create(i915, blob, tests[n].format);
+		if (IS_ERR(image)) {
+			drm_property_blob_put(blob);
+			return PTR_ERR(image);
+		}
+
+		if (image->num_words != num_words) {
+			pr_err("LUT format %d, %d entries: image has %d words, expected %d\n",
+			       tests[n].format, tests[n].lut_size,
+			       image->num_words, num_words);
+			err = -EINVAL;
+		}
+
+		for (i = 0; !err && i < num_words; i++) {
+			u32 expected = expected_word(tests[n].format, blob, i);
+
+			if (image->words[i] != expected) {
+				pr_err("LUT format %d, %d entries: word %d is %08x, expected %08x\n",
+				       tests[n].format, tests[n].lut_size, i,
+				       image->words[i], expected);
+				err = -EINVAL;
+			}
+		}
+
+		intel_color_lut_image_put(image);
+		drm_property_blob_put(blob);
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
+
+int intel_color_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_lut_pack_roundtrip),
+		SUBTEST(igt_lut_image),
+	};
+
+	return mock_gem_device_subtests(tests);
+}
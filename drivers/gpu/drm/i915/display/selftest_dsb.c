@@ -0,0 +1,461 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "i915_selftest.h"
+#include "skl_watermark_regs.h"
+
+#include "selftests/i915_random.h"
+#include "selftests/mock_gem_device.h"
+
+#define MOCK_DSB_CMDS 1024
+
+struct dsb_write {
+	u32 reg;
+	u32 val;
+	u32 byte_en;
+};
+
+/*
+ * A DSB that records into plain kernel memory. We never kick it, so there
+ * is no need for a GGTT binding, only for somewhere to report overflows.
+ */
+static struct intel_dsb *mock_dsb_create(struct drm_i915_private *i915)
+{
+	const size_t size = ALIGN(MOCK_DSB_CMDS * 8, CACHELINE_BYTES);
+	struct intel_crtc *crtc;
+	struct intel_dsb *dsb;
+
+	dsb = kzalloc(sizeof(*dsb), GFP_KERNEL);
+	if (!dsb)
+		return NULL;
+
+	crtc = kzalloc(sizeof(*crtc), GFP_KERNEL);
+	if (!crtc)
+		goto err_dsb;
+
+	dsb->dsb_buf.cmd_buf = kmalloc(size, GFP_KERNEL);
+	if (!dsb->dsb_buf.cmd_buf)
+		goto err_crtc;
+
+	crtc->base.dev = &i915->drm;
+	crtc->pipe = PIPE_A;
+
+	dsb->id = INTEL_DSB_1;
+	dsb->crtc = crtc;
+	dsb->size = size / 4;
+	dsb->dsb_buf.buf_size = size;
+
+	return dsb;
+
+err_crtc:
+	kfree(crtc);
+err_dsb:
+	kfree(dsb);
+	return NULL;
+}
+
+static void mock_dsb_reset(struct intel_dsb *dsb)
+{
+	/* Like i915_gem_object_create_internal(), don't start out zeroed */
+	memset(dsb->dsb_buf.cmd_buf, POISON_INUSE, dsb->dsb_buf.buf_size);
+	dsb->free_pos = 0;
+	dsb->ins_start_offset = 0;
+}
+
+static void mock_dsb_destroy(struct intel_dsb *dsb)
+{
+	kfree(dsb->dsb_buf.cmd_buf);
+	kfree(dsb->crtc);
+	kfree(dsb);
+}
+
+static int dsb_decode_write(struct dsb_write *w, unsigned int *count,
+			    unsigned int max, u32 reg, u32 val, u32 byte_en)
+{
+	if (*count == max) {
+		pr_err("More register writes decoded than were recorded\n");
+		return -E2BIG;
+	}
+
+	w[*count].reg = reg;
+	w[*count].val = val;
+	w[*count].byte_en = byte_en;
+	(*count)++;
+
+	return 0;
+}
+
+/*
+ * Decode the instruction stream the way the DSB engine would execute it,
+ * checking the layout rules along the way, and return the register writes.
+ */
+static int dsb_decode(struct intel_dsb *dsb, struct dsb_write *w,
+		      unsigned int max)
+{
+	unsigned int pos = 0, count = 0;
+	u32 prev_reg = 0;
+	bool prev_full = false;
+	int err;
+
+	while (pos < dsb->free_pos) {
+		u32 ldw = intel_dsb_buffer_read(&dsb->dsb_buf, pos);
+		u32 udw = intel_dsb_buffer_read(&dsb->dsb_buf, pos + 1);
+		u32 reg = udw & DSB_REG_VALUE_MASK;
+		u32 byte_en, n, i;
+
+		switch (udw >> DSB_OPCODE_SHIFT) {
+		case DSB_OPCODE_NOOP:
+			prev_full = false;
+			pos += 2;
+			break;
+
+		case DSB_OPCODE_MMIO_WRITE:
+			byte_en = (udw >> DSB_BYTE_EN_SHIFT) & DSB_BYTE_EN;
+			if (byte_en == DSB_BYTE_EN && prev_full && reg == prev_reg) {
+				pr_err("Consecutive writes to 0x%05x at dword %u not coalesced\n",
+				       reg, pos);
+				return -EINVAL;
+			}
+
+			err = dsb_decode_write(w, &count, max, reg, ldw, byte_en);
+			if (err)
+				return err;
+
+			prev_full = byte_en == DSB_BYTE_EN;
+			prev_reg = reg;
+			pos += 2;
+			break;
+
+		case DSB_OPCODE_INDEXED_WRITE:
+			n = ldw;
+			if (n < 2 || pos + 2 + n > dsb->free_pos) {
+				pr_err("Indexed write of %u dwords at dword %u overruns the buffer (tail %u)\n",
+				       n, pos, dsb->free_pos);
+				return -EINVAL;
+			}
+
+			for (i = 0; i < n; i++) {
+				err = dsb_decode_write(w, &count, max, reg,
+						       intel_dsb_buffer_read(&dsb->dsb_buf,
+									     pos + 2 + i),
+						       DSB_BYTE_EN);
+				if (err)
+					return err;
+			}
+
+			pos += 2 + n;
+			if (pos & 1) {
+				if (intel_dsb_buffer_read(&dsb->dsb_buf, pos)) {
+					pr_err("Indexed write at dword %u not zero padded\n",
+					       pos);
+					return -EINVAL;
+				}
+				pos++;
+			}
+
+			prev_full = true;
+			prev_reg = reg;
+			break;
+
+		default:
+			pr_err("Unexpected DSB instruction %08x %08x at dword %u\n",
+			       ldw, udw, pos);
+			return -EINVAL;
+		}
+	}
+
+	if (pos != dsb->free_pos) {
+		pr_err("Last instruction runs past the tail (%u > %u)\n",
+		       pos, dsb->free_pos);
+		return -EINVAL;
+	}
+
+	return count;
+}
+
+static int dsb_check(struct intel_dsb *dsb,
+		     const struct dsb_write *expected, unsigned int count)
+{
+	struct dsb_write *w;
+	int n, i, err = 0;
+
+	intel_dsb_align_tail(dsb);
+	if (!IS_ALIGNED(dsb->free_pos * 4, CACHELINE_BYTES)) {
+		pr_err("DSB tail %u not cacheline aligned\n", dsb->free_pos);
+		return -EINVAL;
+	}
+
+	w = kcalloc(count + 1, sizeof(*w), GFP_KERNEL);
+	if (!w)
+		return -ENOMEM;
+
+	n = dsb_decode(dsb, w, count + 1);
+	if (n < 0) {
+		err = n;
+		goto out;
+	}
+
+	if (n != count) {
+		pr_err("Decoded %d register writes, expected %u\n", n, count);
+		err = -EINVAL;
+		goto out;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (memcmp(&w[i], &expected[i], sizeof(*w))) {
+			pr_err("Register write %d decoded as { 0x%05x = %08x, byte_en %x }, expected { 0x%05x = %08x, byte_en %x }\n",
+			       i, w[i].reg, w[i].val, w[i].byte_en,
+			       expected[i].reg, expected[i].val,
+			       expected[i].byte_en);
+			err = -EINVAL;
+			goto out;
+		}
+	}
+
+out:
+	kfree(w);
+	return err;
+}
+
+static void expect_write(struct dsb_write *expected, unsigned int *count,
+			 i915_reg_t reg, u32 val, u32 byte_en)
+{
+	expected[*count].reg = i915_mmio_reg_offset(reg);
+	expected[*count].val = val;
+	expected[*count].byte_en = byte_en;
+	(*count)++;
+}
+
+static int igt_dsb_reg_write(void *arg)
+{
+	struct drm_i915_private *i915 = arg;
+	struct dsb_write *expected;
+	struct intel_dsb *dsb;
+	unsigned int pass;
+	I915_RND_STATE(prng);
+	int err = 0;
+
+	/*
+	 * Record random mixtures of single, repeated (as for LUTs and
+	 * other auto-incrementing registers), bulk, masked writes and noops,
+	 * and check that the DSB would perform exactly the same register
+	 * writes, in the same order, with every run of full writes to the
+	 * same register coalesced into an indexed write.
+	 */
+
+	/* Indexed writes take a single dword per register write */
+	expected = kcalloc(2 * MOCK_DSB_CMDS, sizeof(*expected), GFP_KERNEL);
+	if (!expected)
+		return -ENOMEM;
+
+	dsb = mock_dsb_create(i915);
+	if (!dsb) {
+		err = -ENOMEM;
+		goto out_free;
+	}
+
+	for (pass = 0; pass < 1024; pass++) {
+		unsigned int count = 0;
+
+		mock_dsb_reset(dsb);
+
+		/* Leave room for the longest run, plus padding */
+		while (dsb->free_pos < 2 * MOCK_DSB_CMDS - 128) {
+			/* A small set of registers, so that we get repeats */
+			i915_reg_t reg =
+				_MMIO(0x70000 + 4 * i915_prandom_u32_max_state(4, &prng));
+			u32 vals[64];
+			u32 mask, n, i;
+
+			switch (i915_prandom_u32_max_state(5, &prng)) {
+			case 0:
+				n = 1;
+				break;
+			case 1:
+				n = 1 + i915_prandom_u32_max_state(64, &prng);
+				break;
+			case 2:
+				/* Partial writes are never coalesced */
+				mask = prandom_u32_state(&prng) &
+					~(0xffu << (8 * i915_prandom_u32_max_state(4, &prng)));
+				expect_write(expected, &count, reg,
+					     prandom_u32_state(&prng),
+					     intel_dsb_mask_to_byte_en(mask));
+				intel_dsb_reg_write_masked(dsb, reg, mask,
+							   expected[count - 1].val);
+				continue;
+			case 3:
+				/* Same as the equivalent run of single writes */
+				n = 1 + i915_prandom_u32_max_state(ARRAY_SIZE(vals), &prng);
+				for (i = 0; i < n; i++) {
+					vals[i] = prandom_u32_state(&prng);
+					expect_write(expected, &count, reg,
+						     vals[i], DSB_BYTE_EN);
+				}
+				intel_dsb_reg_write_indexed(dsb, reg, vals, n);
+				continue;
+			default:
+				intel_dsb_noop(dsb, 1 + i915_prandom_u32_max_state(4, &prng));
+				continue;
+			}
+
+			while (n--) {
+				expect_write(expected, &count, reg,
+					     prandom_u32_state(&prng),
+					     DSB_BYTE_EN);
+				intel_dsb_reg_write(dsb, reg,
+						    expected[count - 1].val);
+			}
+		}
+
+		err = dsb_check(dsb, expected, count);
+		if (err) {
+			pr_err("Pass %u failed\n", pass);
+			break;
+		}
+
+		cond_resched();
+	}
+
+	mock_dsb_destroy(dsb);
+out_free:
+	kfree(expected);
+	return err;
+}
+
+static void random_wm_level(struct skl_wm_level *level, struct rnd_state *prng)
+{
+	level->enable = i915_prandom_u32_max_state(2, prng);
+	level->ignore_lines = i915_prandom_u32_max_state(2, prng);
+	level->blocks = i915_prandom_u32_max_state(PLANE_WM_BLOCKS_MASK + 1, prng);
+	level->lines = i915_prandom_u32_max_state(U8_MAX + 1, prng);
+}
+
+static u32 wm_level_val(const struct skl_wm_level *level)
+{
+	return (level->enable ? PLANE_WM_EN : 0) |
+		(level->ignore_lines ? PLANE_WM_IGNORE_LINES : 0) |
+		REG_FIELD_PREP(PLANE_WM_BLOCKS_MASK, level->blocks) |
+		REG_FIELD_PREP(PLANE_WM_LINES_MASK, level->lines);
+}
+
+static u32 ddb_val(const struct skl_ddb_entry *entry)
+{
+	if (!entry->end)
+		return 0;
+
+	return PLANE_BUF_END(entry->end - 1) | PLANE_BUF_START(entry->start);
+}
+
+static int igt_dsb_plane_wm(void *arg)
+{
+	struct drm_i915_private *i915 = arg;
+	const u8 num_levels = i915->display.wm.num_levels;
+	struct intel_crtc_state *crtc_state;
+	struct dsb_write expected[16];
+	struct intel_plane *plane;
+	struct intel_dsb *dsb;
+	unsigned int pass;
+	I915_RND_STATE(prng);
+	int err = 0;
+
+	/*
+	 * The watermarks and DDB allocation are the bulk of a plane update,
+	 * check that skl_write_plane_wm() records them all into the commit
+	 * DSB when there is one.
+	 */
+
+	dsb = mock_dsb_create(i915);
+	plane = kzalloc(sizeof(*plane), GFP_KERNEL);
+	crtc_state = kzalloc(sizeof(*crtc_state), GFP_KERNEL);
+	if (!dsb || !plane || !crtc_state) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	plane->base.dev = &i915->drm;
+	crtc_state->dsb_commit = dsb;
+	i915->display.wm.num_levels = 8;
+
+	for (pass = 0; pass < 256; pass++) {
+		struct skl_pipe_wm *pipe_wm = &crtc_state->wm.skl.optimal;
+		struct skl_ddb_entry *ddb, *ddb_y;
+		struct skl_plane_wm *wm;
+		unsigned int count = 0;
+		enum plane_id plane_id;
+		enum pipe pipe;
+		int level;
+
+		pipe = i915_prandom_u32_max_state(I915_MAX_PIPES, &prng);
+		plane_id = i915_prandom_u32_max_state(PLANE_CURSOR, &prng);
+		plane->pipe = pipe;
+		plane->id = plane_id;
+
+		wm = &pipe_wm->planes[plane_id];
+		for (level = 0; level < ARRAY_SIZE(wm->wm); level++)
+			random_wm_level(&wm->wm[level], &prng);
+		random_wm_level(&wm->trans_wm, &prng);
+		random_wm_level(&wm->sagv.wm0, &prng);
+		random_wm_level(&wm->sagv.trans_wm, &prng);
+		pipe_wm->use_sagv_wm = i915_prandom_u32_max_state(2, &prng);
+
+		ddb = &crtc_state->wm.skl.plane_ddb[plane_id];
+		ddb_y = &crtc_state->wm.skl.plane_ddb_y[plane_id];
+		ddb->start = i915_prandom_u32_max_state(1024, &prng);
+		ddb->end = ddb->start + i915_prandom_u32_max_state(1024, &prng);
+		ddb_y->start = ddb->end;
+		ddb_y->end = ddb_y->start + i915_prandom_u32_max_state(1024, &prng);
+
+		for (level = 0; level < i915->display.wm.num_levels; level++)
+			expect_write(expected, &count, PLANE_WM(pipe, plane_id, level),
+				     wm_level_val(level == 0 && pipe_wm->use_sagv_wm ?
+						  &wm->sagv.wm0 : &wm->wm[level]),
+				     DSB_BYTE_EN);
+		expect_write(expected, &count, PLANE_WM_TRANS(pipe, plane_id),
+			     wm_level_val(pipe_wm->use_sagv_wm ?
+					  &wm->sagv.trans_wm : &wm->trans_wm),
+			     DSB_BYTE_EN);
+		if (HAS_HW_SAGV_WM(i915)) {
+			expect_write(expected, &count, PLANE_WM_SAGV(pipe, plane_id),
+				     wm_level_val(&wm->sagv.wm0), DSB_BYTE_EN);
+			expect_write(expected, &count, PLANE_WM_SAGV_TRANS(pipe, plane_id),
+				     wm_level_val(&wm->sagv.trans_wm), DSB_BYTE_EN);
+		}
+		expect_write(expected, &count, PLANE_BUF_CFG(pipe, plane_id),
+			     ddb_val(ddb), DSB_BYTE_EN);
+		if (DISPLAY_VER(i915) < 11)
+			expect_write(expected, &count,
+				     PLANE_NV12_BUF_CFG(pipe, plane_id),
+				     ddb_val(ddb_y), DSB_BYTE_EN);
+
+		mock_dsb_reset(dsb);
+		skl_write_plane_wm(plane, crtc_state);
+
+		err = dsb_check(dsb, expected, count);
+		if (err) {
+			pr_err("Pass %u (pipe %c, plane %d) failed\n",
+			       pass, pipe_name(pipe), plane_id);
+			break;
+		}
+	}
+
+	i915->display.wm.num_levels = num_levels;
+out:
+	kfree(crtc_state);
+	kfree(plane);
+	if (dsb)
+		mock_dsb_destroy(dsb);
+	return err;
+}
+
+int intel_dsb_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_dsb_reg_write),
+		SUBTEST(igt_dsb_plane_wm),
+	};
+
+	return mock_gem_device_subtests(tests);
+}
@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include <linux/bitmap.h>
+
+#include "i915_selftest.h"
+
+#include "selftests/i915_random.h"
+
+#define PSR_TRACE_MAX_HEIGHT 2160
+
+struct psr_damage_frame {
+	int num_rects;
+	struct drm_rect rects[4];
+};
+
+struct psr_damage_trace {
+	const char *name;
+	int width, height;
+	u16 y_alignment;
+	int num_frames;
+	struct psr_damage_frame frames[4];
+	unsigned int fetched_lines;
+};
+
+/*
+ * Replay the damage of one frame the way intel_psr2_sel_fetch_update()
+ * does and return the number of lines the frame fetches.
+ */
+static int psr_replay_frame(const struct psr_damage_trace *trace,
+			    const struct psr_damage_frame *frame,
+			    struct drm_rect *su_area,
+			    unsigned long *damaged)
+{
+	struct drm_rect pipe_src = {
+		.x2 = trace->width,
+		.y2 = trace->height,
+	};
+	int i;
+
+	su_area->x1 = 0;
+	su_area->y1 = -1;
+	su_area->x2 = INT_MAX;
+	su_area->y2 = -1;
+
+	for (i = 0; i < frame->num_rects; i++) {
+		struct drm_rect damage = frame->rects[i];
+
+		clip_area_update(su_area, &damage, &pipe_src);
+
+		if (damaged && drm_rect_visible(&damage))
+			bitmap_set(damaged, damage.y1, drm_rect_height(&damage));
+	}
+
+	if (su_area->y1 == -1)
+		return trace->height;
+
+	psr2_su_area_align(su_area, trace->y_alignment);
+
+	if (psr2_su_area_covers_pipe(su_area, &pipe_src))
+		return trace->height;
+
+	return drm_rect_height(su_area);
+}
+
+static int igt_psr_damage_traces(void *arg)
+{
+	static const struct psr_damage_trace traces[] = {
+		{
+			.name = "cursor",
+			.width = 1920, .height = 1080, .y_alignment = 4,
+			.num_frames = 2,
+			.frames = {
+				{ 2, { { 100, 100, 164, 164 },
+				       { 110, 104, 174, 168 } } },
+				{ 2, { { 500, 301, 564, 365 },
+				       { 505, 306, 569, 370 } } },
+			},
+			.fetched_lines = 68 + 72,
+		},
+		{
+			.name = "top-and-bottom",
+			.width = 1920, .height = 1080, .y_alignment = 4,
+			.num_frames = 2,
+			.frames = {
+				{ 2, { { 0, 0, 1920, 32 },
+				       { 0, 1048, 1920, 1080 } } },
+				{ 2, { { 0, 0, 1920, 16 },
+				       { 0, 1000, 1920, 1010 } } },
+			},
+			.fetched_lines = 1080 + 1012,
+		},
+		{
+			.name = "offscreen",
+			.width = 1920, .height = 1080, .y_alignment = 4,
+			.num_frames = 2,
+			.frames = {
+				{ 1, { { 0, 1070, 100, 1200 } } },
+				{ 1, { { -50, -20, 10, 10 } } },
+			},
+			.fetched_lines = 12 + 12,
+		},
+		{
+			.name = "idle",
+			.width = 1920, .height = 1080, .y_alignment = 4,
+			.num_frames = 2,
+			.frames = {
+				{ 0 },
+				{ 1, { { 0, 500, 1920, 501 } } },
+			},
+			.fetched_lines = 1080 + 4,
+		},
+		{
+			.name = "dsc-slices",
+			.width = 3840, .height = 2160, .y_alignment = 60,
+			.num_frames = 3,
+			.frames = {
+				{ 1, { { 0, 100, 3840, 130 } } },
+				{ 1, { { 0, 0, 3840, 2100 } } },
+				{ 2, { { 0, 2130, 10, 2140 },
+				       { 0, 10, 10, 20 } } },
+			},
+			.fetched_lines = 120 + 2100 + 2160,
+		},
+	};
+	DECLARE_BITMAP(damaged, PSR_TRACE_MAX_HEIGHT);
+	int n, i;
+
+	/*
+	 * Report how many lines each recorded damage trace fetches with
+	 * selective fetch, compared to the lines actually damaged and to
+	 * full frame updates, and check that against the expected count.
+	 */
+
+	for (n = 0; n < ARRAY_SIZE(traces); n++) {
+		const struct psr_damage_trace *trace = &traces[n];
+		unsigned int fetched = 0, damaged_lines = 0;
+
+		for (i = 0; i < trace->num_frames; i++) {
+			struct drm_rect su_area;
+
+			bitmap_zero(damaged, PSR_TRACE_MAX_HEIGHT);
+			fetched += psr_replay_frame(trace, &trace->frames[i],
+						    &su_area, damaged);
+			damaged_lines += bitmap_weight(damaged, trace->height);
+		}
+
+		pr_info("PSR2 damage trace %s: %u lines fetched, %u damaged, %u with full frames\n",
+			trace->name, fetched, damaged_lines,
+			trace->num_frames * trace->height);
+
+		if (fetched != trace->fetched_lines) {
+			pr_err("PSR2 damage trace %s fetched %u lines, expected %u\n",
+			       trace->name, fetched, trace->fetched_lines);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int igt_psr_su_area(void *arg)
+{
+	static const u16 alignments[] = { 1, 2, 4, 8, 60, 108 };
+	unsigned int pass;
+	I915_RND_STATE(prng);
+
+	/*
+	 * Whatever the damage, the SU region must be aligned, stay within
+	 * the pipe and cover all of the visible damage, while never being
+	 * more than one alignment step larger than that damage.
+	 */
+
+	for (pass = 0; pass < 4096; pass++) {
+		struct psr_damage_trace trace = {};
+		struct psr_damage_frame *frame = &trace.frames[0];
+		int min_y = INT_MAX, max_y = INT_MIN;
+		struct drm_rect pipe_src, su_area;
+		int lines, i;
+
+		trace.y_alignment = alignments[i915_prandom_u32_max_state(ARRAY_SIZE(alignments),
+									   &prng)];
+		trace.height = trace.y_alignment *
+			(1 + i915_prandom_u32_max_state(PSR_TRACE_MAX_HEIGHT / trace.y_alignment,
+							&prng));
+		trace.width = 1 + i915_prandom_u32_max_state(4096, &prng);
+		trace.num_frames = 1;
+		drm_rect_init(&pipe_src, 0, 0, trace.width, trace.height);
+
+		frame->num_rects = i915_prandom_u32_max_state(ARRAY_SIZE(frame->rects) + 1,
+							      &prng);
+		for (i = 0; i < frame->num_rects; i++) {
+			struct drm_rect *r = &frame->rects[i];
+			struct drm_rect clip;
+
+			r->x1 = (int)i915_prandom_u32_max_state(trace.width * 2, &prng) -
+				trace.width / 2;
+			r->y1 = (int)i915_prandom_u32_max_state(trace.height * 2, &prng) -
+				trace.height / 2;
+			r->x2 = r->x1 + 1 + i915_prandom_u32_max_state(trace.width, &prng);
+			r->y2 = r->y1 + 1 + i915_prandom_u32_max_state(trace.height, &prng);
+
+			clip = *r;
+			if (!drm_rect_intersect(&clip, &pipe_src))
+				continue;
+
+			min_y = min(min_y, clip.y1);
+			max_y = max(max_y, clip.y2);
+		}
+
+		lines = psr_replay_frame(&trace, frame, &su_area, NULL);
+
+		if (min_y == INT_MAX) {
+			if (su_area.y1 != -1 || lines != trace.height) {
+				pr_err("No visible damage, but SU region [%d, %d) fetching %d lines\n",
+				       su_area.y1, su_area.y2, lines);
+				return -EINVAL;
+			}
+			continue;
+		}
+
+		if (su_area.y1 % trace.y_alignment || su_area.y2 % trace.y_alignment ||
+		    su_area.y1 < 0 || su_area.y2 > trace.height ||
+		    su_area.y1 > min_y || su_area.y2 < max_y ||
+		    min_y - su_area.y1 >= trace.y_alignment ||
+		    su_area.y2 - max_y >= trace.y_alignment) {
+			pr_err("Damage [%d, %d) with alignment %u on a %d line pipe gave SU region [%d, %d)\n",
+			       min_y, max_y, trace.y_alignment, trace.height,
+			       su_area.y1, su_area.y2);
+			return -EINVAL;
+		}
+
+		if (lines > trace.height || lines < drm_rect_height(&su_area)) {
+			pr_err("SU region [%d, %d) on a %d line pipe fetching %d lines\n",
+			       su_area.y1, su_area.y2, trace.height, lines);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+int intel_psr_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_psr_damage_traces),
+		SUBTEST(igt_psr_su_area),
+	};
+
+	return i915_subtests(tests, NULL);
+}
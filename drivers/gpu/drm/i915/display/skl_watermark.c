@@ -2349,19 +2349,19 @@ static int skl_build_pipe_wm(struct intel_atomic_state *state,
 }
 
 static void skl_ddb_entry_write(struct drm_i915_private *i915,
-				i915_reg_t reg,
+				struct intel_dsb *dsb, i915_reg_t reg,
 				const struct skl_ddb_entry *entry)
 {
 	if (entry->end)
-		intel_de_write_fw(i915, reg,
-				  PLANE_BUF_END(entry->end - 1) |
-				  PLANE_BUF_START(entry->start));
+		intel_de_write_dsb(i915, dsb, reg,
+				   PLANE_BUF_END(entry->end - 1) |
+				   PLANE_BUF_START(entry->start));
 	else
-		intel_de_write_fw(i915, reg, 0);
+		intel_de_write_dsb(i915, dsb, reg, 0);
 }
 
 static void skl_write_wm_level(struct drm_i915_private *i915,
-			       i915_reg_t reg,
+			       struct intel_dsb *dsb, i915_reg_t reg,
 			       const struct skl_wm_level *level)
 {
 	u32 val = 0;
@@ -2373,13 +2373,14 @@ static void skl_write_wm_level(struct drm_i915_private *i915,
 	val |= REG_FIELD_PREP(PLANE_WM_BLOCKS_MASK, level->blocks);
 	val |= REG_FIELD_PREP(PLANE_WM_LINES_MASK, level->lines);
 
-	intel_de_write_fw(i915, reg, val);
+	intel_de_write_dsb(i915, dsb, reg, val);
 }
 
 void skl_write_plane_wm(struct intel_plane *plane,
 			const struct intel_crtc_state *crtc_state)
 {
 	struct drm_i915_private *i915 = to_i915(plane->base.dev);
+	struct intel_dsb *dsb = crtc_state->dsb_commit;
 	enum plane_id plane_id = plane->id;
 	enum pipe pipe = plane->pipe;
 	const struct skl_pipe_wm *pipe_wm = &crtc_state->wm.skl.optimal;
@@ -2390,26 +2391,26 @@ void skl_write_plane_wm(struct intel_plane *plane,
 	int level;
 
 	for (level = 0; level < i915->display.wm.num_levels; level++)
-		skl_write_wm_level(i915, PLANE_WM(pipe, plane_id, level),
+		skl_write_wm_level(i915, dsb, PLANE_WM(pipe, plane_id, level),
 				   skl_plane_wm_level(pipe_wm, plane_id, level));
 
-	skl_write_wm_level(i915, PLANE_WM_TRANS(pipe, plane_id),
+	skl_write_wm_level(i915, dsb, PLANE_WM_TRANS(pipe, plane_id),
 			   skl_plane_trans_wm(pipe_wm, plane_id));
 
 	if (HAS_HW_SAGV_WM(i915)) {
 		const struct skl_plane_wm *wm = &pipe_wm->planes[plane_id];
 
-		skl_write_wm_level(i915, PLANE_WM_SAGV(pipe, plane_id),
+		skl_write_wm_level(i915, dsb, PLANE_WM_SAGV(pipe, plane_id),
 				   &wm->sagv.wm0);
-		skl_write_wm_level(i915, PLANE_WM_SAGV_TRANS(pipe, plane_id),
+		skl_write_wm_level(i915, dsb, PLANE_WM_SAGV_TRANS(pipe, plane_id),
 				   &wm->sagv.trans_wm);
 	}
 
-	skl_ddb_entry_write(i915,
+	skl_ddb_entry_write(i915, dsb,
 			    PLANE_BUF_CFG(pipe, plane_id), ddb);
 
 	if (DISPLAY_VER(i915) < 11)
-		skl_ddb_entry_write(i915,
+		skl_ddb_entry_write(i915, dsb,
 				    PLANE_NV12_BUF_CFG(pipe, plane_id), ddb_y);
 }
 
@@ -2417,6 +2418,7 @@ void skl_write_cursor_wm(struct intel_plane *plane,
 			 const struct intel_crtc_state *crtc_state)
 {
 	struct drm_i915_private *i915 = to_i915(plane->base.dev);
+	struct intel_dsb *dsb = crtc_state->dsb_commit;
 	enum plane_id plane_id = plane->id;
 	enum pipe pipe = plane->pipe;
 	const struct skl_pipe_wm *pipe_wm = &crtc_state->wm.skl.optimal;
@@ -2425,22 +2427,22 @@ void skl_write_cursor_wm(struct intel_plane *plane,
 	int level;
 
 	for (level = 0; level < i915->display.wm.num_levels; level++)
-		skl_write_wm_level(i915, CUR_WM(pipe, level),
+		skl_write_wm_level(i915, dsb, CUR_WM(pipe, level),
 				   skl_plane_wm_level(pipe_wm, plane_id, level));
 
-	skl_write_wm_level(i915, CUR_WM_TRANS(pipe),
+	skl_write_wm_level(i915, dsb, CUR_WM_TRANS(pipe),
 			   skl_plane_trans_wm(pipe_wm, plane_id));
 
 	if (HAS_HW_SAGV_WM(i915)) {
 		const struct skl_plane_wm *wm = &pipe_wm->planes[plane_id];
 
-		skl_write_wm_level(i915, CUR_WM_SAGV(pipe),
+		skl_write_wm_level(i915, dsb, CUR_WM_SAGV(pipe),
 				   &wm->sagv.wm0);
-		skl_write_wm_level(i915, CUR_WM_SAGV_TRANS(pipe),
+		skl_write_wm_level(i915, dsb, CUR_WM_SAGV_TRANS(pipe),
 				   &wm->sagv.trans_wm);
 	}
 
-	skl_ddb_entry_write(i915, CUR_BUF_CFG(pipe), ddb);
+	skl_ddb_entry_write(i915, dsb, CUR_BUF_CFG(pipe), ddb);
 }
 
 static bool skl_wm_level_equals(const struct skl_wm_level *l1,
@@ -100,12 +100,59 @@ void i915_lut_handle_free(struct i915_lut_handle *lut)
 	return kmem_cache_free(slab_luts, lut);
 }
 
+struct i915_gem_resident_set *
+i915_gem_resident_set_create(struct i915_gem_context *ctx,
+			     const struct i915_address_space *vm,
+			     unsigned int count)
+{
+	struct i915_gem_resident_set *set;
+
+	set = kvmalloc(struct_size(set, entries, count), GFP_KERNEL);
+	if (!set)
+		return NULL;
+
+	kref_init(&set->ref);
+	set->vm = vm;
+	set->lut_gen = READ_ONCE(ctx->lut_gen);
+	set->invalid_flags = 0;
+	set->count = 0;
+
+	return set;
+}
+
+void __i915_gem_resident_set_release(struct kref *ref)
+{
+	struct i915_gem_resident_set *set = container_of(ref, typeof(*set), ref);
+
+	kvfree_rcu(set, rcu);
+}
+
+void i915_gem_context_set_resident_set(struct i915_gem_context *ctx,
+				       struct i915_gem_resident_set *set)
+{
+	mutex_lock(&ctx->lut_mutex);
+	/*
+	 * Only publish the new set if none of the handles it refers to were
+	 * closed while we were building it, and the context is still open.
+	 */
+	if (set->lut_gen == ctx->lut_gen && !i915_gem_context_is_closed(ctx))
+		set = rcu_replace_pointer(ctx->resident_set, set,
+					  lockdep_is_held(&ctx->lut_mutex));
+	mutex_unlock(&ctx->lut_mutex);
+
+	i915_gem_resident_set_put(set);
+}
+
 static void lut_close(struct i915_gem_context *ctx)
 {
+	struct i915_gem_resident_set *set;
 	struct radix_tree_iter iter;
 	void __rcu **slot;
 
 	mutex_lock(&ctx->lut_mutex);
+	WRITE_ONCE(ctx->lut_gen, ctx->lut_gen + 1);
+	set = rcu_replace_pointer(ctx->resident_set, NULL,
+				  lockdep_is_held(&ctx->lut_mutex));
 	rcu_read_lock();
 	radix_tree_for_each_slot(slot, &ctx->handles_vma, &iter, 0) {
 		struct i915_vma *vma = rcu_dereference_raw(*slot);
@@ -139,6 +186,8 @@ static void lut_close(struct i915_gem_context *ctx)
 	}
 	rcu_read_unlock();
 	mutex_unlock(&ctx->lut_mutex);
+
+	i915_gem_resident_set_put(set);
 }
 
 static struct intel_context *
@@ -1292,6 +1341,8 @@ static void i915_gem_context_release_work(struct work_struct *work)
 	if (ctx->client)
 		i915_drm_client_put(ctx->client);
 
+	i915_gem_resident_set_put(rcu_access_pointer(ctx->resident_set));
+
 	mutex_destroy(&ctx->engines_mutex);
 	mutex_destroy(&ctx->lut_mutex);
 
@@ -241,6 +241,35 @@ int i915_gem_context_module_init(void);
 struct i915_lut_handle *i915_lut_handle_alloc(void);
 void i915_lut_handle_free(struct i915_lut_handle *lut);
 
+struct i915_gem_resident_set *
+i915_gem_resident_set_create(struct i915_gem_context *ctx,
+			     const struct i915_address_space *vm,
+			     unsigned int count);
+void __i915_gem_resident_set_release(struct kref *ref);
+
+static inline struct i915_gem_resident_set *
+i915_gem_context_get_resident_set(struct i915_gem_context *ctx)
+{
+	struct i915_gem_resident_set *set;
+
+	rcu_read_lock();
+	set = rcu_dereference(ctx->resident_set);
+	if (set && !kref_get_unless_zero(&set->ref))
+		set = NULL;
+	rcu_read_unlock();
+
+	return set;
+}
+
+static inline void i915_gem_resident_set_put(struct i915_gem_resident_set *set)
+{
+	if (set)
+		kref_put(&set->ref, __i915_gem_resident_set_release);
+}
+
+void i915_gem_context_set_resident_set(struct i915_gem_context *ctx,
+				       struct i915_gem_resident_set *set);
+
 int i915_gem_user_to_context_sseu(struct intel_gt *gt,
 				  const struct drm_i915_gem_context_param_sseu *user,
 				  struct intel_sseu *context);
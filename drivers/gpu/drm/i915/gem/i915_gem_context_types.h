@@ -219,6 +219,56 @@ struct i915_gem_proto_context {
 	intel_wakeref_t pxp_wakeref;
 };
 
+/**
+ * struct i915_gem_resident_set - cached execbuf object list of a context
+ *
+ * Registered through the execbuf resident set extension, see
+ * struct drm_i915_gem_execbuffer_ext_resident_set. Each entry remembers the
+ * user supplied execobject fields that were validated, together with the
+ * vma that the handle resolved to, so that a later execbuf presenting the
+ * same execobject can skip the handle lookup and validation.
+ *
+ * The entries do not hold references of their own; the vma are kept alive
+ * by the context's &i915_gem_context.handles_vma for as long as
+ * &i915_gem_context.lut_gen is unchanged. A resident set is immutable once
+ * published.
+ */
+struct i915_gem_resident_set {
+	/** @ref: reference count */
+	struct kref ref;
+	/** @rcu: rcu head for freeing the resident set */
+	struct rcu_head rcu;
+
+	/** @vm: address space the entries were looked up in */
+	const struct i915_address_space *vm;
+	/** @lut_gen: &i915_gem_context.lut_gen at the time of lookup */
+	unsigned int lut_gen;
+	/** @invalid_flags: execobject flags rejected during validation */
+	u64 invalid_flags;
+
+	/** @count: number of entries */
+	unsigned int count;
+	/** @entries: one per execobject, in execbuf order */
+	struct i915_gem_resident_entry {
+		/** @entries.vma: vma the handle resolved to */
+		struct i915_vma *vma;
+		/** @entries.handle: user handle */
+		u32 handle;
+		/** @entries.flags: execobject flags as passed by the user */
+		u64 flags;
+		/** @entries.validated: execobject flags after validation */
+		u64 validated;
+		/** @entries.alignment: execobject alignment */
+		u64 alignment;
+		/** @entries.pad_to_size: execobject pad_to_size as passed by the user */
+		u64 pad_to_size;
+		/** @entries.padding: execobject pad_to_size after validation */
+		u64 padding;
+		/** @entries.offset: execobject offset, for EXEC_OBJECT_PINNED */
+		u64 offset;
+	} entries[];
+};
+
 /**
  * struct i915_gem_context - client state
  *
@@ -401,6 +451,18 @@ struct i915_gem_context {
 	/** @lut_mutex: Locks handles_vma */
 	struct mutex lut_mutex;
 
+	/**
+	 * @lut_gen: incremented under @lut_mutex whenever a handle is
+	 * removed from @handles_vma, invalidating @resident_set
+	 */
+	unsigned int lut_gen;
+
+	/**
+	 * @resident_set: last object list registered through the execbuf
+	 * resident set extension, replaced under @lut_mutex
+	 */
+	struct i915_gem_resident_set __rcu *resident_set;
+
 	/**
 	 * @name: arbitrary name, used for user debug
 	 *
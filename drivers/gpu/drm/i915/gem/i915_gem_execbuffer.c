@@ -314,6 +314,11 @@ struct i915_execbuffer {
 
 	struct eb_fence *fences;
 	unsigned long num_fences;
+
+	bool use_resident; /** resident set extension was supplied */
+	u32 resident_flags; /** resident set extension flags */
+	struct i915_gem_resident_set *resident; /** last registered set */
+	struct i915_gem_resident_set *resident_update; /** set to register */
 #if IS_ENABLED(CONFIG_DRM_I915_CAPTURE_ERROR)
 	struct i915_capture_list *capture_lists[MAX_ENGINE_INSTANCE + 1];
 #endif
@@ -940,6 +945,139 @@ static struct i915_vma *eb_lookup_vma(struct i915_execbuffer *eb, u32 handle)
 	} while (1);
 }
 
+static int eb_resident_set_init(struct i915_execbuffer *eb)
+{
+	struct i915_gem_context *ctx = eb->gem_context;
+	struct i915_gem_resident_set *set;
+
+	if (!eb->use_resident)
+		return 0;
+
+	if (eb->resident_flags & I915_EXEC_RESIDENT_SET_UPDATE) {
+		eb->resident_update =
+			i915_gem_resident_set_create(ctx, eb->context->vm,
+						     eb->buffer_count);
+		if (!eb->resident_update)
+			return -ENOMEM;
+
+		eb->resident_update->invalid_flags = eb->invalid_flags;
+		return 0;
+	}
+
+	set = i915_gem_context_get_resident_set(ctx);
+	if (!set)
+		return 0;
+
+	if (set->vm != eb->context->vm ||
+	    set->invalid_flags != eb->invalid_flags) {
+		i915_gem_resident_set_put(set);
+		return 0;
+	}
+
+	eb->resident = set;
+	return 0;
+}
+
+static struct i915_vma *
+eb_lookup_resident(struct i915_execbuffer *eb,
+		   struct drm_i915_gem_exec_object2 *entry,
+		   unsigned int i)
+{
+	const struct i915_gem_resident_set *set = eb->resident;
+	const struct i915_gem_resident_entry *re;
+	struct i915_vma *vma;
+
+	if (!set || i >= set->count)
+		return NULL;
+
+	re = &set->entries[i];
+	if (re->handle != entry->handle ||
+	    re->flags != entry->flags ||
+	    re->alignment != entry->alignment ||
+	    re->pad_to_size != entry->pad_to_size ||
+	    entry->relocation_count)
+		return NULL;
+
+	if (entry->flags & EXEC_OBJECT_PINNED && re->offset != entry->offset)
+		return NULL;
+
+	/*
+	 * The vma is only kept alive by the handle lut, so double check
+	 * that no handle has been closed since we built the resident set.
+	 */
+	rcu_read_lock();
+	vma = NULL;
+	if (likely(READ_ONCE(eb->gem_context->lut_gen) == set->lut_gen))
+		vma = i915_vma_tryget(re->vma);
+	rcu_read_unlock();
+	if (unlikely(!vma))
+		return NULL;
+
+	/* Fence requirements follow the object tiling, so check again */
+	if (unlikely(eb->reloc_cache.has_fence)) {
+		if (eb_validate_vma(eb, entry, vma)) {
+			i915_vma_put(vma);
+			return NULL;
+		}
+		return vma;
+	}
+
+	entry->flags = re->validated;
+	entry->pad_to_size = re->padding;
+	entry->offset = gen8_noncanonical_addr(entry->offset);
+	return vma;
+}
+
+static void eb_resident_record(struct i915_execbuffer *eb,
+			       const struct drm_i915_gem_exec_object2 *user,
+			       unsigned int i,
+			       struct i915_vma *vma)
+{
+	struct i915_gem_resident_set *set = eb->resident_update;
+	struct i915_gem_resident_entry *re;
+
+	if (!set)
+		return;
+
+	GEM_BUG_ON(set->count != i);
+	re = &set->entries[set->count++];
+	re->vma = vma;
+	re->handle = user->handle;
+	re->flags = user->flags;
+	re->validated = eb->exec[i].flags;
+	re->alignment = user->alignment;
+	re->pad_to_size = user->pad_to_size;
+	re->padding = eb->exec[i].pad_to_size;
+	re->offset = user->offset;
+}
+
+static struct i915_vma *
+eb_lookup_validate_vma(struct i915_execbuffer *eb, unsigned int i)
+{
+	struct drm_i915_gem_exec_object2 *entry = &eb->exec[i];
+	struct drm_i915_gem_exec_object2 user;
+	struct i915_vma *vma;
+	int err;
+
+	vma = eb_lookup_resident(eb, entry, i);
+	if (likely(vma))
+		return vma;
+
+	user = *entry;
+	vma = eb_lookup_vma(eb, entry->handle);
+	if (IS_ERR(vma))
+		return vma;
+
+	err = eb_validate_vma(eb, entry, vma);
+	if (unlikely(err)) {
+		i915_vma_put(vma);
+		return ERR_PTR(err);
+	}
+
+	eb_resident_record(eb, &user, i, vma);
+	return vma;
+}
+
 static int eb_lookup_vmas(struct i915_execbuffer *eb)
 {
 	unsigned int i, current_batch = 0;
@@ -947,21 +1085,19 @@ static int eb_lookup_vmas(struct i915_execbuffer *eb)
 
 	INIT_LIST_HEAD(&eb->relocs);
 
+	err = eb_resident_set_init(eb);
+	if (err)
+		return err;
+
 	for (i = 0; i < eb->buffer_count; i++) {
 		struct i915_vma *vma;
 
-		vma = eb_lookup_vma(eb, eb->exec[i].handle);
+		vma = eb_lookup_validate_vma(eb, i);
 		if (IS_ERR(vma)) {
 			err = PTR_ERR(vma);
 			goto err;
 		}
 
-		err = eb_validate_vma(eb, &eb->exec[i], vma);
-		if (unlikely(err)) {
-			i915_vma_put(vma);
-			goto err;
-		}
-
 		err = eb_add_vma(eb, &current_batch, i, vma);
 		if (err)
 			return err;
@@ -1106,6 +1242,9 @@ static void eb_release_vmas(struct i915_execbuffer *eb, bool final)
 
 static void eb_destroy(const struct i915_execbuffer *eb)
 {
+	i915_gem_resident_set_put(eb->resident_update);
+	i915_gem_resident_set_put(eb->resident);
+
 	if (eb->lut_size > 0)
 		kfree(eb->buckets);
 }
@@ -2313,8 +2452,8 @@ static int eb_parse(struct i915_execbuffer *eb)
 		return -EINVAL;
 
 	if (!pool) {
-		pool = intel_gt_get_buffer_pool(eb->gt, len,
-						I915_MAP_WB);
+		pool = intel_engine_get_buffer_pool(eb->context->engine, len,
+						    I915_MAP_WB);
 		if (IS_ERR(pool))
 			return PTR_ERR(pool);
 		eb->batch_pool = pool;
@@ -3146,8 +3285,30 @@ static int eb_requests_add(struct i915_execbuffer *eb, int err)
 	return err;
 }
 
+static int
+parse_resident_set(struct i915_user_extension __user *ext, void *data)
+{
+	struct i915_execbuffer *eb = data;
+	struct drm_i915_gem_execbuffer_ext_resident_set resident_set;
+
+	if (copy_from_user(&resident_set, ext, sizeof(resident_set)))
+		return -EFAULT;
+
+	if (resident_set.flags & __I915_EXEC_RESIDENT_SET_UNKNOWN_FLAGS ||
+	    resident_set.rsvd)
+		return -EINVAL;
+
+	if (eb->use_resident)
+		return -EINVAL;
+
+	eb->use_resident = true;
+	eb->resident_flags = resident_set.flags;
+	return 0;
+}
+
 static const i915_user_extension_fn execbuf_extensions[] = {
 	[DRM_I915_GEM_EXECBUFFER_EXT_TIMELINE_FENCES] = parse_timeline_fences,
+	[DRM_I915_GEM_EXECBUFFER_EXT_RESIDENT_SET] = parse_resident_set,
 };
 
 static int
@@ -3389,6 +3550,11 @@ i915_gem_do_execbuffer(struct drm_device *dev,
 	eb.fences = NULL;
 	eb.num_fences = 0;
 
+	eb.use_resident = false;
+	eb.resident_flags = 0;
+	eb.resident = NULL;
+	eb.resident_update = NULL;
+
 	eb_capture_list_clear(&eb);
 
 	memset(eb.requests, 0, sizeof(struct i915_request *) *
@@ -3525,6 +3691,12 @@ i915_gem_do_execbuffer(struct drm_device *dev,
 
 	eb_requests_put(&eb);
 
+	if (!err && eb.resident_update) {
+		i915_gem_context_set_resident_set(eb.gem_context,
+						  eb.resident_update);
+		eb.resident_update = NULL;
+	}
+
 err_vma:
 	eb_release_vmas(&eb, true);
 	WARN_ON(err == -EDEADLK);
@@ -3645,3 +3817,7 @@ end:;
 	kvfree(exec2_list);
 	return err;
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#include "selftests/i915_gem_execbuffer.c"
+#endif
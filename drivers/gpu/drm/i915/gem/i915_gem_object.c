@@ -283,6 +283,8 @@ static void i915_gem_close_object(struct drm_gem_object *gem, struct drm_file *f
 			GEM_BUG_ON(!atomic_read(&vma->open_count));
 			i915_vma_close(vma);
 		}
+		/* The handle may be reused, so invalidate any resident set */
+		WRITE_ONCE(ctx->lut_gen, ctx->lut_gen + 1);
 		mutex_unlock(&ctx->lut_mutex);
 
 		i915_gem_context_put(lut->ctx);
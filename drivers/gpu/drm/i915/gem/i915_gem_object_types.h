@@ -673,11 +673,17 @@ struct drm_i915_gem_object {
 		struct i915_gem_object_page_iter get_dma_page;
 
 		/**
-		 * Element within i915->mm.shrink_list or i915->mm.purge_list,
-		 * locked by i915->mm.obj_lock.
+		 * Element within i915->mm.lru[lru_nid].shrink_list or
+		 * i915->mm.lru[lru_nid].purge_list, locked by i915->mm.obj_lock.
 		 */
 		struct list_head link;
 
+		/**
+		 * NUMA node of the pages, when the object was added to the
+		 * shrinker lists.
+		 */
+		int lru_nid;
+
 		/**
 		 * Advice: are the backing pages purgeable?
 		 */
@@ -14,6 +14,7 @@
 #include "i915_scatterlist.h"
 #include "i915_gem_lmem.h"
 #include "i915_gem_mman.h"
+#include "i915_vma.h"
 
 void __i915_gem_object_set_pages(struct drm_i915_gem_object *obj,
 				 struct sg_table *pages)
@@ -74,20 +75,13 @@ void __i915_gem_object_set_pages(struct drm_i915_gem_object *obj,
 	}
 
 	if (shrinkable && !i915_gem_object_has_self_managed_shrink_list(obj)) {
-		struct list_head *list;
 		unsigned long flags;
 
 		assert_object_held(obj);
 		spin_lock_irqsave(&i915->mm.obj_lock, flags);
 
-		i915->mm.shrink_count++;
-		i915->mm.shrink_memory += obj->base.size;
-
-		if (obj->mm.madv != I915_MADV_WILLNEED)
-			list = &i915->mm.purge_list;
-		else
-			list = &i915->mm.shrink_list;
-		list_add_tail(&obj->mm.link, list);
+		__i915_gem_object_lru_add(obj,
+					  obj->mm.madv != I915_MADV_WILLNEED);
 
 		atomic_set(&obj->mm.shrink_pin, 0);
 		spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
@@ -205,6 +199,25 @@ static void flush_tlb_invalidate(struct drm_i915_gem_object *obj)
 	}
 }
 
+/**
+ * i915_gem_object_release_cached_views - free the cached view pages
+ * @obj: the object
+ *
+ * Frees the rotated and remapped pages kept around by the object's unbound
+ * GGTT vmas. These are built from obj->mm.pages, so they must go before
+ * the object pages do, and they can be dropped to reclaim memory at any
+ * other time as the next binding simply rebuilds them.
+ */
+void i915_gem_object_release_cached_views(struct drm_i915_gem_object *obj)
+{
+	struct i915_vma *vma;
+
+	spin_lock(&obj->vma.lock);
+	for_each_ggtt_vma(vma, obj)
+		i915_vma_release_cached_pages(vma);
+	spin_unlock(&obj->vma.lock);
+}
+
 struct sg_table *
 __i915_gem_object_unset_pages(struct drm_i915_gem_object *obj)
 {
@@ -216,6 +229,8 @@ __i915_gem_object_unset_pages(struct drm_i915_gem_object *obj)
 	if (IS_ERR_OR_NULL(pages))
 		return pages;
 
+	i915_gem_object_release_cached_views(obj);
+
 	if (i915_gem_object_is_volatile(obj))
 		obj->mm.madv = I915_MADV_WILLNEED;
 
@@ -12,6 +12,7 @@
 
 #include "i915_driver.h"
 #include "i915_drv.h"
+#include "i915_ttm_buddy_manager.h"
 
 #if defined(CONFIG_X86)
 #include <asm/smp.h>
@@ -84,6 +85,18 @@ static int lmem_suspend(struct drm_i915_private *i915, u32 flags)
 	return ret;
 }
 
+void i915_gem_lmem_pool_enable(struct drm_i915_private *i915, bool enable)
+{
+	struct intel_memory_region *mr;
+	int id;
+
+	/* The cleared pool does not survive losing the contents of lmem */
+	for_each_memory_region(mr, i915, id)
+		if (mr->type == INTEL_MEMORY_LOCAL)
+			i915_ttm_buddy_man_enable_pool(mr->region_private,
+						       enable);
+}
+
 static void lmem_recover(struct drm_i915_private *i915)
 {
 	struct intel_memory_region *mr;
@@ -98,6 +111,8 @@ int i915_gem_backup_suspend(struct drm_i915_private *i915)
 {
 	int ret;
 
+	i915_gem_lmem_pool_enable(i915, false);
+
 	/* Opportunistically try to evict unpinned objects */
 	ret = lmem_suspend(i915, I915_TTM_BACKUP_ALLOW_GPU);
 	if (ret)
@@ -130,6 +145,7 @@ int i915_gem_backup_suspend(struct drm_i915_private *i915)
 
 out_recover:
 	lmem_recover(i915);
+	i915_gem_lmem_pool_enable(i915, true);
 
 	return ret;
 }
@@ -137,15 +153,11 @@ int i915_gem_backup_suspend(struct drm_i915_private *i915)
 void i915_gem_suspend_late(struct drm_i915_private *i915)
 {
 	struct drm_i915_gem_object *obj;
-	struct list_head *phases[] = {
-		&i915->mm.shrink_list,
-		&i915->mm.purge_list,
-		NULL
-	}, **phase;
 	struct intel_gt *gt;
 	unsigned long flags;
 	unsigned int i;
 	bool flush = false;
+	int nid;
 
 	/*
 	 * Neither the BIOS, ourselves or any other kernel
@@ -174,11 +186,19 @@ void i915_gem_suspend_late(struct drm_i915_private *i915)
 		intel_gt_suspend_late(gt);
 
 	spin_lock_irqsave(&i915->mm.obj_lock, flags);
-	for (phase = phases; *phase; phase++) {
-		list_for_each_entry(obj, *phase, mm.link) {
-			if (!(obj->cache_coherent & I915_BO_CACHE_COHERENT_FOR_READ))
-				flush |= (obj->read_domains & I915_GEM_DOMAIN_CPU) == 0;
-			__start_cpu_write(obj); /* presume auto-hibernate */
+	for (nid = 0; nid < nr_node_ids; nid++) {
+		struct list_head *phases[] = {
+			&i915->mm.lru[nid].shrink_list,
+			&i915->mm.lru[nid].purge_list,
+			NULL
+		}, **phase;
+
+		for (phase = phases; *phase; phase++) {
+			list_for_each_entry(obj, *phase, mm.link) {
+				if (!(obj->cache_coherent & I915_BO_CACHE_COHERENT_FOR_READ))
+					flush |= (obj->read_domains & I915_GEM_DOMAIN_CPU) == 0;
+				__start_cpu_write(obj); /* presume auto-hibernate */
+			}
 		}
 	}
 	spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
@@ -200,6 +220,7 @@ int i915_gem_freeze_late(struct drm_i915_private *i915)
 {
 	struct drm_i915_gem_object *obj;
 	intel_wakeref_t wakeref;
+	int nid;
 
 	/*
 	 * Called just before we write the hibernation image.
@@ -221,8 +242,10 @@ int i915_gem_freeze_late(struct drm_i915_private *i915)
 	i915_gem_drain_freed_objects(i915);
 
 	wbinvd_on_all_cpus();
-	list_for_each_entry(obj, &i915->mm.shrink_list, mm.link)
-		__start_cpu_write(obj);
+	for (nid = 0; nid < nr_node_ids; nid++) {
+		list_for_each_entry(obj, &i915->mm.lru[nid].shrink_list, mm.link)
+			__start_cpu_write(obj);
+	}
 
 	return 0;
 }
@@ -249,6 +272,7 @@ void i915_gem_resume(struct drm_i915_private *i915)
 	ret = lmem_restore(i915, I915_TTM_BACKUP_ALLOW_GPU);
 	GEM_WARN_ON(ret);
 
+	i915_gem_lmem_pool_enable(i915, true);
 	return;
 
 err_wedged:
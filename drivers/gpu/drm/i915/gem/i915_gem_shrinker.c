@@ -73,59 +73,147 @@ static int try_to_writeback(struct drm_i915_gem_object *obj, unsigned int flags)
 	return 0;
 }
 
-/**
- * i915_gem_shrink - Shrink buffer object caches
- * @ww: i915 gem ww acquire ctx, or NULL
- * @i915: i915 device
- * @target: amount of memory to make available, in pages
- * @nr_scanned: optional output for number of pages scanned (incremental)
- * @shrink: control flags for selecting cache types
- *
- * This function is the main interface to the shrinker. It will try to release
- * up to @target pages of main memory backing storage from buffer objects.
- * Selection of the specific caches can be done with @flags. This is e.g. useful
- * when purgeable objects should be removed from caches preferentially.
- *
- * Note that it's not guaranteed that released amount is actually available as
- * free system memory - the pages might still be in-used to due to other reasons
- * (like cpu mmaps) or the mm core has reused them before we could grab them.
- * Therefore code that needs to explicitly shrink buffer objects caches (e.g. to
- * avoid deadlocks in memory reclaim) must fall back to i915_gem_shrink_all().
- *
- * Also note that any kind of pinning (both per-vma address space pins and
- * backing storage pins at the buffer object level) result in the shrinker code
- * having to skip the object.
- *
- * Returns:
- * The number of pages of backing storage actually released.
- */
-unsigned long
-i915_gem_shrink(struct i915_gem_ww_ctx *ww,
-		struct drm_i915_private *i915,
-		unsigned long target,
-		unsigned long *nr_scanned,
-		unsigned int shrink)
+struct shrink_state {
+	struct i915_gem_ww_ctx *ww;
+	unsigned long target;
+	unsigned long count;
+	unsigned long scanned;
+	unsigned int shrink;
+	bool trylock_vm;
+};
+
+static int shrink_object(struct shrink_state *st,
+			 struct drm_i915_gem_object *obj)
+{
+	int err;
+
+	/* May arrive from get_pages on another bo */
+	if (!st->ww) {
+		if (!i915_gem_object_trylock(obj, NULL))
+			return 0;
+	} else {
+		err = i915_gem_object_lock(obj, st->ww);
+		if (err)
+			return err;
+	}
+
+	/* Even if the pages stay, the unbound views can be rebuilt later */
+	i915_gem_object_release_cached_views(obj);
+
+	if (drop_pages(obj, st->shrink, st->trylock_vm) &&
+	    !__i915_gem_object_put_pages(obj) &&
+	    !try_to_writeback(obj, st->shrink))
+		st->count += obj->base.size >> PAGE_SHIFT;
+
+	if (!st->ww)
+		i915_gem_object_unlock(obj);
+
+	st->scanned += obj->base.size >> PAGE_SHIFT;
+	return 0;
+}
+
+/* Number of objects pulled off the LRU per acquisition of the obj_lock */
+#define SHRINK_BATCH_OBJECTS 16
+
+static int shrink_list(struct drm_i915_private *i915,
+		       struct shrink_state *st,
+		       struct list_head *list)
+{
+	struct list_head still_in_list;
+	unsigned long flags;
+	int err = 0;
+
+	INIT_LIST_HEAD(&still_in_list);
+
+	/*
+	 * We serialize our access to unreferenced objects through
+	 * the use of the struct_mutex. While the objects are not
+	 * yet freed (due to RCU then a workqueue) we still want
+	 * to be able to shrink their pages, so they remain on
+	 * the unbound/bound list until actually freed.
+	 *
+	 * Rather than bouncing the obj_lock for every object, isolate a
+	 * small batch of candidates (enough to meet the target) at a time
+	 * and then process them unlocked. Each object is still locked,
+	 * unbound and written back on its own as objects private to a
+	 * ppGTT share the reservation lock of their vm.
+	 */
+	spin_lock_irqsave(&i915->mm.obj_lock, flags);
+	while (!err && st->count < st->target) {
+		struct drm_i915_gem_object *batch[SHRINK_BATCH_OBJECTS];
+		struct drm_i915_gem_object *obj;
+		unsigned long pending = 0;
+		unsigned int n = 0, i;
+
+		while (n < ARRAY_SIZE(batch) &&
+		       st->count + pending < st->target &&
+		       (obj = list_first_entry_or_null(list,
+						       typeof(*obj),
+						       mm.link))) {
+			list_move_tail(&obj->mm.link, &still_in_list);
+
+			if (st->shrink & I915_SHRINK_VMAPS &&
+			    !is_vmalloc_addr(obj->mm.mapping))
+				continue;
+
+			if (!(st->shrink & I915_SHRINK_ACTIVE) &&
+			    i915_gem_object_is_framebuffer(obj))
+				continue;
+
+			if (!can_release_pages(obj))
+				continue;
+
+			if (!kref_get_unless_zero(&obj->base.refcount))
+				continue;
+
+			batch[n++] = obj;
+			pending += obj->base.size >> PAGE_SHIFT;
+		}
+		if (!n)
+			break;
+
+		spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
+
+		for (i = 0; i < n; i++) {
+			if (!err)
+				err = shrink_object(st, batch[i]);
+			i915_gem_object_put(batch[i]);
+		}
+
+		spin_lock_irqsave(&i915->mm.obj_lock, flags);
+	}
+	list_splice_tail(&still_in_list, list);
+	spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
+
+	return err;
+}
+
+static unsigned long
+__i915_gem_shrink(struct i915_gem_ww_ctx *ww,
+		  struct drm_i915_private *i915,
+		  int nid,
+		  unsigned long target,
+		  unsigned long *nr_scanned,
+		  unsigned int shrink)
 {
 	const struct {
-		struct list_head *list;
+		bool purge;
 		unsigned int bit;
 	} phases[] = {
-		{ &i915->mm.purge_list, ~0u },
-		{
-			&i915->mm.shrink_list,
-			I915_SHRINK_BOUND | I915_SHRINK_UNBOUND
-		},
-		{ NULL, 0 },
+		{ true, ~0u },
+		{ false, I915_SHRINK_BOUND | I915_SHRINK_UNBOUND },
 	}, *phase;
+	struct shrink_state st = {
+		.ww = ww,
+		.target = target,
+		/* CHV + VTD workaround use stop_machine(); need to trylock vm->mutex */
+		.trylock_vm = !ww && intel_vm_no_concurrent_access_wa(i915),
+	};
 	intel_wakeref_t wakeref = 0;
-	unsigned long count = 0;
-	unsigned long scanned = 0;
+	int first, last;
 	int err = 0, i = 0;
 	struct intel_gt *gt;
 
-	/* CHV + VTD workaround use stop_machine(); need to trylock vm->mutex */
-	bool trylock_vm = !ww && intel_vm_no_concurrent_access_wa(i915);
-
 	trace_i915_gem_shrink(i915, target, shrink);
 
 	/*
@@ -138,6 +226,7 @@ i915_gem_shrink(struct i915_gem_ww_ctx *ww,
 		if (!wakeref)
 			shrink &= ~I915_SHRINK_BOUND;
 	}
+	st.shrink = shrink;
 
 	/*
 	 * When shrinking the active list, we should also consider active
@@ -155,6 +244,13 @@ i915_gem_shrink(struct i915_gem_ww_ctx *ww,
 			intel_gt_retire_requests(gt);
 	}
 
+	if (nid == NUMA_NO_NODE) {
+		first = 0;
+		last = nr_node_ids - 1;
+	} else {
+		first = last = nid;
+	}
+
 	/*
 	 * As we may completely rewrite the (un)bound list whilst unbinding
 	 * (due to retiring requests) we have to strictly process only
@@ -174,76 +270,18 @@ i915_gem_shrink(struct i915_gem_ww_ctx *ww,
 	 * dev->struct_mutex and so we won't ever be able to observe an
 	 * object on the bound_list with a reference count equals 0.
 	 */
-	for (phase = phases; phase->list; phase++) {
-		struct list_head still_in_list;
-		struct drm_i915_gem_object *obj;
-		unsigned long flags;
-
+	for (phase = phases; !err && phase < phases + ARRAY_SIZE(phases); phase++) {
 		if ((shrink & phase->bit) == 0)
 			continue;
 
-		INIT_LIST_HEAD(&still_in_list);
+		for (nid = first; !err && nid <= last; nid++) {
+			struct i915_gem_mm_lru *lru = &i915->mm.lru[nid];
 
-		/*
-		 * We serialize our access to unreferenced objects through
-		 * the use of the struct_mutex. While the objects are not
-		 * yet freed (due to RCU then a workqueue) we still want
-		 * to be able to shrink their pages, so they remain on
-		 * the unbound/bound list until actually freed.
-		 */
-		spin_lock_irqsave(&i915->mm.obj_lock, flags);
-		while (count < target &&
-		       (obj = list_first_entry_or_null(phase->list,
-						       typeof(*obj),
-						       mm.link))) {
-			list_move_tail(&obj->mm.link, &still_in_list);
-
-			if (shrink & I915_SHRINK_VMAPS &&
-			    !is_vmalloc_addr(obj->mm.mapping))
-				continue;
-
-			if (!(shrink & I915_SHRINK_ACTIVE) &&
-			    i915_gem_object_is_framebuffer(obj))
-				continue;
-
-			if (!can_release_pages(obj))
-				continue;
-
-			if (!kref_get_unless_zero(&obj->base.refcount))
-				continue;
-
-			spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
-
-			/* May arrive from get_pages on another bo */
-			if (!ww) {
-				if (!i915_gem_object_trylock(obj, NULL))
-					goto skip;
-			} else {
-				err = i915_gem_object_lock(obj, ww);
-				if (err)
-					goto skip;
-			}
-
-			if (drop_pages(obj, shrink, trylock_vm) &&
-			    !__i915_gem_object_put_pages(obj) &&
-			    !try_to_writeback(obj, shrink))
-				count += obj->base.size >> PAGE_SHIFT;
-
-			if (!ww)
-				i915_gem_object_unlock(obj);
-
-			scanned += obj->base.size >> PAGE_SHIFT;
-skip:
-			i915_gem_object_put(obj);
-
-			spin_lock_irqsave(&i915->mm.obj_lock, flags);
-			if (err)
-				break;
+			err = shrink_list(i915, &st,
+					  phase->purge ?
+					  &lru->purge_list :
+					  &lru->shrink_list);
 		}
-		list_splice_tail(&still_in_list, phase->list);
-		spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
-		if (err)
-			break;
 	}
 
 	if (shrink & I915_SHRINK_BOUND)
@@ -253,8 +291,45 @@ i915_gem_shrink(struct i915_gem_ww_ctx *ww,
 		return err;
 
 	if (nr_scanned)
-		*nr_scanned += scanned;
-	return count;
+		*nr_scanned += st.scanned;
+	return st.count;
+}
+
+/**
+ * i915_gem_shrink - Shrink buffer object caches
+ * @ww: i915 gem ww acquire ctx, or NULL
+ * @i915: i915 device
+ * @target: amount of memory to make available, in pages
+ * @nr_scanned: optional output for number of pages scanned (incremental)
+ * @shrink: control flags for selecting cache types
+ *
+ * This function is the main interface to the shrinker. It will try to release
+ * up to @target pages of main memory backing storage from buffer objects.
+ * Selection of the specific caches can be done with @flags. This is e.g. useful
+ * when purgeable objects should be removed from caches preferentially.
+ *
+ * Note that it's not guaranteed that released amount is actually available as
+ * free system memory - the pages might still be in-used to due to other reasons
+ * (like cpu mmaps) or the mm core has reused them before we could grab them.
+ * Therefore code that needs to explicitly shrink buffer objects caches (e.g. to
+ * avoid deadlocks in memory reclaim) must fall back to i915_gem_shrink_all().
+ *
+ * Also note that any kind of pinning (both per-vma address space pins and
+ * backing storage pins at the buffer object level) result in the shrinker code
+ * having to skip the object.
+ *
+ * Returns:
+ * The number of pages of backing storage actually released.
+ */
+unsigned long
+i915_gem_shrink(struct i915_gem_ww_ctx *ww,
+		struct drm_i915_private *i915,
+		unsigned long target,
+		unsigned long *nr_scanned,
+		unsigned int shrink)
+{
+	return __i915_gem_shrink(ww, i915, NUMA_NO_NODE,
+				 target, nr_scanned, shrink);
 }
 
 /**
@@ -310,7 +385,8 @@ i915_gem_shrinker_count(struct shrinker *shrinker, struct shrink_control *sc)
 			    128ul /* default SHRINK_BATCH */);
 	}
 
-	return count;
+	/* Only report what reclaim on this node can free */
+	return READ_ONCE(i915->mm.lru[sc->nid].shrink_memory) >> PAGE_SHIFT;
 }
 
 static unsigned long
@@ -321,22 +397,22 @@ i915_gem_shrinker_scan(struct shrinker *shrinker, struct shrink_control *sc)
 
 	sc->nr_scanned = 0;
 
-	freed = i915_gem_shrink(NULL, i915,
-				sc->nr_to_scan,
-				&sc->nr_scanned,
-				I915_SHRINK_BOUND |
-				I915_SHRINK_UNBOUND);
+	freed = __i915_gem_shrink(NULL, i915, sc->nid,
+				  sc->nr_to_scan,
+				  &sc->nr_scanned,
+				  I915_SHRINK_BOUND |
+				  I915_SHRINK_UNBOUND);
 	if (sc->nr_scanned < sc->nr_to_scan && current_is_kswapd()) {
 		intel_wakeref_t wakeref;
 
 		with_intel_runtime_pm(&i915->runtime_pm, wakeref) {
-			freed += i915_gem_shrink(NULL, i915,
-						 sc->nr_to_scan - sc->nr_scanned,
-						 &sc->nr_scanned,
-						 I915_SHRINK_ACTIVE |
-						 I915_SHRINK_BOUND |
-						 I915_SHRINK_UNBOUND |
-						 I915_SHRINK_WRITEBACK);
+			freed += __i915_gem_shrink(NULL, i915, sc->nid,
+						   sc->nr_to_scan - sc->nr_scanned,
+						   &sc->nr_scanned,
+						   I915_SHRINK_ACTIVE |
+						   I915_SHRINK_BOUND |
+						   I915_SHRINK_UNBOUND |
+						   I915_SHRINK_WRITEBACK);
 		}
 	}
 
@@ -352,6 +428,7 @@ i915_gem_shrinker_oom(struct notifier_block *nb, unsigned long event, void *ptr)
 	unsigned long unevictable, available, freed_pages;
 	intel_wakeref_t wakeref;
 	unsigned long flags;
+	int nid;
 
 	freed_pages = 0;
 	with_intel_runtime_pm(&i915->runtime_pm, wakeref)
@@ -366,11 +443,13 @@ i915_gem_shrinker_oom(struct notifier_block *nb, unsigned long event, void *ptr)
 	 */
 	available = unevictable = 0;
 	spin_lock_irqsave(&i915->mm.obj_lock, flags);
-	list_for_each_entry(obj, &i915->mm.shrink_list, mm.link) {
-		if (!can_release_pages(obj))
-			unevictable += obj->base.size >> PAGE_SHIFT;
-		else
-			available += obj->base.size >> PAGE_SHIFT;
+	for (nid = 0; nid < nr_node_ids; nid++) {
+		list_for_each_entry(obj, &i915->mm.lru[nid].shrink_list, mm.link) {
+			if (!can_release_pages(obj))
+				unevictable += obj->base.size >> PAGE_SHIFT;
+			else
+				available += obj->base.size >> PAGE_SHIFT;
+		}
 	}
 	spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
 
@@ -428,7 +507,7 @@ i915_gem_shrinker_vmap(struct notifier_block *nb, unsigned long event, void *ptr
 
 void i915_gem_driver_register__shrinker(struct drm_i915_private *i915)
 {
-	i915->mm.shrinker = shrinker_alloc(0, "drm-i915_gem");
+	i915->mm.shrinker = shrinker_alloc(SHRINKER_NUMA_AWARE, "drm-i915_gem");
 	if (!i915->mm.shrinker) {
 		drm_WARN_ON(&i915->drm, 1);
 	} else {
@@ -471,6 +550,86 @@ void i915_gem_shrinker_taints_mutex(struct drm_i915_private *i915,
 	fs_reclaim_release(GFP_KERNEL);
 }
 
+static int obj_lru_nid(const struct drm_i915_gem_object *obj)
+{
+	struct sg_table *pages = obj->mm.pages;
+
+	if (nr_node_ids == 1)
+		return 0;
+
+	/* Objects are rarely spread over nodes, so the first page is good enough */
+	if (!IS_ERR_OR_NULL(pages) && sg_page(pages->sgl))
+		return page_to_nid(sg_page(pages->sgl));
+
+	return numa_mem_id();
+}
+
+static struct list_head *
+obj_lru_list(struct drm_i915_gem_object *obj, bool purgeable)
+{
+	struct i915_gem_mm_lru *lru = &obj_to_i915(obj)->mm.lru[obj->mm.lru_nid];
+
+	return purgeable ? &lru->purge_list : &lru->shrink_list;
+}
+
+/**
+ * __i915_gem_object_lru_add - Add the object to the shrinker lists
+ * @obj: The GEM object.
+ * @purgeable: Whether to add the object to the purgeable list, which
+ * is reclaimed first, rather than to the shrinkable list.
+ *
+ * The object is placed on the lists of the NUMA node backing its pages.
+ * Must be called with i915->mm.obj_lock held.
+ */
+void __i915_gem_object_lru_add(struct drm_i915_gem_object *obj,
+			       bool purgeable)
+{
+	struct drm_i915_private *i915 = obj_to_i915(obj);
+
+	lockdep_assert_held(&i915->mm.obj_lock);
+
+	obj->mm.lru_nid = obj_lru_nid(obj);
+	list_add_tail(&obj->mm.link, obj_lru_list(obj, purgeable));
+
+	i915->mm.lru[obj->mm.lru_nid].shrink_memory += obj->base.size;
+	i915->mm.shrink_count++;
+	i915->mm.shrink_memory += obj->base.size;
+}
+
+/**
+ * __i915_gem_object_lru_move - Move the object to the tail of the shrinker
+ * lists of its node
+ * @obj: The GEM object.
+ * @purgeable: Whether the object should now be on the purgeable list.
+ *
+ * Must be called with i915->mm.obj_lock held.
+ */
+void __i915_gem_object_lru_move(struct drm_i915_gem_object *obj,
+				bool purgeable)
+{
+	lockdep_assert_held(&obj_to_i915(obj)->mm.obj_lock);
+	list_move_tail(&obj->mm.link, obj_lru_list(obj, purgeable));
+}
+
+/**
+ * __i915_gem_object_lru_del - Remove the object from the shrinker lists
+ * @obj: The GEM object.
+ *
+ * Must be called with i915->mm.obj_lock held.
+ */
+void __i915_gem_object_lru_del(struct drm_i915_gem_object *obj)
+{
+	struct drm_i915_private *i915 = obj_to_i915(obj);
+
+	lockdep_assert_held(&i915->mm.obj_lock);
+
+	list_del_init(&obj->mm.link);
+
+	i915->mm.lru[obj->mm.lru_nid].shrink_memory -= obj->base.size;
+	i915->mm.shrink_count--;
+	i915->mm.shrink_memory -= obj->base.size;
+}
+
 /**
  * i915_gem_object_make_unshrinkable - Hide the object from the shrinker. By
  * default all object types that support shrinking(see IS_SHRINKABLE), will also
@@ -497,16 +656,13 @@ void i915_gem_object_make_unshrinkable(struct drm_i915_gem_object *obj)
 
 	spin_lock_irqsave(&i915->mm.obj_lock, flags);
 	if (!atomic_fetch_inc(&obj->mm.shrink_pin) &&
-	    !list_empty(&obj->mm.link)) {
-		list_del_init(&obj->mm.link);
-		i915->mm.shrink_count--;
-		i915->mm.shrink_memory -= obj->base.size;
-	}
+	    !list_empty(&obj->mm.link))
+		__i915_gem_object_lru_del(obj);
 	spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
 }
 
 static void ___i915_gem_object_make_shrinkable(struct drm_i915_gem_object *obj,
-					       struct list_head *head)
+					       bool purgeable)
 {
 	struct drm_i915_private *i915 = obj_to_i915(obj);
 	unsigned long flags;
@@ -522,10 +678,7 @@ static void ___i915_gem_object_make_shrinkable(struct drm_i915_gem_object *obj,
 	if (atomic_dec_and_test(&obj->mm.shrink_pin)) {
 		GEM_BUG_ON(!list_empty(&obj->mm.link));
 
-		list_add_tail(&obj->mm.link, head);
-		i915->mm.shrink_count++;
-		i915->mm.shrink_memory += obj->base.size;
-
+		__i915_gem_object_lru_add(obj, purgeable);
 	}
 	spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
 }
@@ -542,8 +695,7 @@ static void ___i915_gem_object_make_shrinkable(struct drm_i915_gem_object *obj,
  */
 void __i915_gem_object_make_shrinkable(struct drm_i915_gem_object *obj)
 {
-	___i915_gem_object_make_shrinkable(obj,
-					   &obj_to_i915(obj)->mm.shrink_list);
+	___i915_gem_object_make_shrinkable(obj, false);
 }
 
 /**
@@ -558,8 +710,7 @@ void __i915_gem_object_make_shrinkable(struct drm_i915_gem_object *obj)
  */
 void __i915_gem_object_make_purgeable(struct drm_i915_gem_object *obj)
 {
-	___i915_gem_object_make_shrinkable(obj,
-					   &obj_to_i915(obj)->mm.purge_list);
+	___i915_gem_object_make_shrinkable(obj, true);
 }
 
 /**
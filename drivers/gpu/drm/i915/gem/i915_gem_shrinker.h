@@ -8,6 +8,7 @@
 
 #include <linux/bits.h>
 
+struct drm_i915_gem_object;
 struct drm_i915_private;
 struct i915_gem_ww_ctx;
 struct mutex;
@@ -30,4 +31,10 @@ void i915_gem_driver_unregister__shrinker(struct drm_i915_private *i915);
 void i915_gem_shrinker_taints_mutex(struct drm_i915_private *i915,
 				    struct mutex *mutex);
 
+void __i915_gem_object_lru_add(struct drm_i915_gem_object *obj,
+			       bool purgeable);
+void __i915_gem_object_lru_move(struct drm_i915_gem_object *obj,
+				bool purgeable);
+void __i915_gem_object_lru_del(struct drm_i915_gem_object *obj);
+
 #endif /* __I915_GEM_SHRINKER_H__ */
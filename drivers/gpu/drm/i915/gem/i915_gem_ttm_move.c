@@ -3,10 +3,13 @@
  * Copyright © 2021 Intel Corporation
  */
 
+#include <drm/drm_buddy.h>
+#include <drm/drm_cache.h>
 #include <drm/ttm/ttm_tt.h>
 
 #include "i915_deps.h"
 #include "i915_drv.h"
+#include "i915_ttm_buddy_manager.h"
 #include "intel_memory_region.h"
 #include "intel_region_ttm.h"
 
@@ -29,11 +32,15 @@
  * For fail_work_allocation we fail the kmalloc of the async worker, we
  * sync the gpu blit. If it then fails, or fail_gpu_migration is set to
  * true, then a memcpy operation is performed sync.
+ *
+ * memcpy_workers, if non-zero, limits the number of workers the memcpy
+ * fallback is sliced across.
  */
 #if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
 static bool fail_gpu_migration;
 static bool fail_work_allocation;
 static bool ban_memcpy;
+static unsigned int memcpy_workers;
 
 void i915_ttm_migrate_set_failure_modes(bool gpu_migration,
 					bool work_allocation)
@@ -46,6 +53,11 @@ void i915_ttm_migrate_set_ban_memcpy(bool ban)
 {
 	ban_memcpy = ban;
 }
+
+void i915_ttm_migrate_set_memcpy_workers(unsigned int count)
+{
+	memcpy_workers = count;
+}
 #endif
 
 static enum i915_cache_level
@@ -213,7 +225,7 @@ static struct dma_fence *i915_ttm_accel_move(struct ttm_buffer_object *bo,
 			return ERR_PTR(-EINVAL);
 
 		intel_engine_pm_get(to_gt(i915)->migrate.context->engine);
-		ret = intel_context_migrate_clear(to_gt(i915)->migrate.context, deps,
+		ret = intel_migrate_striped_clear(&to_gt(i915)->migrate, deps,
 						  dst_st->sgl,
 						  i915_gem_get_pat_index(i915, dst_level),
 						  i915_ttm_gtt_binds_lmem(dst_mem),
@@ -227,7 +239,7 @@ static struct dma_fence *i915_ttm_accel_move(struct ttm_buffer_object *bo,
 
 		src_level = i915_ttm_cache_level(i915, bo->resource, src_ttm);
 		intel_engine_pm_get(to_gt(i915)->migrate.context->engine);
-		ret = intel_context_migrate_copy(to_gt(i915)->migrate.context,
+		ret = intel_migrate_striped_copy(&to_gt(i915)->migrate,
 						 deps, src_rsgt->table.sgl,
 						 i915_gem_get_pat_index(i915, src_level),
 						 i915_ttm_gtt_binds_lmem(bo->resource),
@@ -249,6 +261,73 @@ static struct dma_fence *i915_ttm_accel_move(struct ttm_buffer_object *bo,
 	return ret ? ERR_PTR(ret) : &rq->fence;
 }
 
+/**
+ * i915_ttm_clear_blocks - Clear a list of free lmem blocks using the blitter
+ * @data: The struct intel_memory_region owning the blocks
+ * @mm: The buddy allocator the blocks belong to
+ * @blocks: The list of blocks to clear
+ *
+ * Used by the buddy manager to refill its pool of cleared blocks in the
+ * background, see i915_ttm_buddy_man_init_pool(). We only clear when the
+ * migration engine is otherwise idle, so as not to delay real moves.
+ *
+ * Return: 0 once the blocks are cleared, -EBUSY if the migration engine is
+ * busy, or a negative error code on failure.
+ */
+int i915_ttm_clear_blocks(void *data, struct drm_buddy *mm,
+			  struct list_head *blocks)
+{
+	struct intel_memory_region *mr = data;
+	struct drm_i915_private *i915 = mr->i915;
+	struct intel_context *ce = to_gt(i915)->migrate.context;
+	struct drm_buddy_block *block;
+	struct i915_request *rq;
+	struct scatterlist *sg;
+	struct sg_table st;
+	unsigned int count;
+	int err;
+
+	if (!ce || intel_gt_is_wedged(to_gt(i915)))
+		return -ENODEV;
+
+	if (!intel_engine_is_idle(ce->engine))
+		return -EBUSY;
+
+	count = list_count_nodes(blocks);
+	err = sg_alloc_table(&st, count, GFP_KERNEL);
+	if (err)
+		return err;
+
+	sg = st.sgl;
+	list_for_each_entry(block, blocks, link) {
+		u64 size = drm_buddy_block_size(mm, block);
+
+		GEM_BUG_ON(overflows_type(size, sg_dma_len(sg)));
+		sg_dma_address(sg) = mr->region.start +
+			drm_buddy_block_offset(block);
+		sg_dma_len(sg) = size;
+		sg->length = size;
+		sg = sg_next(sg);
+	}
+
+	intel_engine_pm_get(ce->engine);
+	err = intel_context_migrate_clear(ce, NULL, st.sgl,
+					  i915_gem_get_pat_index(i915,
+								 I915_CACHE_NONE),
+					  true, 0, &rq);
+	intel_engine_pm_put(ce->engine);
+	if (rq) {
+		if (i915_request_wait(rq, 0, MAX_SCHEDULE_TIMEOUT) < 0 && !err)
+			err = -EIO;
+		if (!err)
+			err = rq->fence.error;
+		i915_request_put(rq);
+	}
+
+	sg_free_table(&st);
+	return err;
+}
+
 /**
  * struct i915_ttm_memcpy_arg - argument for the bo memcpy functionality.
  * @_dst_iter: Storage space for the destination kmap iterator.
@@ -302,10 +381,118 @@ struct i915_ttm_memcpy_work {
 	bool memcpy_allowed;
 };
 
+/*
+ * Large CPU copies are split into page aligned slices of at least this
+ * many pages, each handled by one of a bounded number of workers.
+ */
+#define I915_TTM_MEMCPY_SLICE_PAGES (SZ_8M >> PAGE_SHIFT)
+#define I915_TTM_MEMCPY_MAX_WORKERS 8
+
+/**
+ * struct i915_ttm_memcpy_slice - A slice of the memcpy handed to a worker.
+ * @work: The work struct used to run the slice.
+ * @arg: A copy of the memcpy argument, with private kmap iterators.
+ * @start: The first page of the slice.
+ * @end: The page after the last page of the slice.
+ */
+struct i915_ttm_memcpy_slice {
+	struct work_struct work;
+	struct i915_ttm_memcpy_arg arg;
+	pgoff_t start;
+	pgoff_t end;
+};
+
+static void i915_ttm_memcpy_range(struct i915_ttm_memcpy_arg *arg,
+				  pgoff_t start, pgoff_t end)
+{
+	const struct ttm_kmap_iter_ops *dst_ops = arg->dst_iter->ops;
+	const struct ttm_kmap_iter_ops *src_ops = arg->src_iter->ops;
+	struct iosys_map src_map, dst_map;
+	pgoff_t i;
+
+	/* As ttm_move_memcpy(), but for just the pages in [start, end) */
+	for (i = start; i < end; i++) {
+		dst_ops->map_local(arg->dst_iter, &dst_map, i);
+		if (arg->clear) {
+			iosys_map_memset(&dst_map, 0, 0, PAGE_SIZE);
+		} else {
+			src_ops->map_local(arg->src_iter, &src_map, i);
+			drm_memcpy_from_wc(&dst_map, &src_map, PAGE_SIZE);
+			if (src_ops->unmap_local)
+				src_ops->unmap_local(arg->src_iter, &src_map);
+		}
+		if (dst_ops->unmap_local)
+			dst_ops->unmap_local(arg->dst_iter, &dst_map);
+	}
+}
+
+static void __memcpy_slice_work(struct work_struct *work)
+{
+	struct i915_ttm_memcpy_slice *slice =
+		container_of(work, typeof(*slice), work);
+
+	i915_ttm_memcpy_range(&slice->arg, slice->start, slice->end);
+}
+
+static void i915_ttm_memcpy_clone(struct i915_ttm_memcpy_arg *dst,
+				  const struct i915_ttm_memcpy_arg *src)
+{
+	/*
+	 * The iomap iterator caches its position within the sg_table, so
+	 * each worker needs its own copy, pointing at its own storage. The
+	 * sg_table references remain owned by the original argument.
+	 */
+	*dst = *src;
+	dst->dst_iter = (void *)dst + ((void *)src->dst_iter - (void *)src);
+	dst->src_iter = (void *)dst + ((void *)src->src_iter - (void *)src);
+}
+
 static void i915_ttm_move_memcpy(struct i915_ttm_memcpy_arg *arg)
 {
-	ttm_move_memcpy(arg->clear, arg->num_pages,
-			arg->dst_iter, arg->src_iter);
+	struct i915_ttm_memcpy_slice *slices = NULL;
+	unsigned int count, i;
+	pgoff_t per;
+
+	/* Single TTM move. NOP */
+	if (arg->dst_iter->ops->maps_tt && arg->src_iter->ops->maps_tt)
+		return;
+
+	count = min_t(unsigned long, num_online_cpus(),
+		      DIV_ROUND_UP(arg->num_pages,
+				   I915_TTM_MEMCPY_SLICE_PAGES));
+	count = min_t(unsigned int, count, I915_TTM_MEMCPY_MAX_WORKERS);
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+	if (memcpy_workers)
+		count = min(count, memcpy_workers);
+#endif
+
+	/* We may be inside the fence signalling critical section */
+	if (count > 1)
+		slices = kcalloc(count - 1, sizeof(*slices),
+				 GFP_NOWAIT | __GFP_NOWARN);
+	if (!slices) {
+		i915_ttm_memcpy_range(arg, 0, arg->num_pages);
+		return;
+	}
+
+	per = DIV_ROUND_UP(arg->num_pages, count);
+	for (i = 0; i < count - 1; i++) {
+		struct i915_ttm_memcpy_slice *slice = &slices[i];
+
+		i915_ttm_memcpy_clone(&slice->arg, arg);
+		slice->start = min_t(pgoff_t, (i + 1) * per, arg->num_pages);
+		slice->end = min_t(pgoff_t, slice->start + per, arg->num_pages);
+
+		INIT_WORK(&slice->work, __memcpy_slice_work);
+		queue_work(system_unbound_wq, &slice->work);
+	}
+
+	/* The first slice is ours, using the original iterators */
+	i915_ttm_memcpy_range(arg, 0, min_t(pgoff_t, per, arg->num_pages));
+
+	for (i = 0; i < count - 1; i++)
+		flush_work(&slices[i].work);
+	kfree(slices);
 }
 
 static void i915_ttm_memcpy_init(struct i915_ttm_memcpy_arg *arg,
@@ -578,7 +765,7 @@ int i915_ttm_move(struct ttm_buffer_object *bo, bool evict,
 	struct dma_fence *migration_fence = NULL;
 	struct ttm_tt *ttm = bo->ttm;
 	struct i915_refct_sgt *dst_rsgt;
-	bool clear, prealloc_bo;
+	bool clear, prealloc_bo, skip_clear;
 	int ret;
 
 	if (GEM_WARN_ON(i915_ttm_is_ghost_object(bo))) {
@@ -635,7 +822,11 @@ int i915_ttm_move(struct ttm_buffer_object *bo, bool evict,
 
 	clear = !i915_ttm_cpu_maps_iomem(bo->resource) && (!ttm || !ttm_tt_is_populated(ttm));
 	prealloc_bo = obj->flags & I915_BO_PREALLOC;
-	if (!(clear && ttm && !((ttm->page_flags & TTM_TT_FLAG_ZERO_ALLOC) && !prealloc_bo))) {
+	/* Memory from the pool of already cleared blocks needs no clear */
+	skip_clear = clear &&
+		((ttm && !((ttm->page_flags & TTM_TT_FLAG_ZERO_ALLOC) && !prealloc_bo)) ||
+		 i915_ttm_buddy_man_cleared(dst_man, dst_mem));
+	if (!skip_clear) {
 		struct i915_deps deps;
 
 		i915_deps_init(&deps, GFP_KERNEL | __GFP_NORETRY | __GFP_NOWARN);
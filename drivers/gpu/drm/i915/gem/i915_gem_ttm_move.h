@@ -15,14 +15,17 @@ struct ttm_place;
 struct ttm_resource;
 struct ttm_tt;
 
+struct drm_buddy;
 struct drm_i915_gem_object;
 struct i915_refct_sgt;
+struct list_head;
 
 int i915_ttm_move_notify(struct ttm_buffer_object *bo);
 
 I915_SELFTEST_DECLARE(void i915_ttm_migrate_set_failure_modes(bool gpu_migration,
 							      bool work_allocation));
 I915_SELFTEST_DECLARE(void i915_ttm_migrate_set_ban_memcpy(bool ban));
+I915_SELFTEST_DECLARE(void i915_ttm_migrate_set_memcpy_workers(unsigned int count));
 
 int i915_gem_obj_copy_ttm(struct drm_i915_gem_object *dst,
 			  struct drm_i915_gem_object *src,
@@ -35,6 +38,9 @@ int i915_ttm_move(struct ttm_buffer_object *bo, bool evict,
 		  struct ttm_resource *dst_mem,
 		  struct ttm_place *hop);
 
+int i915_ttm_clear_blocks(void *data, struct drm_buddy *mm,
+			  struct list_head *blocks);
+
 void i915_ttm_adjust_domains_after_move(struct drm_i915_gem_object *obj);
 
 void i915_ttm_adjust_gem_after_move(struct drm_i915_gem_object *obj);
@@ -96,12 +96,92 @@ static void i915_gem_object_userptr_drop_ref(struct drm_i915_gem_object *obj)
 	}
 }
 
+/*
+ * Count how many of the pinned pages, starting at pvec[i], are consecutive
+ * pages of the same folio. A THP or hugetlb backed range then only costs
+ * us a single step per folio when building the scatterlist.
+ */
+static unsigned int userptr_folio_run(struct page **pvec,
+				      unsigned int i, unsigned int count)
+{
+	struct folio *folio = page_folio(pvec[i]);
+	unsigned long idx = folio_page_idx(folio, pvec[i]);
+	unsigned int run, n;
+
+	run = min_t(unsigned long, folio_nr_pages(folio) - idx, count - i);
+	for (n = 1; n < run; n++) {
+		if (pvec[i + n] != folio_page(folio, idx + n))
+			break;
+	}
+
+	return n;
+}
+
+/*
+ * Walk the pinned pages a folio at a time, merging physically contiguous
+ * runs up to max_segment, and return the number of segments needed. If @sg
+ * is provided, also fill in the segments.
+ */
+static unsigned int userptr_sg_segments(struct page **pvec,
+					unsigned int num_pages,
+					unsigned int max_segment,
+					struct scatterlist *sg)
+{
+	const unsigned int max_pages = max_segment >> PAGE_SHIFT;
+	unsigned long next_pfn = 0;
+	unsigned int nents = 0, len = 0;
+	unsigned int i, n;
+
+	for (i = 0; i < num_pages; i += n) {
+		unsigned long pfn = page_to_pfn(pvec[i]);
+
+		n = min(userptr_folio_run(pvec, i, num_pages), max_pages);
+		if (nents &&
+		    pfn == next_pfn &&
+		    len + (n << PAGE_SHIFT) <= max_segment) {
+			len += n << PAGE_SHIFT;
+			if (sg)
+				sg->length = len;
+		} else {
+			if (sg && nents)
+				sg = sg_next(sg);
+
+			nents++;
+			len = n << PAGE_SHIFT;
+			if (sg)
+				sg_set_page(sg, pvec[i], len, 0);
+		}
+		next_pfn = pfn + n;
+	}
+
+	return nents;
+}
+
+static int userptr_sg_alloc_table(struct sg_table *st, struct page **pvec,
+				  unsigned int num_pages,
+				  unsigned int max_segment)
+{
+	unsigned int nents;
+	int ret;
+
+	/* Size the table to the segments, not to the pages */
+	nents = userptr_sg_segments(pvec, num_pages, max_segment, NULL);
+
+	ret = sg_alloc_table(st, nents, GFP_KERNEL);
+	if (ret)
+		return ret;
+
+	userptr_sg_segments(pvec, num_pages, max_segment, st->sgl);
+
+	return 0;
+}
+
 static int i915_gem_userptr_get_pages(struct drm_i915_gem_object *obj)
 {
 	unsigned int max_segment = i915_sg_segment_size(obj->base.dev->dev);
 	struct sg_table *st;
 	struct page **pvec;
-	unsigned int num_pages; /* limited by sg_alloc_table_from_pages_segment */
+	unsigned int num_pages; /* limited by sg_alloc_table */
 	int ret;
 
 	if (overflows_type(obj->base.size >> PAGE_SHIFT, num_pages))
@@ -121,9 +201,7 @@ static int i915_gem_userptr_get_pages(struct drm_i915_gem_object *obj)
 	pvec = obj->userptr.pvec;
 
 alloc_table:
-	ret = sg_alloc_table_from_pages_segment(st, pvec, num_pages, 0,
-						num_pages << PAGE_SHIFT,
-						max_segment, GFP_KERNEL);
+	ret = userptr_sg_alloc_table(st, pvec, num_pages, max_segment);
 	if (ret)
 		goto err;
 
@@ -158,8 +236,7 @@ static void
 i915_gem_userptr_put_pages(struct drm_i915_gem_object *obj,
 			   struct sg_table *pages)
 {
-	struct sgt_iter sgt_iter;
-	struct page *page;
+	struct scatterlist *sg;
 
 	if (!pages)
 		return;
@@ -175,31 +252,48 @@ i915_gem_userptr_put_pages(struct drm_i915_gem_object *obj,
 	if (i915_gem_object_is_readonly(obj))
 		obj->mm.dirty = false;
 
-	for_each_sgt_page(page, sgt_iter, pages) {
-		if (obj->mm.dirty && trylock_page(page)) {
-			/*
-			 * As this may not be anonymous memory (e.g. shmem)
-			 * but exist on a real mapping, we have to lock
-			 * the page in order to dirty it -- holding
-			 * the page reference is not sufficient to
-			 * prevent the inode from being truncated.
-			 * Play safe and take the lock.
-			 *
-			 * However...!
-			 *
-			 * The mmu-notifier can be invalidated for a
-			 * migrate_folio, that is alreadying holding the lock
-			 * on the folio. Such a try_to_unmap() will result
-			 * in us calling put_pages() and so recursively try
-			 * to lock the page. We avoid that deadlock with
-			 * a trylock_page() and in exchange we risk missing
-			 * some page dirtying.
-			 */
-			set_page_dirty(page);
-			unlock_page(page);
+	for (sg = pages->sgl; sg; sg = __sg_next(sg)) {
+		struct page *page = sg_page(sg);
+		unsigned int n = sg->length >> PAGE_SHIFT;
+
+		/* Walk each segment a folio at a time, not page by page */
+		while (n) {
+			struct folio *folio = page_folio(page);
+			unsigned int nr;
+
+			nr = min_t(unsigned long, n,
+				   folio_nr_pages(folio) -
+				   folio_page_idx(folio, page));
+
+			if (obj->mm.dirty && folio_trylock(folio)) {
+				/*
+				 * As this may not be anonymous memory
+				 * (e.g. shmem) but exist on a real mapping,
+				 * we have to lock the folio in order to dirty
+				 * it -- holding the page reference is not
+				 * sufficient to prevent the inode from being
+				 * truncated. Play safe and take the lock.
+				 *
+				 * However...!
+				 *
+				 * The mmu-notifier can be invalidated for a
+				 * migrate_folio, that is alreadying holding
+				 * the lock on the folio. Such a try_to_unmap()
+				 * will result in us calling put_pages() and
+				 * so recursively try to lock the folio. We
+				 * avoid that deadlock with a folio_trylock()
+				 * and in exchange we risk missing some page
+				 * dirtying.
+				 */
+				folio_mark_dirty(folio);
+				folio_unlock(folio);
+			}
+
+			folio_mark_accessed(folio);
+
+			page = nth_page(page, nr);
+			n -= nr;
 		}
-
-		mark_page_accessed(page);
 	}
 	obj->mm.dirty = false;
 
@@ -550,3 +644,6 @@ i915_gem_userptr_ioctl(struct drm_device *dev,
 #endif
 }
 
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#include "selftests/i915_gem_userptr.c"
+#endif
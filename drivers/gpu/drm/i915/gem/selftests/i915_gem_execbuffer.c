@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "i915_selftest.h"
+
+#include "gem/i915_gem_internal.h"
+
+#include "mock_context.h"
+#include "selftests/mock_drm.h"
+#include "selftests/mock_gem_device.h"
+
+static int mock_eb_submit(struct i915_execbuffer *eb,
+			  struct drm_i915_gem_exec_object2 *exec,
+			  const struct drm_i915_gem_exec_object2 *user,
+			  bool update)
+{
+	int err;
+
+	/* Mimic the copy_from_user() of the execobject[] */
+	memcpy(exec, user, eb->args->buffer_count * sizeof(*exec));
+
+	eb->buffer_count = eb->args->buffer_count;
+	eb->vma[0].vma = NULL;
+	eb->resident = NULL;
+	eb->resident_update = NULL;
+	eb->resident_flags = update ? I915_EXEC_RESIDENT_SET_UPDATE : 0;
+
+	err = eb_create(eb);
+	if (err)
+		return err;
+
+	err = eb_lookup_vmas(eb);
+	if (err) {
+		eb_release_vmas(eb, true);
+		goto out;
+	}
+
+	i915_gem_ww_ctx_init(&eb->ww, false);
+retry:
+	err = eb_validate_vmas(eb);
+	if (err == -EDEADLK) {
+		eb_release_vmas(eb, false);
+		err = i915_gem_ww_ctx_backoff(&eb->ww);
+		if (!err)
+			goto retry;
+	}
+
+	if (!err && eb->resident_update) {
+		i915_gem_context_set_resident_set(eb->gem_context,
+						  eb->resident_update);
+		eb->resident_update = NULL;
+	}
+
+	eb_release_vmas(eb, true);
+	i915_gem_ww_ctx_fini(&eb->ww);
+out:
+	eb_destroy(eb);
+	return err;
+}
+
+static int __igt_resident_set(struct drm_i915_private *i915,
+			      struct file *file,
+			      struct i915_gem_context *ctx,
+			      struct intel_context *ce,
+			      unsigned int count)
+{
+	const unsigned int loops = 64;
+	struct drm_i915_gem_exec_object2 *user, *exec, *ref;
+	struct drm_i915_gem_execbuffer2 args = {
+		.buffer_count = count,
+		.flags = I915_EXEC_HANDLE_LUT | I915_EXEC_NO_RELOC,
+	};
+	struct i915_execbuffer eb = {
+		.i915 = i915,
+		.file = to_drm_file(file),
+		.args = &args,
+		.gem_context = ctx,
+		.context = ce,
+		.num_batches = 1,
+		.invalid_flags = __EXEC_OBJECT_UNKNOWN_FLAGS,
+	};
+	ktime_t dt[2];
+	unsigned int i, pass;
+	int err = 0;
+
+	user = kvmalloc_array(count, sizeof(*user), GFP_KERNEL);
+	ref = kvmalloc_array(count, sizeof(*ref), GFP_KERNEL);
+	exec = kvmalloc_array(count + 1, eb_element_size(), GFP_KERNEL);
+	if (!user || !ref || !exec) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	eb.exec = exec;
+	eb.vma = (struct eb_vma *)(exec + count + 1);
+	reloc_cache_init(&eb.reloc_cache, i915);
+	eb_capture_list_clear(&eb);
+
+	for (i = 0; i < count; i++) {
+		struct drm_i915_gem_object *obj;
+
+		obj = i915_gem_object_create_internal(i915, PAGE_SIZE);
+		if (IS_ERR(obj)) {
+			err = PTR_ERR(obj);
+			goto out;
+		}
+
+		memset(&user[i], 0, sizeof(user[i]));
+		err = drm_gem_handle_create(eb.file, &obj->base,
+					    &user[i].handle);
+		i915_gem_object_put(obj);
+		if (err)
+			goto out;
+
+		user[i].flags = EXEC_OBJECT_SUPPORTS_48B_ADDRESS;
+
+		/* Mix in padding, and stale padding that must be ignored */
+		switch (i % 3) {
+		case 0:
+			user[i].flags |= EXEC_OBJECT_PAD_TO_SIZE;
+			user[i].pad_to_size = 2 * PAGE_SIZE;
+			break;
+		case 1:
+			user[i].pad_to_size = 0xdead000;
+			break;
+		}
+	}
+
+	for (pass = 0; pass < ARRAY_SIZE(dt); pass++) {
+		eb.use_resident = pass;
+
+		/* Warm up: bind everything, and register the resident set */
+		err = mock_eb_submit(&eb, exec, user, pass);
+		if (err)
+			goto out;
+
+		dt[pass] = ktime_get_raw();
+		for (i = 0; i < loops; i++) {
+			err = mock_eb_submit(&eb, exec, user, false);
+			if (err)
+				goto out;
+		}
+		dt[pass] = ktime_sub(ktime_get_raw(), dt[pass]);
+
+		/*
+		 * The resident set must only be a shortcut: the execobjects
+		 * after validation and binding, including the offsets, must
+		 * be exactly those of a plain lookup.
+		 */
+		if (!pass) {
+			memcpy(ref, exec, count * sizeof(*ref));
+			continue;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (exec[i].flags != ref[i].flags ||
+			    exec[i].pad_to_size != ref[i].pad_to_size ||
+			    exec[i].alignment != ref[i].alignment ||
+			    exec[i].offset != ref[i].offset) {
+				pr_err("%s: execobject %u differs with resident set, flags %llx/%llx, pad_to_size %llx/%llx, offset %llx/%llx\n",
+				       __func__, i,
+				       exec[i].flags, ref[i].flags,
+				       exec[i].pad_to_size, ref[i].pad_to_size,
+				       exec[i].offset, ref[i].offset);
+				err = -EINVAL;
+				goto out;
+			}
+		}
+	}
+
+	pr_info("%s: %u objects, %lluns/submit, %lluns/submit with resident set\n",
+		__func__, count,
+		div_u64(ktime_to_ns(dt[0]), loops),
+		div_u64(ktime_to_ns(dt[1]), loops));
+
+out:
+	kvfree(exec);
+	kvfree(ref);
+	kvfree(user);
+	return err;
+}
+
+static int igt_resident_set(void *arg)
+{
+	static const unsigned int sizes[] = { 16, 256, 1024, 4096 };
+	struct drm_i915_private *i915 = arg;
+	struct i915_gem_context *ctx;
+	struct intel_context *ce;
+	unsigned int n;
+	int err = 0;
+
+	for (n = 0; n < ARRAY_SIZE(sizes); n++) {
+		struct file *file;
+
+		file = mock_file(i915);
+		if (IS_ERR(file))
+			return PTR_ERR(file);
+
+		ctx = mock_context(i915, "resident");
+		if (!ctx) {
+			err = -ENOMEM;
+			goto out_file;
+		}
+
+		ce = i915_gem_context_get_engine(ctx, 0);
+		if (IS_ERR(ce)) {
+			err = PTR_ERR(ce);
+			goto out_ctx;
+		}
+
+		err = __igt_resident_set(i915, file, ctx, ce, sizes[n]);
+
+		intel_context_put(ce);
+out_ctx:
+		mock_context_close(ctx);
+out_file:
+		fput(file);
+		if (err)
+			break;
+	}
+
+	return err;
+}
+
+int i915_gem_execbuffer_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_resident_set),
+	};
+	struct drm_i915_private *i915;
+	int err;
+
+	i915 = mock_gem_device();
+	if (!i915)
+		return -ENOMEM;
+
+	err = i915_subtests(tests, i915);
+
+	mock_destroy_device(i915);
+	return err;
+}
@@ -511,6 +511,91 @@ static int igt_lmem_async_migrate(void *arg)
 	return ret;
 }
 
+static int __perf_memcpy_migrate(struct intel_gt *gt, size_t sz, ktime_t *dt)
+{
+	struct drm_i915_gem_object *obj;
+	struct i915_gem_ww_ctx ww;
+	int err;
+
+	obj = i915_gem_object_create_lmem(gt->i915, sz, 0);
+	if (IS_ERR(obj))
+		return PTR_ERR(obj);
+
+	for_i915_gem_ww(&ww, err, true) {
+		ktime_t t0;
+
+		err = i915_gem_object_lock(obj, &ww);
+		if (err)
+			continue;
+
+		err = igt_fill_check_buffer(obj, gt, true);
+		if (err)
+			continue;
+
+		t0 = ktime_get();
+		err = i915_gem_object_migrate(obj, &ww, INTEL_REGION_SMEM);
+		if (!err)
+			err = i915_gem_object_wait_migration(obj, true);
+		if (!err)
+			err = i915_gem_object_migrate(obj, &ww,
+						      INTEL_REGION_LMEM_0);
+		if (!err)
+			err = i915_gem_object_wait_migration(obj, true);
+		*dt = ktime_sub(ktime_get(), t0);
+
+		/* Each slice must land at its own offset, in both directions */
+		if (!err)
+			err = igt_fill_check_buffer(obj, gt, false);
+	}
+
+	i915_gem_object_put(obj);
+	return err;
+}
+
+static int perf_lmem_memcpy_migrate(void *arg)
+{
+	static const size_t sizes[] = { SZ_8M, SZ_64M, SZ_256M };
+	struct intel_gt *gt = arg;
+	struct intel_memory_region *mr = gt->i915->mm.regions[INTEL_REGION_LMEM_0];
+	int i, err = 0;
+
+	/*
+	 * Force the CPU memcpy fallback in both directions, and compare
+	 * copying on a single worker against slicing the copy across
+	 * several, checking the contents survive either way. The failed
+	 * blit is still a clear, and counted as well.
+	 */
+
+	if (!mr || mr->io_size < mr->total)
+		return 0;
+
+	i915_ttm_migrate_set_failure_modes(true, true);
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		ktime_t dt[2];
+
+		i915_ttm_migrate_set_memcpy_workers(1);
+		err = __perf_memcpy_migrate(gt, sizes[i], &dt[0]);
+		if (err)
+			break;
+
+		i915_ttm_migrate_set_memcpy_workers(0);
+		err = __perf_memcpy_migrate(gt, sizes[i], &dt[1]);
+		if (err)
+			break;
+
+		pr_info("%s: %zu KiB lmem->smem->lmem: %llu MiB/s on one worker, %llu MiB/s sliced\n",
+			__func__, sizes[i] >> 10,
+			div64_u64(2ull * sizes[i] * NSEC_PER_SEC,
+				  ktime_to_ns(dt[0]) * SZ_1M + 1),
+			div64_u64(2ull * sizes[i] * NSEC_PER_SEC,
+				  ktime_to_ns(dt[1]) * SZ_1M + 1));
+	}
+	i915_ttm_migrate_set_failure_modes(false, false);
+	i915_ttm_migrate_set_memcpy_workers(0);
+
+	return err;
+}
+
 int i915_gem_migrate_live_selftests(struct drm_i915_private *i915)
 {
 	static const struct i915_subtest tests[] = {
@@ -519,6 +604,7 @@ int i915_gem_migrate_live_selftests(struct drm_i915_private *i915)
 		SUBTEST(igt_same_create_migrate),
 		SUBTEST(igt_lmem_pages_failsafe_migrate),
 		SUBTEST(igt_lmem_async_migrate),
+		SUBTEST(perf_lmem_memcpy_migrate),
 	};
 
 	if (!HAS_LMEM(i915))
@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include <linux/mman.h>
+
+#include "i915_selftest.h"
+
+#include "selftests/mock_gem_device.h"
+
+#ifdef CONFIG_MMU_NOTIFIER
+
+struct userptr_range {
+	unsigned long base;
+	unsigned long addr;
+	unsigned long size;
+};
+
+static int userptr_range_mmap(struct userptr_range *r, unsigned long size)
+{
+	struct vm_area_struct *vma;
+	unsigned long addr;
+
+	/* Overallocate so that we can align the range for THP */
+	addr = vm_mmap(NULL, 0, size + SZ_2M,
+		       PROT_READ | PROT_WRITE,
+		       MAP_ANONYMOUS | MAP_PRIVATE,
+		       0);
+	if (IS_ERR_VALUE(addr))
+		return addr;
+
+	r->base = addr;
+	r->addr = round_up(addr, SZ_2M);
+	r->size = size;
+
+	/* As madvise(MADV_HUGEPAGE), for when THP is only enabled on request */
+	mmap_write_lock(current->mm);
+	vma = find_vma(current->mm, r->addr);
+	if (vma)
+		vm_flags_set(vma, VM_HUGEPAGE);
+	mmap_write_unlock(current->mm);
+
+	return 0;
+}
+
+static void userptr_range_munmap(struct userptr_range *r)
+{
+	vm_munmap(r->base, r->size + SZ_2M);
+}
+
+static struct drm_i915_gem_object *
+userptr_object(struct drm_i915_private *i915, const struct userptr_range *r)
+{
+	static struct lock_class_key lock_class;
+	struct drm_i915_gem_object *obj;
+	int err;
+
+	/* Mimic i915_gem_userptr_ioctl() */
+	obj = i915_gem_object_alloc();
+	if (!obj)
+		return ERR_PTR(-ENOMEM);
+
+	drm_gem_private_object_init(&i915->drm, &obj->base, r->size);
+	i915_gem_object_init(obj, &i915_gem_userptr_ops, &lock_class,
+			     I915_BO_ALLOC_USER);
+	obj->mem_flags = I915_BO_FLAG_STRUCT_PAGE;
+	obj->read_domains = I915_GEM_DOMAIN_CPU;
+	obj->write_domain = I915_GEM_DOMAIN_CPU;
+	i915_gem_object_set_cache_coherency(obj, I915_CACHE_LLC);
+
+	obj->userptr.ptr = r->addr;
+	obj->userptr.notifier_seq = ULONG_MAX;
+
+	err = i915_gem_userptr_init__mmu_notifier(obj);
+	if (err) {
+		i915_gem_object_put(obj);
+		return ERR_PTR(err);
+	}
+
+	return obj;
+}
+
+static unsigned long gtt_entries(struct sg_table *st, unsigned int page_sizes)
+{
+	struct scatterlist *sg;
+	unsigned long count = 0;
+
+	for (sg = st->sgl; sg && sg_dma_len(sg); sg = __sg_next(sg)) {
+		dma_addr_t addr = sg_dma_address(sg);
+		unsigned int rem = sg_dma_len(sg);
+
+		/* Greedily pick the largest GTT page that fits, as gen8 does */
+		while (rem) {
+			unsigned int sz = I915_GTT_PAGE_SIZE_4K;
+
+			if (page_sizes & I915_GTT_PAGE_SIZE_2M &&
+			    IS_ALIGNED(addr, I915_GTT_PAGE_SIZE_2M) &&
+			    rem >= I915_GTT_PAGE_SIZE_2M)
+				sz = I915_GTT_PAGE_SIZE_2M;
+			else if (page_sizes & I915_GTT_PAGE_SIZE_64K &&
+				 IS_ALIGNED(addr, I915_GTT_PAGE_SIZE_64K) &&
+				 rem >= I915_GTT_PAGE_SIZE_64K)
+				sz = I915_GTT_PAGE_SIZE_64K;
+
+			addr += sz;
+			rem -= sz;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static bool has_pmd_folio(struct page **pvec, unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		if (folio_size(page_folio(pvec[i])) >= SZ_2M)
+			return true;
+	}
+
+	return false;
+}
+
+static int check_sg_pages(struct sg_table *st, struct page **pvec,
+			  unsigned int count)
+{
+	struct sgt_iter sgt_iter;
+	struct page *page;
+	unsigned int i = 0;
+
+	for_each_sgt_page(page, sgt_iter, st) {
+		if (i >= count || page != pvec[i]) {
+			pr_err("scatterlist does not match pinned page %u\n", i);
+			return -EINVAL;
+		}
+		i++;
+	}
+
+	if (i != count) {
+		pr_err("scatterlist has %u pages, expected %u\n", i, count);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int __igt_userptr_folios(struct drm_i915_private *i915,
+				unsigned long size)
+{
+	const unsigned int max_segment = i915_sg_segment_size(i915->drm.dev);
+	const unsigned int count = size >> PAGE_SHIFT;
+	struct drm_i915_gem_object *obj;
+	struct userptr_range r;
+	struct sg_table st[2];
+	struct scatterlist *sg;
+	ktime_t dt[3];
+	unsigned int n;
+	bool huge;
+	int err;
+
+	err = userptr_range_mmap(&r, size);
+	if (err)
+		return err;
+
+	obj = userptr_object(i915, &r);
+	if (IS_ERR(obj)) {
+		err = PTR_ERR(obj);
+		goto out_unmap;
+	}
+
+	dt[0] = ktime_get_raw();
+	err = i915_gem_object_userptr_submit_init(obj);
+	dt[0] = ktime_sub(ktime_get_raw(), dt[0]);
+	if (err)
+		goto out_put;
+
+	err = i915_gem_object_lock(obj, NULL);
+	if (err)
+		goto out_put;
+
+	err = i915_gem_object_pin_pages(obj);
+	if (err)
+		goto out_unlock;
+
+	err = check_sg_pages(obj->mm.pages, obj->userptr.pvec, count);
+	if (err)
+		goto out_unpin;
+
+	/* Segments are capped at max_segment, so 2M pages may not fit */
+	huge = has_pmd_folio(obj->userptr.pvec, count);
+	if (huge && max_segment >= SZ_2M &&
+	    !(obj->mm.page_sizes.sg & I915_GTT_PAGE_SIZE_2M)) {
+		pr_err("THP backed userptr of %luKiB did not use 2M pages, page_sizes.phys=%x\n",
+		       size >> 10, obj->mm.page_sizes.phys);
+		err = -EINVAL;
+		goto out_unpin;
+	}
+
+	/* Compare against building the table a page at a time */
+	dt[1] = ktime_get_raw();
+	err = sg_alloc_table_from_pages_segment(&st[0], obj->userptr.pvec,
+						count, 0, size, max_segment,
+						GFP_KERNEL);
+	dt[1] = ktime_sub(ktime_get_raw(), dt[1]);
+	if (err)
+		goto out_unpin;
+
+	dt[2] = ktime_get_raw();
+	err = userptr_sg_alloc_table(&st[1], obj->userptr.pvec,
+				     count, max_segment);
+	dt[2] = ktime_sub(ktime_get_raw(), dt[2]);
+	if (err) {
+		sg_free_table(&st[0]);
+		goto out_unpin;
+	}
+
+	/* The table is sized to the segments, with no entry left unused */
+	for_each_sg(st[1].sgl, sg, st[1].orig_nents, n) {
+		if (!sg->length) {
+			pr_err("scatterlist entry %u of %u left unused\n",
+			       n, st[1].orig_nents);
+			err = -EINVAL;
+			goto out_free;
+		}
+	}
+
+	err = check_sg_pages(&st[1], obj->userptr.pvec, count);
+	if (err)
+		goto out_free;
+
+	pr_info("%s: %luKiB %s: pinned in %lluus; sg built in %lluus by page (%u segments), %lluus by folio (%u segments); %lu GTT entries vs %lu 4K entries\n",
+		__func__, size >> 10, huge ? "thp" : "4K",
+		div_u64(ktime_to_ns(dt[0]), NSEC_PER_USEC),
+		div_u64(ktime_to_ns(dt[1]), NSEC_PER_USEC), st[0].nents,
+		div_u64(ktime_to_ns(dt[2]), NSEC_PER_USEC), st[1].nents,
+		gtt_entries(obj->mm.pages, obj->mm.page_sizes.sg),
+		gtt_entries(obj->mm.pages, I915_GTT_PAGE_SIZE_4K));
+
+out_free:
+	sg_free_table(&st[1]);
+	sg_free_table(&st[0]);
+out_unpin:
+	i915_gem_object_unpin_pages(obj);
+out_unlock:
+	i915_gem_object_unlock(obj);
+out_put:
+	i915_gem_object_put(obj);
+	i915_gem_drain_freed_objects(i915);
+out_unmap:
+	userptr_range_munmap(&r);
+	return err;
+}
+
+static int igt_userptr_folios(void *arg)
+{
+	static const unsigned long sizes[] = { SZ_64K, SZ_2M, SZ_16M, SZ_64M };
+	struct drm_i915_private *i915 = arg;
+	unsigned int n;
+	int err = 0;
+
+	/*
+	 * When the user range is backed by large folios, the scatterlist
+	 * should be built from large segments, so that the GTT can use
+	 * 64K/2M pages to map it.
+	 */
+
+	if (!current->mm)
+		return 0;
+
+	for (n = 0; n < ARRAY_SIZE(sizes); n++) {
+		err = __igt_userptr_folios(i915, sizes[n]);
+		if (err)
+			break;
+
+		cond_resched();
+	}
+
+	return err;
+}
+
+#endif
+
+int i915_gem_userptr_mock_selftests(void)
+{
+#ifdef CONFIG_MMU_NOTIFIER
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_userptr_folios),
+	};
+	struct drm_i915_private *i915;
+	int err;
+
+	i915 = mock_gem_device();
+	if (!i915)
+		return -ENOMEM;
+
+	err = i915_subtests(tests, i915);
+
+	mock_destroy_device(i915);
+	return err;
+#else
+	return 0;
+#endif
+}
@@ -2412,6 +2412,12 @@ void intel_engine_dump(struct intel_engine_cs *engine,
 								  &dummy)));
 	drm_printf(m, "\tForcewake: %x domains, %d active\n",
 		   engine->fw_domain, READ_ONCE(engine->fw_active));
+	drm_printf(m, "\tBusywait: %lu spins, %lu hits, %lu skipped, %lluus spinning\n",
+		   atomic_long_read(&engine->busywait.spins),
+		   atomic_long_read(&engine->busywait.hits),
+		   atomic_long_read(&engine->busywait.skips),
+		   div_u64(atomic64_read(&engine->busywait.spin_ns),
+			   NSEC_PER_USEC));
 
 	rcu_read_lock();
 	rq = READ_ONCE(engine->heartbeat.systole);
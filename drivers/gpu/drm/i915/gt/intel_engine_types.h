@@ -54,6 +54,7 @@ struct intel_ring;
 struct intel_uncore;
 struct intel_breadcrumbs;
 struct intel_engine_cs;
+struct intel_engine_cmd_cache;
 struct i915_perf_group;
 
 typedef u32 intel_engine_mask_t;
@@ -613,6 +614,12 @@ struct intel_engine_cs {
 	 */
 	u32 (*get_cmd_length_mask)(u32 cmd_header);
 
+	/*
+	 * Cache of recently validated batches, keyed by their contents, so
+	 * that resubmitting an identical batch skips the scan.
+	 */
+	struct intel_engine_cmd_cache *cmd_cache;
+
 	struct {
 		union {
 			struct intel_engine_execlists_stats execlists;
@@ -625,6 +632,33 @@ struct intel_engine_cs {
 		ktime_t rps;
 	} stats;
 
+	/**
+	 * @busywait: How well the optimistic spin in i915_request_wait() is
+	 * paying off, reported in the engine dump.
+	 */
+	struct {
+		/** @busywait.spins: number of busywaits */
+		atomic_long_t spins;
+		/** @busywait.hits: busywaits that saw the request complete */
+		atomic_long_t hits;
+		/** @busywait.skips: waits that went straight to sleep */
+		atomic_long_t skips;
+		/** @busywait.spin_ns: total CPU time spent busywaiting */
+		atomic64_t spin_ns;
+		/**
+		 * @busywait.hist: How long waiters had to wait for requests
+		 * to complete once they were running, in log2 buckets of
+		 * microseconds. Used to pick the busywait budget; updates
+		 * from concurrent waiters may race, it is only a heuristic.
+		 * Kept on the engine as the request's context may already
+		 * be gone by the time the waiter sees it complete.
+		 */
+		struct intel_engine_wait_hist {
+#define INTEL_ENGINE_WAIT_BUCKETS 8
+			u16 count[INTEL_ENGINE_WAIT_BUCKETS];
+		} hist;
+	} busywait;
+
 	struct {
 		unsigned long heartbeat_interval_ms;
 		unsigned long max_busywait_duration_ns;
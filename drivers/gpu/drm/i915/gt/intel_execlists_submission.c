@@ -2435,6 +2435,8 @@ static void execlists_submission_tasklet(struct tasklet_struct *t)
 	struct i915_request *post[2 * EXECLIST_MAX_PORTS];
 	struct i915_request **inactive;
 
+	i915_sched_engine_flush_boosts(sched_engine);
+
 	rcu_read_lock();
 	inactive = process_csb(engine, post);
 	GEM_BUG_ON(inactive - post > ARRAY_SIZE(post));
@@ -3813,9 +3815,12 @@ static void virtual_submission_tasklet(struct tasklet_struct *t)
 		from_tasklet(sched_engine, t, tasklet);
 	struct virtual_engine * const ve =
 		(struct virtual_engine *)sched_engine->private_data;
-	const int prio = READ_ONCE(sched_engine->queue_priority_hint);
 	intel_engine_mask_t mask;
 	unsigned int n;
+	int prio;
+
+	i915_sched_engine_flush_boosts(sched_engine);
+	prio = READ_ONCE(sched_engine->queue_priority_hint);
 
 	rcu_read_lock();
 	mask = virtual_submission_mask(ve);
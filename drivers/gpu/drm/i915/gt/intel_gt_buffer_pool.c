@@ -3,6 +3,11 @@
  * Copyright © 2014-2018 Intel Corporation
  */
 
+#include <linux/shrinker.h>
+
+#include <drm/drm_managed.h>
+#include <drm/drm_print.h>
+
 #include "gem/i915_gem_internal.h"
 #include "gem/i915_gem_object.h"
 
@@ -10,6 +15,9 @@
 #include "intel_engine_pm.h"
 #include "intel_gt_buffer_pool.h"
 
+/* How many retired nodes to keep in each engine's private cache */
+#define POOL_ENGINE_CACHE_MAX 8
+
 static struct list_head *
 bucket_for_size(struct intel_gt_buffer_pool *pool, size_t sz)
 {
@@ -27,61 +35,103 @@ bucket_for_size(struct intel_gt_buffer_pool *pool, size_t sz)
 	return &pool->cache_list[n];
 }
 
-static void node_free(struct intel_gt_buffer_pool_node *node)
+static bool node_is_local(const struct intel_gt_buffer_pool_node *node, int nid)
+{
+	return node->nid == nid || node->nid == NUMA_NO_NODE;
+}
+
+static void node_free(struct intel_gt_buffer_pool *pool,
+		      struct intel_gt_buffer_pool_node *node)
 {
+	atomic_long_sub(node->obj->base.size, &pool->total);
 	i915_gem_object_put(node->obj);
 	i915_active_fini(&node->active);
 	kfree_rcu(node, rcu);
 }
 
-static bool pool_free_older_than(struct intel_gt_buffer_pool *pool, long keep)
+static void lru_del(struct intel_gt_buffer_pool *pool,
+		    struct intel_gt_buffer_pool_node *node)
 {
-	struct intel_gt_buffer_pool_node *node, *stale = NULL;
-	bool active = false;
-	int n;
+	unsigned long flags;
 
-	/* Free buffers that have not been used in the past second */
-	for (n = 0; n < ARRAY_SIZE(pool->cache_list); n++) {
-		struct list_head *list = &pool->cache_list[n];
+	spin_lock_irqsave(&pool->lru_lock, flags);
+	list_del_init(&node->lru);
+	spin_unlock_irqrestore(&pool->lru_lock, flags);
+}
 
-		if (list_empty(list))
-			continue;
+static void node_unlink(struct intel_gt_buffer_pool *pool,
+			struct intel_gt_buffer_pool_node *node)
+{
+	unsigned long flags;
 
-		if (spin_trylock_irq(&pool->lock)) {
-			struct list_head *pos;
+	/* Only the owner of a claimed node moves it between lists */
+	if (!list_empty(&node->cache_link)) {
+		struct intel_gt_buffer_pool_cache *cache = node->cache;
+
+		spin_lock_irqsave(&cache->lock, flags);
+		list_del_init(&node->cache_link);
+		cache->count--;
+		spin_unlock_irqrestore(&cache->lock, flags);
+	} else {
+		spin_lock_irqsave(&pool->lock, flags);
+		list_del_rcu(&node->link);
+		spin_unlock_irqrestore(&pool->lock, flags);
+	}
+}
 
-			/* Most recent at head; oldest at tail */
-			list_for_each_prev(pos, list) {
-				unsigned long age;
+/*
+ * Free the idle nodes retired at least @keep jiffies ago, least recently
+ * retired first, stopping once @nr_pages have been released. Returns the
+ * number of pages freed.
+ */
+static unsigned long pool_free_lru(struct intel_gt_buffer_pool *pool,
+				   long keep, unsigned long nr_pages)
+{
+	struct intel_gt_buffer_pool_node *node, *next, *stale = NULL;
+	unsigned long freed = 0;
 
-				node = list_entry(pos, typeof(*node), link);
+	spin_lock_irq(&pool->lru_lock);
+	list_for_each_entry_safe(node, next, &pool->lru, lru) {
+		unsigned long age;
 
-				age = READ_ONCE(node->age);
-				if (!age || jiffies - age < keep)
-					break;
+		if (freed >= nr_pages)
+			break;
 
-				/* Check we are the first to claim this node */
-				if (!xchg(&node->age, 0))
-					break;
+		/* Skip nodes being claimed for reuse, or changing lists */
+		age = READ_ONCE(node->age);
+		if (!age)
+			continue;
 
-				node->free = stale;
-				stale = node;
-			}
-			if (!list_is_last(pos, list))
-				__list_del_many(pos, list);
+		if (jiffies - age < keep)
+			break;
 
-			spin_unlock_irq(&pool->lock);
-		}
+		/* Check we are the first to claim this node */
+		if (!xchg(&node->age, 0))
+			continue;
+
+		list_del_init(&node->lru);
+		atomic_long_sub(node->obj->base.size, &pool->idle);
+		freed += node->obj->base.size >> PAGE_SHIFT;
 
-		active |= !list_empty(list);
+		node->free = stale;
+		stale = node;
 	}
+	spin_unlock_irq(&pool->lru_lock);
 
 	while ((node = stale)) {
 		stale = stale->free;
-		node_free(node);
+		node_unlink(pool, node);
+		node_free(pool, node);
 	}
 
-	return active;
+	return freed;
+}
+
+static bool pool_free_older_than(struct intel_gt_buffer_pool *pool, long keep)
+{
+	pool_free_lru(pool, keep, ULONG_MAX);
+
+	return !list_empty(&pool->lru);
 }
 
 static void pool_free_work(struct work_struct *wrk)
@@ -95,14 +145,71 @@ static void pool_free_work(struct work_struct *wrk)
 				   round_jiffies_up_relative(HZ));
 }
 
+static void lru_add(struct intel_gt_buffer_pool *pool,
+		    struct intel_gt_buffer_pool_node *node)
+{
+	unsigned long flags;
+
+	/* Queued before the node can be claimed, i.e. while age is 0 */
+	GEM_BUG_ON(node->age);
+	spin_lock_irqsave(&pool->lru_lock, flags);
+	list_add_tail(&node->lru, &pool->lru);
+	spin_unlock_irqrestore(&pool->lru_lock, flags);
+}
+
+static void shared_add(struct intel_gt_buffer_pool *pool,
+		       struct intel_gt_buffer_pool_node *node,
+		       unsigned long age)
+{
+	struct list_head *list = bucket_for_size(pool, node->obj->base.size);
+	unsigned long flags;
+
+	spin_lock_irqsave(&pool->lock, flags);
+	list_add_rcu(&node->link, list);
+	WRITE_ONCE(node->age, age); /* 0 reserved for active nodes */
+	spin_unlock_irqrestore(&pool->lock, flags);
+}
+
+static void cache_add(struct intel_gt_buffer_pool *pool,
+		      struct intel_gt_buffer_pool_cache *cache,
+		      struct intel_gt_buffer_pool_node *node)
+{
+	struct intel_gt_buffer_pool_node *evict = NULL;
+	unsigned long flags, age = 0;
+
+	spin_lock_irqsave(&cache->lock, flags);
+	if (cache->count >= POOL_ENGINE_CACHE_MAX) {
+		/*
+		 * Keep the most recent, hand the oldest over to everyone,
+		 * unless the shrinker has just claimed it and will remove
+		 * it from the cache itself.
+		 */
+		evict = list_last_entry(&cache->list, typeof(*evict),
+					cache_link);
+		age = xchg(&evict->age, 0);
+		if (age) {
+			list_del_init(&evict->cache_link);
+			cache->count--;
+		} else {
+			evict = NULL;
+		}
+	}
+	list_add(&node->cache_link, &cache->list);
+	cache->count++;
+	WRITE_ONCE(node->age, jiffies ?: 1);
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+	/* Still idle and still in the LRU, keep its place there */
+	if (evict)
+		shared_add(pool, evict, age);
+}
+
 static void pool_retire(struct i915_active *ref)
 {
 	struct intel_gt_buffer_pool_node *node =
 		container_of(ref, typeof(*node), active);
 	struct intel_gt_buffer_pool *pool = node->pool;
 	struct intel_gt *gt = container_of(pool, struct intel_gt, buffer_pool);
-	struct list_head *list = bucket_for_size(pool, node->obj->base.size);
-	unsigned long flags;
 
 	if (node->pinned) {
 		i915_gem_object_unpin_pages(node->obj);
@@ -112,11 +219,12 @@ static void pool_retire(struct i915_active *ref)
 		node->pinned = false;
 	}
 
-	GEM_BUG_ON(node->age);
-	spin_lock_irqsave(&pool->lock, flags);
-	list_add_rcu(&node->link, list);
-	WRITE_ONCE(node->age, jiffies ?: 1); /* 0 reserved for active nodes */
-	spin_unlock_irqrestore(&pool->lock, flags);
+	atomic_long_add(node->obj->base.size, &pool->idle);
+	lru_add(pool, node);
+	if (node->cache)
+		cache_add(pool, node->cache, node);
+	else
+		shared_add(pool, node, jiffies ?: 1);
 
 	queue_delayed_work(gt->i915->unordered_wq, &pool->work,
 			   round_jiffies_up_relative(HZ));
@@ -133,6 +241,9 @@ void intel_gt_buffer_pool_mark_used(struct intel_gt_buffer_pool_node *node)
 	/* Hide this pinned object from the shrinker until retired */
 	i915_gem_object_make_unshrinkable(node->obj);
 	node->pinned = true;
+
+	/* Remember where the pages live, to prefer local reuse */
+	node->nid = page_to_nid(sg_page(node->obj->mm.pages->sgl));
 }
 
 static struct intel_gt_buffer_pool_node *
@@ -150,6 +261,10 @@ node_create(struct intel_gt_buffer_pool *pool, size_t sz,
 
 	node->age = 0;
 	node->pool = pool;
+	node->cache = NULL;
+	INIT_LIST_HEAD(&node->cache_link);
+	INIT_LIST_HEAD(&node->lru);
+	node->nid = NUMA_NO_NODE;
 	node->pinned = false;
 	i915_active_init(&node->active, NULL, pool_retire, 0);
 
@@ -164,59 +279,205 @@ node_create(struct intel_gt_buffer_pool *pool, size_t sz,
 
 	node->type = type;
 	node->obj = obj;
+	atomic_long_add(sz, &pool->total);
 	return node;
 }
 
-struct intel_gt_buffer_pool_node *
-intel_gt_get_buffer_pool(struct intel_gt *gt, size_t size,
-			 enum i915_map_type type)
+static struct intel_gt_buffer_pool_node *
+cache_get(struct intel_gt_buffer_pool_cache *cache, size_t size,
+	  enum i915_map_type type, int nid)
 {
-	struct intel_gt_buffer_pool *pool = &gt->buffer_pool;
-	struct intel_gt_buffer_pool_node *node;
-	struct list_head *list;
-	int ret;
-
-	size = PAGE_ALIGN(size);
-	list = bucket_for_size(pool, size);
-
-	rcu_read_lock();
-	list_for_each_entry_rcu(node, list, link) {
-		unsigned long age;
+	struct intel_gt_buffer_pool_node *node, *found = NULL;
+	unsigned long flags;
 
-		if (node->obj->base.size < size)
-			continue;
+	if (!READ_ONCE(cache->count))
+		return NULL;
 
-		if (node->type != type)
+	spin_lock_irqsave(&cache->lock, flags);
+	list_for_each_entry(node, &cache->list, cache_link) {
+		/* Only an exact fit, the engine will ask again for the same */
+		if (node->obj->base.size != size || node->type != type)
 			continue;
 
-		age = READ_ONCE(node->age);
-		if (!age)
+		/* Already claimed by the shrinker */
+		if (!READ_ONCE(node->age))
 			continue;
 
-		if (cmpxchg(&node->age, age, 0) == age) {
-			spin_lock_irq(&pool->lock);
-			list_del_rcu(&node->link);
-			spin_unlock_irq(&pool->lock);
+		if (!found || node_is_local(node, nid))
+			found = node;
+		if (node_is_local(found, nid))
 			break;
+	}
+	if (found && xchg(&found->age, 0)) {
+		list_del_init(&found->cache_link);
+		cache->count--;
+	} else {
+		found = NULL;
+	}
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+	return found;
+}
+
+static struct intel_gt_buffer_pool_node *
+shared_get(struct intel_gt_buffer_pool *pool, size_t size,
+	   enum i915_map_type type, int nid)
+{
+	struct list_head *list = bucket_for_size(pool, size);
+	struct intel_gt_buffer_pool_node *node;
+	bool remote = false;
+	int pass;
+
+	rcu_read_lock();
+	for (pass = 0; pass < 2; pass++) {
+		list_for_each_entry_rcu(node, list, link) {
+			unsigned long age;
+
+			if (node->obj->base.size < size)
+				continue;
+
+			if (node->type != type)
+				continue;
+
+			/* First look for a node local to us */
+			if (!pass && !node_is_local(node, nid)) {
+				remote = true;
+				continue;
+			}
+
+			age = READ_ONCE(node->age);
+			if (!age)
+				continue;
+
+			if (cmpxchg(&node->age, age, 0) == age) {
+				spin_lock_irq(&pool->lock);
+				list_del_rcu(&node->link);
+				spin_unlock_irq(&pool->lock);
+				goto out;
+			}
 		}
+
+		if (!remote)
+			break;
 	}
+	node = NULL;
+out:
 	rcu_read_unlock();
 
-	if (&node->link == list) {
+	return node;
+}
+
+static struct intel_gt_buffer_pool_node *
+__buffer_pool_get(struct intel_gt_buffer_pool *pool,
+		  struct intel_gt_buffer_pool_cache *cache,
+		  size_t size, enum i915_map_type type)
+{
+	const int nid = numa_node_id();
+	struct intel_gt_buffer_pool_node *node = NULL;
+	int ret;
+
+	size = PAGE_ALIGN(size);
+
+	if (cache) {
+		node = cache_get(cache, size, type, nid);
+		if (node)
+			atomic_long_inc(&pool->hits);
+	}
+
+	if (!node) {
+		node = shared_get(pool, size, type, nid);
+		if (node)
+			atomic_long_inc(&pool->shared);
+	}
+
+	if (node) {
+		lru_del(pool, node);
+		atomic_long_sub(node->obj->base.size, &pool->idle);
+		if (!node_is_local(node, nid))
+			atomic_long_inc(&pool->remote);
+	} else {
 		node = node_create(pool, size, type);
 		if (IS_ERR(node))
 			return node;
+
+		atomic_long_inc(&pool->misses);
 	}
 
+	/* Return to the engine that last used us */
+	node->cache = cache;
+
 	ret = i915_active_acquire(&node->active);
 	if (ret) {
-		node_free(node);
+		node_free(pool, node);
 		return ERR_PTR(ret);
 	}
 
 	return node;
 }
 
+struct intel_gt_buffer_pool_node *
+intel_gt_get_buffer_pool(struct intel_gt *gt, size_t size,
+			 enum i915_map_type type)
+{
+	return __buffer_pool_get(&gt->buffer_pool, NULL, size, type);
+}
+
+/**
+ * intel_engine_get_buffer_pool - acquire a buffer for use on an engine
+ * @engine: the engine that will use the buffer
+ * @size: the minimum size of the buffer
+ * @type: how the buffer will be mapped by the CPU
+ *
+ * Like intel_gt_get_buffer_pool(), but first searches a private cache of
+ * buffers recently retired by @engine for an exact size match, avoiding
+ * contention on the shared pool.
+ *
+ * Returns: the pool node, or an error pointer.
+ */
+struct intel_gt_buffer_pool_node *
+intel_engine_get_buffer_pool(struct intel_engine_cs *engine, size_t size,
+			     enum i915_map_type type)
+{
+	struct intel_gt_buffer_pool *pool = &engine->gt->buffer_pool;
+	struct intel_gt_buffer_pool_cache *cache = NULL;
+
+	/* Virtual engines come and go, leave them to the shared pool */
+	if (!intel_engine_is_virtual(engine))
+		cache = &pool->engine[engine->id];
+
+	return __buffer_pool_get(pool, cache, size, type);
+}
+
+static unsigned long
+pool_shrinker_count(struct shrinker *shrinker, struct shrink_control *sc)
+{
+	struct intel_gt_buffer_pool *pool = shrinker->private_data;
+
+	return atomic_long_read(&pool->idle) >> PAGE_SHIFT ?: SHRINK_EMPTY;
+}
+
+static unsigned long
+pool_shrinker_scan(struct shrinker *shrinker, struct shrink_control *sc)
+{
+	struct intel_gt_buffer_pool *pool = shrinker->private_data;
+
+	/*
+	 * Under memory pressure, release the least recently retired idle
+	 * buffers first, whatever their age, until we have freed as many
+	 * pages as we were asked to.
+	 */
+	sc->nr_scanned = pool_free_lru(pool, 0, sc->nr_to_scan);
+
+	return sc->nr_scanned ?: SHRINK_STOP;
+}
+
+static void pool_shrinker_free(struct drm_device *drm, void *data)
+{
+	struct intel_gt_buffer_pool *pool = data;
+
+	shrinker_free(pool->shrinker);
+}
+
 void intel_gt_init_buffer_pool(struct intel_gt *gt)
 {
 	struct intel_gt_buffer_pool *pool = &gt->buffer_pool;
@@ -225,7 +486,26 @@ void intel_gt_init_buffer_pool(struct intel_gt *gt)
 	spin_lock_init(&pool->lock);
 	for (n = 0; n < ARRAY_SIZE(pool->cache_list); n++)
 		INIT_LIST_HEAD(&pool->cache_list[n]);
+	for (n = 0; n < ARRAY_SIZE(pool->engine); n++) {
+		spin_lock_init(&pool->engine[n].lock);
+		INIT_LIST_HEAD(&pool->engine[n].list);
+		pool->engine[n].count = 0;
+	}
+	spin_lock_init(&pool->lru_lock);
+	INIT_LIST_HEAD(&pool->lru);
 	INIT_DELAYED_WORK(&pool->work, pool_free_work);
+
+	pool->shrinker = shrinker_alloc(0, "drm-i915_gt_buffer_pool");
+	if (!pool->shrinker)
+		return; /* no reclaim beyond the age limit */
+
+	pool->shrinker->count_objects = pool_shrinker_count;
+	pool->shrinker->scan_objects = pool_shrinker_scan;
+	pool->shrinker->private_data = pool;
+	shrinker_register(pool->shrinker);
+
+	if (drmm_add_action_or_reset(&gt->i915->drm, pool_shrinker_free, pool))
+		pool->shrinker = NULL;
 }
 
 void intel_gt_flush_buffer_pool(struct intel_gt *gt)
@@ -245,4 +525,31 @@ void intel_gt_fini_buffer_pool(struct intel_gt *gt)
 
 	for (n = 0; n < ARRAY_SIZE(pool->cache_list); n++)
 		GEM_BUG_ON(!list_empty(&pool->cache_list[n]));
+	for (n = 0; n < ARRAY_SIZE(pool->engine); n++)
+		GEM_BUG_ON(!list_empty(&pool->engine[n].list));
+	GEM_BUG_ON(!list_empty(&pool->lru));
+}
+
+void intel_gt_buffer_pool_show(struct intel_gt *gt, struct drm_printer *p)
+{
+	struct intel_gt_buffer_pool *pool = &gt->buffer_pool;
+	unsigned long hits = atomic_long_read(&pool->hits);
+	unsigned long shared = atomic_long_read(&pool->shared);
+	unsigned long misses = atomic_long_read(&pool->misses);
+	unsigned long lookups = hits + shared + misses;
+	struct intel_engine_cs *engine;
+	enum intel_engine_id id;
+
+	drm_printf(p, "Footprint: %lu KiB, idle: %lu KiB\n",
+		   atomic_long_read(&pool->total) >> 10,
+		   atomic_long_read(&pool->idle) >> 10);
+	drm_printf(p, "Lookups: %lu, engine hits: %lu, shared hits: %lu, misses: %lu, hit rate: %lu%%\n",
+		   lookups, hits, shared, misses,
+		   lookups ? (hits + shared) * 100 / lookups : 0);
+	drm_printf(p, "Reused from a remote NUMA node: %lu\n",
+		   atomic_long_read(&pool->remote));
+
+	for_each_engine(engine, gt, id)
+		drm_printf(p, "%s: %u cached\n",
+			   engine->name, READ_ONCE(pool->engine[id].count));
 }
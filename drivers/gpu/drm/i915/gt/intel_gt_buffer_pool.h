@@ -11,12 +11,17 @@
 #include "i915_active.h"
 #include "intel_gt_buffer_pool_types.h"
 
+struct drm_printer;
+struct intel_engine_cs;
 struct intel_gt;
 struct i915_request;
 
 struct intel_gt_buffer_pool_node *
 intel_gt_get_buffer_pool(struct intel_gt *gt, size_t size,
 			 enum i915_map_type type);
+struct intel_gt_buffer_pool_node *
+intel_engine_get_buffer_pool(struct intel_engine_cs *engine, size_t size,
+			     enum i915_map_type type);
 
 void intel_gt_buffer_pool_mark_used(struct intel_gt_buffer_pool_node *node);
 
@@ -40,4 +45,6 @@ void intel_gt_init_buffer_pool(struct intel_gt *gt);
 void intel_gt_flush_buffer_pool(struct intel_gt *gt);
 void intel_gt_fini_buffer_pool(struct intel_gt *gt);
 
+void intel_gt_buffer_pool_show(struct intel_gt *gt, struct drm_printer *p);
+
 #endif /* INTEL_GT_BUFFER_POOL_H */
@@ -6,30 +6,59 @@
 #ifndef INTEL_GT_BUFFER_POOL_TYPES_H
 #define INTEL_GT_BUFFER_POOL_TYPES_H
 
+#include <linux/atomic.h>
 #include <linux/list.h>
 #include <linux/spinlock.h>
 #include <linux/workqueue.h>
 
 #include "gem/i915_gem_object_types.h"
 #include "i915_active_types.h"
+#include "intel_engine_types.h"
+
+struct shrinker;
+
+/*
+ * A small per-engine cache of recently retired nodes, searched for an
+ * exact size match before falling back to the shared cache_list.
+ */
+struct intel_gt_buffer_pool_cache {
+	spinlock_t lock;
+	struct list_head list; /* most recently retired at head */
+	unsigned int count;
+};
 
 struct intel_gt_buffer_pool {
 	spinlock_t lock;
 	struct list_head cache_list[4];
+	struct intel_gt_buffer_pool_cache engine[I915_NUM_ENGINES];
+	spinlock_t lru_lock;
+	struct list_head lru; /* every idle node, least recently retired first */
 	struct delayed_work work;
+	struct shrinker *shrinker;
+
+	atomic_long_t total; /* bytes of all nodes */
+	atomic_long_t idle; /* bytes of nodes waiting in the caches */
+	atomic_long_t hits; /* reused from an engine cache */
+	atomic_long_t shared; /* reused from the shared cache_list */
+	atomic_long_t remote; /* reused with pages on another NUMA node */
+	atomic_long_t misses;
 };
 
 struct intel_gt_buffer_pool_node {
 	struct i915_active active;
 	struct drm_i915_gem_object *obj;
-	struct list_head link;
+	struct list_head link; /* in a shared cache_list bucket, under RCU */
+	struct list_head cache_link; /* in an engine cache */
+	struct list_head lru;
 	union {
 		struct intel_gt_buffer_pool *pool;
 		struct intel_gt_buffer_pool_node *free;
 		struct rcu_head rcu;
 	};
+	struct intel_gt_buffer_pool_cache *cache;
 	unsigned long age;
 	enum i915_map_type type;
+	int nid; /* NUMA node of the backing pages, if known */
 	u32 pinned;
 };
 
@@ -28,6 +28,7 @@
 #include "intel_reset_types.h"
 #include "intel_rc6_types.h"
 #include "intel_rps_types.h"
+#include "intel_tlb_types.h"
 #include "intel_migrate_types.h"
 #include "intel_wakeref.h"
 #include "intel_wopcm.h"
@@ -121,6 +122,16 @@ struct intel_gt {
 		 * invalidate if no full barrier has been passed.
 		 */
 		seqcount_mutex_t seqno;
+
+		/*
+		 * Asynchronous unbinds queue their request here, and a
+		 * single full invalidation is emitted for every request
+		 * gathered while the previous invalidation was in flight.
+		 */
+		spinlock_t lock; /* protects pending */
+		struct list_head pending;
+		struct work_struct work;
+		unsigned long count; /* invalidations emitted for the queue */
 	} tlb;
 
 	struct i915_wa_list wa_list;
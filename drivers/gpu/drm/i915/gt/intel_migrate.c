@@ -5,6 +5,7 @@
 
 #include "i915_drv.h"
 #include "intel_context.h"
+#include "intel_engine_pm.h"
 #include "intel_gpu_commands.h"
 #include "intel_gt.h"
 #include "intel_gtt.h"
@@ -242,9 +243,18 @@ static struct intel_engine_cs *first_copy_engine(struct intel_gt *gt)
 	return NULL;
 }
 
-static struct intel_context *pinned_context(struct intel_gt *gt)
+static struct intel_context *
+__pinned_context(struct intel_engine_cs *engine, struct i915_address_space *vm)
 {
 	static struct lock_class_key key;
+
+	return intel_engine_create_pinned_context(engine, vm, SZ_512K,
+						  I915_GEM_HWS_MIGRATE,
+						  &key, "migrate");
+}
+
+static struct intel_context *pinned_context(struct intel_gt *gt)
+{
 	struct intel_engine_cs *engine;
 	struct i915_address_space *vm;
 	struct intel_context *ce;
@@ -257,13 +267,42 @@ static struct intel_context *pinned_context(struct intel_gt *gt)
 	if (IS_ERR(vm))
 		return ERR_CAST(vm);
 
-	ce = intel_engine_create_pinned_context(engine, vm, SZ_512K,
-						I915_GEM_HWS_MIGRATE,
-						&key, "migrate");
+	ce = __pinned_context(engine, vm);
 	i915_vm_put(vm);
 	return ce;
 }
 
+static void init_stripes(struct intel_migrate *m, struct intel_gt *gt)
+{
+	struct intel_engine_cs *engine;
+	struct intel_context *ce;
+	int i;
+
+	/*
+	 * Each of the other copy engines gets its own pinned context in the
+	 * shared migration vm, so that large transfers can be striped across
+	 * all the blitters. These are optional, if we cannot create them we
+	 * just use the single migration context.
+	 */
+	for (i = 0; i < ARRAY_SIZE(gt->engine_class[COPY_ENGINE_CLASS]); i++) {
+		engine = gt->engine_class[COPY_ENGINE_CLASS][i];
+		if (!engine_supports_migration(engine))
+			continue;
+
+		if (engine == m->context->engine)
+			continue;
+
+		if (m->num_stripes == ARRAY_SIZE(m->stripe))
+			break;
+
+		ce = __pinned_context(engine, m->context->vm);
+		if (IS_ERR(ce))
+			break;
+
+		m->stripe[m->num_stripes++] = ce;
+	}
+}
+
 int intel_migrate_init(struct intel_migrate *m, struct intel_gt *gt)
 {
 	struct intel_context *ce;
@@ -275,6 +314,7 @@ int intel_migrate_init(struct intel_migrate *m, struct intel_gt *gt)
 		return PTR_ERR(ce);
 
 	m->context = ce;
+	init_stripes(m, gt);
 	return 0;
 }
 
@@ -1148,10 +1188,279 @@ intel_migrate_clear(struct intel_migrate *m,
 	return err;
 }
 
+/*
+ * Large transfers are split into stripes, each run by the pinned context on
+ * a different copy engine within its own window of the migration vm, so
+ * that the blitters work in parallel. Each stripe must be large enough to
+ * amortise the extra requests and the final join.
+ */
+#define STRIPE_MIN_SZ (4 * CHUNK_SZ)
+
+static unsigned int
+migrate_stripes(const struct intel_migrate *m, u64 size,
+		struct intel_context **ce, u64 *stripe)
+{
+	unsigned int count, i;
+
+	count = min_t(u64, m->num_stripes + 1, div64_u64(size, STRIPE_MIN_SZ));
+	if (count < 2)
+		return 1;
+
+	/* Keep each stripe to whole chunks, dropping any stripe left empty */
+	*stripe = round_up(div64_u64(size, count), CHUNK_SZ);
+	count = div64_u64(size + *stripe - 1, *stripe);
+
+	ce[0] = m->context;
+	for (i = 1; i < count; i++)
+		ce[i] = m->stripe[i - 1];
+
+	return count;
+}
+
+static int
+sg_slice(struct sg_table *st, struct scatterlist *sg, u64 offset, u64 length)
+{
+	struct scatterlist *s, *d;
+	unsigned int count, i;
+	u64 rem;
+	int err;
+
+	s = sg;
+	while (s && sg_dma_len(s) && offset >= sg_dma_len(s)) {
+		offset -= sg_dma_len(s);
+		s = sg_next(s);
+	}
+	if (GEM_WARN_ON(!s || !sg_dma_len(s)))
+		return -EINVAL;
+
+	count = 0;
+	rem = offset + length;
+	for (d = s; d && sg_dma_len(d) && rem; d = sg_next(d)) {
+		rem -= min_t(u64, rem, sg_dma_len(d));
+		count++;
+	}
+	if (GEM_WARN_ON(rem))
+		return -EINVAL;
+
+	err = sg_alloc_table(st, count, GFP_KERNEL);
+	if (err)
+		return err;
+
+	/* Only the dma addresses are used to write the PTE */
+	for_each_sg(st->sgl, d, count, i) {
+		u32 len = min_t(u64, sg_dma_len(s) - offset, length);
+
+		sg_dma_address(d) = sg_dma_address(s) + offset;
+		sg_dma_len(d) = len;
+		d->length = len;
+
+		length -= len;
+		offset = 0;
+		s = sg_next(s);
+	}
+
+	return 0;
+}
+
+static int migrate_join(struct intel_context *ce,
+			struct i915_request **rq, unsigned int count,
+			int err, struct i915_request **out)
+{
+	struct i915_request *join;
+	unsigned int i;
+	int ret = 0;
+
+	/*
+	 * Present the stripes to the caller as a single fence, a final
+	 * request on the first context that waits upon all of the others.
+	 */
+	intel_engine_pm_get(ce->engine);
+	join = i915_request_create(ce);
+	if (IS_ERR(join)) {
+		intel_engine_pm_put(ce->engine);
+		for (i = 0; i < count; i++) {
+			if (!rq[i])
+				continue;
+
+			i915_request_wait(rq[i], 0, MAX_SCHEDULE_TIMEOUT);
+			i915_request_put(rq[i]);
+		}
+		return err ?: PTR_ERR(join);
+	}
+
+	for (i = 0; i < count; i++) {
+		if (!rq[i])
+			continue;
+
+		if (!ret)
+			ret = i915_request_await_dma_fence(join, &rq[i]->fence);
+		i915_request_put(rq[i]);
+	}
+	if (ret)
+		i915_request_set_error_once(join, ret);
+
+	*out = i915_request_get(join);
+	i915_request_add(join);
+	intel_engine_pm_put(ce->engine);
+
+	return err ?: ret;
+}
+
+/**
+ * intel_migrate_striped_copy - Copy between two scatterlists using every
+ * available copy engine
+ * @m: The migration state
+ * @deps: Optional dependencies to await before each stripe starts
+ * @src: The source scatterlist
+ * @src_pat_index: The pat_index used to map the source
+ * @src_is_lmem: Whether the source resides in local memory
+ * @dst: The destination scatterlist
+ * @dst_pat_index: The pat_index used to map the destination
+ * @dst_is_lmem: Whether the destination resides in local memory
+ * @out: The request to wait upon for completion of the whole copy
+ *
+ * As intel_context_migrate_copy() on the pinned migration context, but
+ * large copies are split into stripes that execute concurrently on the
+ * other copy engines, joined together into the single returned request.
+ * Small copies, and flat-CCS copies where the source and destination
+ * differ in size, are not split.
+ *
+ * Return: 0 on success, negative error code on failure. As with
+ * intel_context_migrate_copy(), @out may be set even on failure and must
+ * then be waited upon before the memory is reused.
+ */
+int intel_migrate_striped_copy(struct intel_migrate *m,
+			       const struct i915_deps *deps,
+			       struct scatterlist *src,
+			       unsigned int src_pat_index,
+			       bool src_is_lmem,
+			       struct scatterlist *dst,
+			       unsigned int dst_pat_index,
+			       bool dst_is_lmem,
+			       struct i915_request **out)
+{
+	struct intel_context *ce[ARRAY_SIZE(m->stripe) + 1];
+	struct i915_request *rq[ARRAY_SIZE(ce)] = {};
+	unsigned int count = 1, i;
+	struct sg_table st[2];
+	u64 size, stripe = 0;
+	int err = 0;
+
+	*out = NULL;
+
+	size = scatter_list_length(src);
+	if (scatter_list_length(dst) == size)
+		count = migrate_stripes(m, size, ce, &stripe);
+	if (count == 1)
+		return intel_context_migrate_copy(m->context, deps,
+						  src, src_pat_index,
+						  src_is_lmem,
+						  dst, dst_pat_index,
+						  dst_is_lmem,
+						  out);
+
+	/* Submit the first stripe last, so that it can carry the join */
+	for (i = count; i--; ) {
+		u64 offset = i * stripe;
+		u64 len = min(stripe, size - offset);
+
+		err = sg_slice(&st[0], src, offset, len);
+		if (err)
+			break;
+
+		err = sg_slice(&st[1], dst, offset, len);
+		if (err) {
+			sg_free_table(&st[0]);
+			break;
+		}
+
+		intel_engine_pm_get(ce[i]->engine);
+		err = intel_context_migrate_copy(ce[i], deps,
+						 st[0].sgl, src_pat_index,
+						 src_is_lmem,
+						 st[1].sgl, dst_pat_index,
+						 dst_is_lmem,
+						 &rq[i]);
+		intel_engine_pm_put(ce[i]->engine);
+
+		sg_free_table(&st[1]);
+		sg_free_table(&st[0]);
+		if (err)
+			break;
+	}
+
+	return migrate_join(m->context, rq, count, err, out);
+}
+
+/**
+ * intel_migrate_striped_clear - Fill a scatterlist using every available
+ * copy engine
+ * @m: The migration state
+ * @deps: Optional dependencies to await before each stripe starts
+ * @sg: The scatterlist to fill
+ * @pat_index: The pat_index used to map the scatterlist
+ * @is_lmem: Whether the scatterlist resides in local memory
+ * @value: The value to fill with
+ * @out: The request to wait upon for completion of the whole fill
+ *
+ * As intel_context_migrate_clear() on the pinned migration context, but
+ * large fills are split into stripes across the copy engines, see
+ * intel_migrate_striped_copy().
+ *
+ * Return: 0 on success, negative error code on failure.
+ */
+int intel_migrate_striped_clear(struct intel_migrate *m,
+				const struct i915_deps *deps,
+				struct scatterlist *sg,
+				unsigned int pat_index,
+				bool is_lmem,
+				u32 value,
+				struct i915_request **out)
+{
+	struct intel_context *ce[ARRAY_SIZE(m->stripe) + 1];
+	struct i915_request *rq[ARRAY_SIZE(ce)] = {};
+	unsigned int count, i;
+	struct sg_table st;
+	u64 size, stripe = 0;
+	int err = 0;
+
+	*out = NULL;
+
+	size = scatter_list_length(sg);
+	count = migrate_stripes(m, size, ce, &stripe);
+	if (count == 1)
+		return intel_context_migrate_clear(m->context, deps, sg,
+						   pat_index, is_lmem,
+						   value, out);
+
+	for (i = count; i--; ) {
+		u64 offset = i * stripe;
+
+		err = sg_slice(&st, sg, offset, min(stripe, size - offset));
+		if (err)
+			break;
+
+		intel_engine_pm_get(ce[i]->engine);
+		err = intel_context_migrate_clear(ce[i], deps, st.sgl,
+						  pat_index, is_lmem,
+						  value, &rq[i]);
+		intel_engine_pm_put(ce[i]->engine);
+
+		sg_free_table(&st);
+		if (err)
+			break;
+	}
+
+	return migrate_join(m->context, rq, count, err, out);
+}
+
 void intel_migrate_fini(struct intel_migrate *m)
 {
 	struct intel_context *ce;
 
+	while (m->num_stripes)
+		intel_engine_destroy_pinned_context(m->stripe[--m->num_stripes]);
+
 	ce = fetch_and_zero(&m->context);
 	if (!ce)
 		return;
@@ -60,6 +60,24 @@ intel_context_migrate_clear(struct intel_context *ce,
 			    u32 value,
 			    struct i915_request **out);
 
+int intel_migrate_striped_copy(struct intel_migrate *m,
+			       const struct i915_deps *deps,
+			       struct scatterlist *src,
+			       unsigned int src_pat_index,
+			       bool src_is_lmem,
+			       struct scatterlist *dst,
+			       unsigned int dst_pat_index,
+			       bool dst_is_lmem,
+			       struct i915_request **out);
+
+int intel_migrate_striped_clear(struct intel_migrate *m,
+				const struct i915_deps *deps,
+				struct scatterlist *sg,
+				unsigned int pat_index,
+				bool is_lmem,
+				u32 value,
+				struct i915_request **out);
+
 void intel_migrate_fini(struct intel_migrate *m);
 
 #endif /* __INTEL_MIGRATE__ */
@@ -6,10 +6,16 @@
 #ifndef __INTEL_MIGRATE_TYPES__
 #define __INTEL_MIGRATE_TYPES__
 
+#include "intel_engine_types.h"
+
 struct intel_context;
 
 struct intel_migrate {
 	struct intel_context *context;
+
+	/* Pinned contexts on the other copy engines, for striped transfers */
+	struct intel_context *stripe[I915_MAX_BCS - 1];
+	unsigned int num_stripes;
 };
 
 #endif /* __INTEL_MIGRATE_TYPES__ */
@@ -1078,6 +1078,7 @@ int intel_rps_set(struct intel_rps *rps, u8 val)
 	}
 
 	rps->cur_freq = val;
+	i915_pmu_gt_freq_changed(rps_to_gt(rps));
 	return 0;
 }
 
@@ -1965,8 +1966,10 @@ void gen5_rps_irq_handler(struct intel_rps *rps)
 			 rps->min_freq_softlimit,
 			 rps->max_freq_softlimit);
 
-	if (new_freq != rps->cur_freq && !__gen5_rps_set(rps, new_freq))
+	if (new_freq != rps->cur_freq && !__gen5_rps_set(rps, new_freq)) {
 		rps->cur_freq = new_freq;
+		i915_pmu_gt_freq_changed(rps_to_gt(rps));
+	}
 
 	spin_unlock(&mchdev_lock);
 }
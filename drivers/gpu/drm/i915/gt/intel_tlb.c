@@ -3,6 +3,8 @@
  * Copyright © 2023 Intel Corporation
  */
 
+#include <linux/dma-fence.h>
+
 #include "i915_drv.h"
 #include "i915_perf_oa_regs.h"
 #include "intel_engine_pm.h"
@@ -157,14 +159,76 @@ void intel_gt_invalidate_tlb_full(struct intel_gt *gt, u32 seqno)
 	}
 }
 
+static void tlb_invalidate_work(struct work_struct *wrk)
+{
+	struct intel_gt *gt = container_of(wrk, typeof(*gt), tlb.work);
+	struct intel_tlb_inval *inval, *next;
+	LIST_HEAD(pending);
+	bool cookie;
+
+	spin_lock(&gt->tlb.lock);
+	list_splice_init(&gt->tlb.pending, &pending);
+	spin_unlock(&gt->tlb.lock);
+	if (list_empty(&pending))
+		return;
+
+	/* The callbacks signal unbind fences, so we must not wait on memory */
+	cookie = dma_fence_begin_signalling();
+
+	/*
+	 * Every request was queued after its PTE were cleared, so a single
+	 * full invalidation started now covers them all. Anything queued
+	 * while we wait for it is gathered for the next pass.
+	 */
+	intel_gt_invalidate_tlb_full(gt, intel_gt_next_invalidate_tlb_full(gt));
+	WRITE_ONCE(gt->tlb.count, gt->tlb.count + 1);
+
+	list_for_each_entry_safe(inval, next, &pending, link)
+		inval->func(inval);
+
+	dma_fence_end_signalling(cookie);
+}
+
+/**
+ * intel_gt_invalidate_tlb_async - Queue a coalesced full TLB invalidation
+ * @gt: the GT whose TLBs must be invalidated
+ * @inval: the request, owned by the caller until @func is called
+ * @func: callback for when the invalidation has completed
+ *
+ * Requests queued close together share a single full invalidation, rather
+ * than each paying for their own MMIO or GuC round trip. @func is called
+ * from process context once the TLBs no longer hold any entry that was
+ * stale when the request was queued.
+ */
+void intel_gt_invalidate_tlb_async(struct intel_gt *gt,
+				   struct intel_tlb_inval *inval,
+				   void (*func)(struct intel_tlb_inval *inval))
+{
+	inval->gt = gt;
+	inval->func = func;
+
+	spin_lock(&gt->tlb.lock);
+	list_add_tail(&inval->link, &gt->tlb.pending);
+	spin_unlock(&gt->tlb.lock);
+
+	queue_work(system_unbound_wq, &gt->tlb.work);
+}
+
 void intel_gt_init_tlb(struct intel_gt *gt)
 {
 	mutex_init(&gt->tlb.invalidate_lock);
 	seqcount_mutex_init(&gt->tlb.seqno, &gt->tlb.invalidate_lock);
+
+	spin_lock_init(&gt->tlb.lock);
+	INIT_LIST_HEAD(&gt->tlb.pending);
+	INIT_WORK(&gt->tlb.work, tlb_invalidate_work);
 }
 
 void intel_gt_fini_tlb(struct intel_gt *gt)
 {
+	flush_work(&gt->tlb.work);
+	GEM_BUG_ON(!list_empty(&gt->tlb.pending));
+
 	mutex_destroy(&gt->tlb.invalidate_lock);
 }
 
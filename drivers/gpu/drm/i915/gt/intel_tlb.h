@@ -10,8 +10,12 @@
 #include <linux/types.h>
 
 #include "intel_gt_types.h"
+#include "intel_tlb_types.h"
 
 void intel_gt_invalidate_tlb_full(struct intel_gt *gt, u32 seqno);
+void intel_gt_invalidate_tlb_async(struct intel_gt *gt,
+				   struct intel_tlb_inval *inval,
+				   void (*func)(struct intel_tlb_inval *inval));
 
 void intel_gt_init_tlb(struct intel_gt *gt);
 void intel_gt_fini_tlb(struct intel_gt *gt);
@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#ifndef INTEL_TLB_TYPES_H
+#define INTEL_TLB_TYPES_H
+
+#include <linux/list.h>
+
+struct intel_gt;
+
+/**
+ * struct intel_tlb_inval - a request queued for a coalesced TLB invalidation
+ * @link: entry in intel_gt.tlb.pending
+ * @gt: the GT the request was queued on
+ * @func: called once a full TLB invalidation, emitted after the request
+ *	was queued, has completed
+ */
+struct intel_tlb_inval {
+	struct list_head link;
+	struct intel_gt *gt;
+	void (*func)(struct intel_tlb_inval *inval);
+};
+
+#endif /* INTEL_TLB_TYPES_H */
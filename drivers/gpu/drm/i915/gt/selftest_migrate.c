@@ -435,6 +435,20 @@ static int __global_copy(struct intel_migrate *migrate,
 					  out);
 }
 
+static int __striped_copy(struct intel_migrate *migrate,
+			  struct i915_gem_ww_ctx *ww,
+			  struct drm_i915_gem_object *src,
+			  struct drm_i915_gem_object *dst,
+			  struct i915_request **out)
+{
+	return intel_migrate_striped_copy(migrate, NULL,
+					  src->mm.pages->sgl, src->pat_index,
+					  i915_gem_object_is_lmem(src),
+					  dst->mm.pages->sgl, dst->pat_index,
+					  i915_gem_object_is_lmem(dst),
+					  out);
+}
+
 static int
 migrate_copy(struct intel_migrate *migrate, u32 sz, struct rnd_state *prng)
 {
@@ -447,6 +461,12 @@ global_copy(struct intel_migrate *migrate, u32 sz, struct rnd_state *prng)
 	return copy(migrate, __global_copy, sz, prng);
 }
 
+static int
+striped_copy(struct intel_migrate *migrate, u32 sz, struct rnd_state *prng)
+{
+	return copy(migrate, __striped_copy, sz, prng);
+}
+
 static int __migrate_clear(struct intel_migrate *migrate,
 			   struct i915_gem_ww_ctx *ww,
 			   struct drm_i915_gem_object *obj,
@@ -473,6 +493,19 @@ static int __global_clear(struct intel_migrate *migrate,
 					   value, out);
 }
 
+static int __striped_clear(struct intel_migrate *migrate,
+			   struct i915_gem_ww_ctx *ww,
+			   struct drm_i915_gem_object *obj,
+			   u32 value,
+			   struct i915_request **out)
+{
+	return intel_migrate_striped_clear(migrate, NULL,
+					   obj->mm.pages->sgl,
+					   obj->pat_index,
+					   i915_gem_object_is_lmem(obj),
+					   value, out);
+}
+
 static int
 migrate_clear(struct intel_migrate *migrate, u32 sz, struct rnd_state *prng)
 {
@@ -485,6 +518,12 @@ global_clear(struct intel_migrate *migrate, u32 sz, struct rnd_state *prng)
 	return clear(migrate, __global_clear, sz, prng);
 }
 
+static int
+striped_clear(struct intel_migrate *migrate, u32 sz, struct rnd_state *prng)
+{
+	return clear(migrate, __striped_clear, sz, prng);
+}
+
 static int live_migrate_copy(void *arg)
 {
 	struct intel_gt *gt = arg;
@@ -499,6 +538,8 @@ static int live_migrate_copy(void *arg)
 		err = migrate_copy(migrate, sizes[i], &prng);
 		if (err == 0)
 			err = global_copy(migrate, sizes[i], &prng);
+		if (err == 0)
+			err = striped_copy(migrate, sizes[i], &prng);
 		i915_gem_drain_freed_objects(i915);
 		if (err)
 			return err;
@@ -521,6 +562,8 @@ static int live_migrate_clear(void *arg)
 		err = migrate_clear(migrate, sizes[i], &prng);
 		if (err == 0)
 			err = global_clear(migrate, sizes[i], &prng);
+		if (err == 0)
+			err = striped_clear(migrate, sizes[i], &prng);
 
 		i915_gem_drain_freed_objects(i915);
 		if (err)
@@ -1014,11 +1057,144 @@ static int perf_copy_blt(void *arg)
 	return 0;
 }
 
+static int striped_blt(struct intel_migrate *m, bool striped,
+		       struct drm_i915_gem_object *src,
+		       struct drm_i915_gem_object *dst,
+		       struct i915_request **rq)
+{
+	const unsigned int pat_index =
+		i915_gem_get_pat_index(m->context->engine->i915,
+				       I915_CACHE_NONE);
+
+	if (!src) {
+		if (striped)
+			return intel_migrate_striped_clear(m, NULL,
+							   dst->mm.pages->sgl,
+							   pat_index,
+							   i915_gem_object_is_lmem(dst),
+							   0, rq);
+
+		return intel_context_migrate_clear(m->context, NULL,
+						   dst->mm.pages->sgl,
+						   pat_index,
+						   i915_gem_object_is_lmem(dst),
+						   0, rq);
+	}
+
+	if (striped)
+		return intel_migrate_striped_copy(m, NULL,
+						  src->mm.pages->sgl, pat_index,
+						  i915_gem_object_is_lmem(src),
+						  dst->mm.pages->sgl, pat_index,
+						  i915_gem_object_is_lmem(dst),
+						  rq);
+
+	return intel_context_migrate_copy(m->context, NULL,
+					  src->mm.pages->sgl, pat_index,
+					  i915_gem_object_is_lmem(src),
+					  dst->mm.pages->sgl, pat_index,
+					  i915_gem_object_is_lmem(dst),
+					  rq);
+}
+
+static int __perf_striped_blt(struct intel_migrate *m,
+			      struct drm_i915_gem_object *src,
+			      struct drm_i915_gem_object *dst,
+			      size_t sz)
+{
+	ktime_t t[2][5];
+	int mode, pass;
+	int err = 0;
+
+	for (mode = 0; mode < ARRAY_SIZE(t); mode++) {
+		for (pass = 0; pass < ARRAY_SIZE(t[mode]); pass++) {
+			struct i915_request *rq;
+			ktime_t t0, t1;
+
+			t0 = ktime_get();
+
+			err = striped_blt(m, mode, src, dst, &rq);
+			if (rq) {
+				if (i915_request_wait(rq, 0, MAX_SCHEDULE_TIMEOUT) < 0)
+					err = -EIO;
+				i915_request_put(rq);
+			}
+			if (err)
+				return err;
+
+			t1 = ktime_get();
+			t[mode][pass] = ktime_sub(t1, t0);
+		}
+
+		sort(t[mode], ARRAY_SIZE(t[mode]), sizeof(*t[mode]),
+		     wrap_ktime_compare, NULL);
+	}
+
+	pr_info("%s: %zd KiB %s: %lld MiB/s on one engine, %lld MiB/s striped across %u engines\n",
+		__func__, sz >> 10, src ? "copy" : "fill",
+		div64_u64(mul_u32_u32(4 * sz, 1000 * 1000 * 1000),
+			  t[0][1] + 2 * t[0][2] + t[0][3]) >> 20,
+		div64_u64(mul_u32_u32(4 * sz, 1000 * 1000 * 1000),
+			  t[1][1] + 2 * t[1][2] + t[1][3]) >> 20,
+		m->num_stripes + 1);
+	return 0;
+}
+
+static int perf_striped_blt(void *arg)
+{
+	struct intel_gt *gt = arg;
+	static const unsigned long sizes[] = {
+		SZ_64M,
+		SZ_256M,
+	};
+	int i;
+
+	/*
+	 * Compare the throughput of large transfers on the single migration
+	 * context against splitting them across all the copy engines.
+	 */
+
+	if (!gt->migrate.num_stripes)
+		return 0;
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		struct drm_i915_gem_object *src, *dst;
+		int err;
+
+		src = create_init_lmem_internal(gt, sizes[i], true);
+		if (IS_ERR(src))
+			return PTR_ERR(src);
+
+		dst = create_init_lmem_internal(gt, src->base.size, false);
+		if (IS_ERR(dst)) {
+			err = PTR_ERR(dst);
+			goto err_src;
+		}
+
+		err = __perf_striped_blt(&gt->migrate, NULL, src,
+					 src->base.size);
+		if (err == 0)
+			err = __perf_striped_blt(&gt->migrate, src, dst,
+						 src->base.size);
+
+		i915_gem_object_unlock(dst);
+		i915_gem_object_put(dst);
+err_src:
+		i915_gem_object_unlock(src);
+		i915_gem_object_put(src);
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
+
 int intel_migrate_perf_selftests(struct drm_i915_private *i915)
 {
 	static const struct i915_subtest tests[] = {
 		SUBTEST(perf_clear_blt),
 		SUBTEST(perf_copy_blt),
+		SUBTEST(perf_striped_blt),
 	};
 	struct intel_gt *gt = to_gt(i915);
 
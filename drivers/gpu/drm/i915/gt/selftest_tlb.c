@@ -19,6 +19,7 @@
 
 #include "selftests/igt_flush_test.h"
 #include "selftests/i915_random.h"
+#include "selftests/mock_gem_device.h"
 
 static void vma_set_qw(struct i915_vma *vma, u64 addr, u64 val)
 {
@@ -403,3 +404,86 @@ int intel_tlb_live_selftests(struct drm_i915_private *i915)
 
 	return 0;
 }
+
+struct mock_tlb_inval {
+	struct intel_tlb_inval base;
+	atomic_t *done;
+};
+
+static void mock_tlb_inval_done(struct intel_tlb_inval *inval)
+{
+	struct mock_tlb_inval *m = container_of(inval, typeof(*m), base);
+
+	atomic_inc(m->done);
+}
+
+static int mock_tlb_coalesce(void *arg)
+{
+	const unsigned int count = 10000;
+	struct intel_gt *gt = arg;
+	struct mock_tlb_inval *inval;
+	unsigned long issued;
+	unsigned int i;
+	atomic_t done;
+	ktime_t dt;
+	int err = 0;
+
+	/*
+	 * A burst of unbinds should share a handful of invalidations,
+	 * and each must only be completed after one has been emitted.
+	 */
+
+	inval = kvmalloc_array(count, sizeof(*inval), GFP_KERNEL);
+	if (!inval)
+		return -ENOMEM;
+
+	atomic_set(&done, 0);
+	issued = READ_ONCE(gt->tlb.count);
+
+	dt = ktime_get_raw();
+	for (i = 0; i < count; i++) {
+		inval[i].done = &done;
+		intel_gt_invalidate_tlb_async(gt, &inval[i].base,
+					      mock_tlb_inval_done);
+	}
+	flush_work(&gt->tlb.work);
+	dt = ktime_sub(ktime_get_raw(), dt);
+
+	issued = READ_ONCE(gt->tlb.count) - issued;
+	pr_info("%s: %u unbinds took %lu invalidations, %lluus\n",
+		__func__, count, issued,
+		div_u64(ktime_to_ns(dt), NSEC_PER_USEC));
+
+	if (atomic_read(&done) != count) {
+		pr_err("Only %d of %u unbinds completed\n",
+		       atomic_read(&done), count);
+		err = -EINVAL;
+	}
+
+	if (!issued || issued > count) {
+		pr_err("Emitted %lu invalidations for %u unbinds\n",
+		       issued, count);
+		err = -EINVAL;
+	}
+
+	kvfree(inval);
+	return err;
+}
+
+int intel_tlb_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(mock_tlb_coalesce),
+	};
+	struct drm_i915_private *i915;
+	int err;
+
+	i915 = mock_gem_device();
+	if (!i915)
+		return -ENOMEM;
+
+	err = i915_subtests(tests, to_gt(i915));
+
+	mock_destroy_device(i915);
+	return err;
+}
@@ -12,6 +12,7 @@
 #include "intel_gsc_binary_headers.h"
 #include "intel_gsc_fw.h"
 #include "intel_gsc_uc_heci_cmd_submit.h"
+#include "i915_memcpy.h"
 #include "i915_reg.h"
 
 static bool gsc_is_in_reset(struct intel_uncore *uncore)
@@ -295,7 +296,7 @@ static int gsc_fw_load_prepare(struct intel_gsc_uc *gsc)
 	if (IS_ERR(src))
 		return PTR_ERR(src);
 
-	memcpy_toio(gsc->local_vaddr, src, gsc->fw.size);
+	i915_memcpy_toio(gsc->local_vaddr, src, gsc->fw.size);
 	memset_io(gsc->local_vaddr + gsc->fw.size, 0, gsc->local->size - gsc->fw.size);
 
 	intel_guc_write_barrier(&gt->uc.guc);
@@ -22,6 +22,7 @@
 #include "i915_vma.h"
 
 struct __guc_ads_blob;
+struct guc_register_batch;
 struct intel_guc_state_capture;
 
 /**
@@ -168,6 +169,11 @@ struct intel_guc {
 		 * we start bypassing the schedule disable delay
 		 */
 		unsigned int sched_disable_gucid_threshold;
+		/**
+		 * @submission_state.register_batch: scratch space to
+		 * re-register the pinned contexts in batches after a reset
+		 */
+		struct guc_register_batch *register_batch;
 	} submission_state;
 
 	/**
@@ -346,6 +352,14 @@ inline int intel_guc_send_nb(struct intel_guc *guc, const u32 *action, u32 len,
 				 MAKE_SEND_FLAGS(g2h_len_dw));
 }
 
+static
+inline int intel_guc_send_batch_nb(struct intel_guc *guc,
+				   const struct intel_guc_ct_msg *msgs,
+				   unsigned int count)
+{
+	return intel_guc_ct_send_batch(&guc->ct, msgs, count);
+}
+
 static inline int
 intel_guc_send_and_receive(struct intel_guc *guc, const u32 *action, u32 len,
 			   u32 *response_buf, u32 response_buf_size)
@@ -390,6 +404,34 @@ static inline int intel_guc_send_busy_loop(struct intel_guc *guc,
 	return err;
 }
 
+static inline int intel_guc_send_batch_busy_loop(struct intel_guc *guc,
+						 const struct intel_guc_ct_msg *msgs,
+						 unsigned int count,
+						 bool loop)
+{
+	int err;
+	unsigned int sleep_period_ms = 1;
+	bool not_atomic = !in_atomic() && !irqs_disabled();
+
+	/* As intel_guc_send_busy_loop(), for a batch of messages */
+	might_sleep_if(loop && not_atomic);
+
+retry:
+	err = intel_guc_send_batch_nb(guc, msgs, count);
+	if (unlikely(err == -EBUSY && loop)) {
+		if (likely(not_atomic)) {
+			if (msleep_interruptible(sleep_period_ms))
+				return -EINTR;
+			sleep_period_ms = sleep_period_ms << 1;
+		} else {
+			cpu_relax();
+		}
+		goto retry;
+	}
+
+	return err;
+}
+
 /* Only call this from the interrupt handler code */
 static inline void intel_guc_to_host_event_handler(struct intel_guc *guc)
 {
@@ -18,6 +18,7 @@
 #include "intel_guc_print.h"
 #include "intel_uc.h"
 #include "i915_drv.h"
+#include "i915_memcpy.h"
 
 /*
  * The Additional Data Struct (ADS) has pointers for different buffers used by
@@ -681,6 +682,18 @@ static u32 guc_get_capture_engine_mask(struct iosys_map *info_map, u32 capture_c
 	return mask;
 }
 
+static void guc_capture_list_write(struct intel_guc *guc, u32 offset,
+				   const void *list, size_t size)
+{
+	struct iosys_map *map = &guc->ads_map;
+
+	/* The ADS lives in lmem on dgfx, stream the lists into the WC map */
+	if (map->is_iomem)
+		i915_memcpy_toio(map->vaddr_iomem + offset, list, size);
+	else
+		iosys_map_memcpy_to(map, offset, list, size);
+}
+
 static int
 guc_capture_prep_lists(struct intel_guc *guc)
 {
@@ -709,7 +722,7 @@ guc_capture_prep_lists(struct intel_guc *guc)
 	total_size = PAGE_SIZE;
 	if (ads_is_mapped) {
 		if (!intel_guc_capture_getnullheader(guc, &ptr, &size))
-			iosys_map_memcpy_to(&guc->ads_map, capture_offset, ptr, size);
+			guc_capture_list_write(guc, capture_offset, ptr, size);
 		null_ggtt = ads_ggtt + capture_offset;
 		capture_offset += PAGE_SIZE;
 	}
@@ -744,7 +757,7 @@ guc_capture_prep_lists(struct intel_guc *guc)
 				}
 				ads_blob_write(guc, ads.capture_class[i][j], ads_ggtt +
 					       capture_offset);
-				iosys_map_memcpy_to(&guc->ads_map, capture_offset, ptr, size);
+				guc_capture_list_write(guc, capture_offset, ptr, size);
 				capture_offset += size;
 			}
 engine_instance_list:
@@ -766,7 +779,7 @@ guc_capture_prep_lists(struct intel_guc *guc)
 				}
 				ads_blob_write(guc, ads.capture_instance[i][j], ads_ggtt +
 					       capture_offset);
-				iosys_map_memcpy_to(&guc->ads_map, capture_offset, ptr, size);
+				guc_capture_list_write(guc, capture_offset, ptr, size);
 				capture_offset += size;
 			}
 		}
@@ -784,7 +797,7 @@ guc_capture_prep_lists(struct intel_guc *guc)
 				continue;
 			}
 			ads_blob_write(guc, ads.capture_global[i], ads_ggtt + capture_offset);
-			iosys_map_memcpy_to(&guc->ads_map, capture_offset, ptr, size);
+			guc_capture_list_write(guc, capture_offset, ptr, size);
 			capture_offset += size;
 		}
 	}
@@ -427,41 +427,59 @@ static u32 ct_get_next_fence(struct intel_guc_ct *ct)
 	return ++ct->requests.last_fence;
 }
 
-static int ct_write(struct intel_guc_ct *ct,
-		    const u32 *action,
-		    u32 len /* in dwords */,
-		    u32 fence, u32 flags)
+static int ct_write_check(struct intel_guc_ct *ct)
 {
 	struct intel_guc_ct_buffer *ctb = &ct->ctbs.send;
 	struct guc_ct_buffer_desc *desc = ctb->desc;
-	u32 tail = ctb->tail;
-	u32 size = ctb->size;
-	u32 header;
-	u32 hxg;
-	u32 type;
-	u32 *cmds = ctb->cmds;
-	unsigned int i;
 
 	if (unlikely(desc->status))
 		goto corrupted;
 
-	GEM_BUG_ON(tail > size);
+	GEM_BUG_ON(ctb->tail > ctb->size);
 
 #ifdef CONFIG_DRM_I915_DEBUG_GUC
-	if (unlikely(tail != READ_ONCE(desc->tail))) {
+	if (unlikely(ctb->tail != READ_ONCE(desc->tail))) {
 		CT_ERROR(ct, "Tail was modified %u != %u\n",
-			 desc->tail, tail);
+			 desc->tail, ctb->tail);
 		desc->status |= GUC_CTB_STATUS_MISMATCH;
 		goto corrupted;
 	}
-	if (unlikely(READ_ONCE(desc->head) >= size)) {
+	if (unlikely(READ_ONCE(desc->head) >= ctb->size)) {
 		CT_ERROR(ct, "Invalid head offset %u >= %u)\n",
-			 desc->head, size);
+			 desc->head, ctb->size);
 		desc->status |= GUC_CTB_STATUS_OVERFLOW;
 		goto corrupted;
 	}
 #endif
 
+	return 0;
+
+corrupted:
+	CT_ERROR(ct, "Corrupted descriptor head=%u tail=%u status=%#x\n",
+		 desc->head, desc->tail, desc->status);
+	CT_DEAD(ct, WRITE);
+	ctb->broken = true;
+	return -EPIPE;
+}
+
+/*
+ * Copy a single message into the H2G buffer and advance our local copy of
+ * the tail. The GuC will not see the message until ct_write_commit().
+ */
+static void __ct_write(struct intel_guc_ct *ct,
+		       const u32 *action,
+		       u32 len /* in dwords */,
+		       u32 fence, u32 flags)
+{
+	struct intel_guc_ct_buffer *ctb = &ct->ctbs.send;
+	u32 tail = ctb->tail;
+	u32 size = ctb->size;
+	u32 header;
+	u32 hxg;
+	u32 type;
+	u32 *cmds = ctb->cmds;
+	unsigned int i;
+
 	/*
 	 * dw0: CT header (including fence)
 	 * dw1: HXG header (including action code)
@@ -497,28 +515,41 @@ static int ct_write(struct intel_guc_ct *ct,
 				FIELD_GET(GUC_HXG_EVENT_MSG_0_ACTION, action[0]));
 #endif
 
+	/* update local copies */
+	ctb->tail = tail;
+	GEM_BUG_ON(atomic_read(&ctb->space) < len + GUC_CTB_HDR_LEN);
+	atomic_sub(len + GUC_CTB_HDR_LEN, &ctb->space);
+}
+
+static void ct_write_commit(struct intel_guc_ct *ct)
+{
+	struct intel_guc_ct_buffer *ctb = &ct->ctbs.send;
+
 	/*
 	 * make sure H2G buffer update and LRC tail update (if this triggering a
 	 * submission) are visible before updating the descriptor tail
 	 */
 	intel_guc_write_barrier(ct_to_guc(ct));
 
-	/* update local copies */
-	ctb->tail = tail;
-	GEM_BUG_ON(atomic_read(&ctb->space) < len + GUC_CTB_HDR_LEN);
-	atomic_sub(len + GUC_CTB_HDR_LEN, &ctb->space);
-
 	/* now update descriptor */
-	WRITE_ONCE(desc->tail, tail);
+	WRITE_ONCE(ctb->desc->tail, ctb->tail);
+}
 
-	return 0;
+static int ct_write(struct intel_guc_ct *ct,
+		    const u32 *action,
+		    u32 len /* in dwords */,
+		    u32 fence, u32 flags)
+{
+	int err;
 
-corrupted:
-	CT_ERROR(ct, "Corrupted descriptor head=%u tail=%u status=%#x\n",
-		 desc->head, desc->tail, desc->status);
-	CT_DEAD(ct, WRITE);
-	ctb->broken = true;
-	return -EPIPE;
+	err = ct_write_check(ct);
+	if (unlikely(err))
+		return err;
+
+	__ct_write(ct, action, len, fence, flags);
+	ct_write_commit(ct);
+
+	return 0;
 }
 
 /**
@@ -708,6 +739,53 @@ static int ct_send_nb(struct intel_guc_ct *ct,
 	return ret;
 }
 
+static int ct_send_batch_nb(struct intel_guc_ct *ct,
+			    const struct intel_guc_ct_msg *msgs,
+			    unsigned int count)
+{
+	struct intel_guc_ct_buffer *ctb = &ct->ctbs.send;
+	unsigned long spin_flags;
+	u32 h2g_len_dw = 0;
+	u32 g2h_len_dw = 0;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < count; i++) {
+		h2g_len_dw += msgs[i].len + GUC_CTB_HDR_LEN;
+		g2h_len_dw += G2H_LEN_DW(MAKE_SEND_FLAGS(msgs[i].g2h_len_dw));
+	}
+
+	/* A batch that can never fit would otherwise report -EBUSY forever */
+	if (h2g_len_dw > ctb->size - ctb->resv_space - 1 ||
+	    g2h_len_dw > ct->ctbs.recv.size - ct->ctbs.recv.resv_space - 1)
+		return -E2BIG;
+
+	spin_lock_irqsave(&ctb->lock, spin_flags);
+
+	ret = has_room_nb(ct, h2g_len_dw, g2h_len_dw);
+	if (unlikely(ret))
+		goto out;
+
+	ret = ct_write_check(ct);
+	if (unlikely(ret))
+		goto out;
+
+	for (i = 0; i < count; i++)
+		__ct_write(ct, msgs[i].action, msgs[i].len,
+			   ct_get_next_fence(ct), INTEL_GUC_CT_SEND_NB);
+
+	/* Publish the whole batch with a single tail update and doorbell */
+	ct_write_commit(ct);
+
+	g2h_reserve_space(ct, g2h_len_dw);
+	intel_guc_notify(ct_to_guc(ct));
+
+out:
+	spin_unlock_irqrestore(&ctb->lock, spin_flags);
+
+	return ret;
+}
+
 static int ct_send(struct intel_guc_ct *ct,
 		   const u32 *action,
 		   u32 len,
@@ -864,6 +942,46 @@ int intel_guc_ct_send(struct intel_guc_ct *ct, const u32 *action, u32 len,
 	return ret;
 }
 
+/**
+ * intel_guc_ct_send_batch - send several H2G messages at once
+ * @ct: pointer to CT
+ * @msgs: array of messages to send, in order
+ * @count: number of messages in @msgs
+ *
+ * Writes all of @msgs back to back into the H2G buffer as fast requests
+ * (as for INTEL_GUC_CT_SEND_NB) and then publishes them to the GuC with
+ * a single descriptor tail update and a single notification. Space for the
+ * whole batch, including any expected G2H replies, is reserved up front so
+ * either every message is sent or none are.
+ *
+ * Return:
+ * *	0 all messages were sent
+ * *	-EBUSY not enough space for the whole batch right now, retry
+ * *	-E2BIG the batch is larger than the CT buffers, split it
+ * *	-ENODEV or -EPIPE the CT channel is not usable
+ */
+int intel_guc_ct_send_batch(struct intel_guc_ct *ct,
+			    const struct intel_guc_ct_msg *msgs,
+			    unsigned int count)
+{
+	if (unlikely(!ct->enabled)) {
+		struct intel_guc *guc = ct_to_guc(ct);
+		struct intel_uc *uc = container_of(guc, struct intel_uc, guc);
+
+		WARN(!uc->reset_in_progress, "Unexpected batch send: action=%#x\n",
+		     count ? *msgs[0].action : 0);
+		return -ENODEV;
+	}
+
+	if (unlikely(ct->ctbs.send.broken))
+		return -EPIPE;
+
+	if (!count)
+		return 0;
+
+	return ct_send_batch_nb(ct, msgs, count);
+}
+
 static struct ct_incoming_msg *ct_alloc_msg(u32 num_dwords)
 {
 	struct ct_incoming_msg *msg;
@@ -1392,3 +1510,7 @@ static void ct_dead_ct_worker_func(struct work_struct *w)
 	intel_klog_error_capture(guc_to_gt(guc), (intel_engine_mask_t)~0U);
 }
 #endif
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#include "selftest_guc_ct.c"
+#endif
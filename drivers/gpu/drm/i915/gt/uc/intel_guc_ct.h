@@ -122,6 +122,18 @@ static inline bool intel_guc_ct_enabled(struct intel_guc_ct *ct)
 	return ct->enabled;
 }
 
+/**
+ * struct intel_guc_ct_msg - one H2G message of a batch
+ * @action: action code followed by its payload
+ * @len: length of @action in dwords
+ * @g2h_len_dw: length of the expected G2H reply payload in dwords, or 0
+ */
+struct intel_guc_ct_msg {
+	const u32 *action;
+	u32 len;
+	u32 g2h_len_dw;
+};
+
 #define INTEL_GUC_CT_SEND_NB		BIT(31)
 #define INTEL_GUC_CT_SEND_G2H_DW_SHIFT	0
 #define INTEL_GUC_CT_SEND_G2H_DW_MASK	(0xff << INTEL_GUC_CT_SEND_G2H_DW_SHIFT)
@@ -132,6 +144,9 @@ static inline bool intel_guc_ct_enabled(struct intel_guc_ct *ct)
 })
 int intel_guc_ct_send(struct intel_guc_ct *ct, const u32 *action, u32 len,
 		      u32 *response_buf, u32 response_buf_size, u32 flags);
+int intel_guc_ct_send_batch(struct intel_guc_ct *ct,
+			    const struct intel_guc_ct_msg *msgs,
+			    unsigned int count);
 void intel_guc_ct_event_handler(struct intel_guc_ct *ct);
 
 void intel_guc_ct_print_info(struct intel_guc_ct *ct, struct drm_printer *p);
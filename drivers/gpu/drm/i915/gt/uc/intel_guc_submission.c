@@ -1051,6 +1051,8 @@ static void guc_submission_tasklet(struct tasklet_struct *t)
 	unsigned long flags;
 	bool loop;
 
+	i915_sched_engine_flush_boosts(sched_engine);
+
 	spin_lock_irqsave(&sched_engine->lock, flags);
 
 	do {
@@ -2089,6 +2091,8 @@ static void fini_tlb_lookup(struct intel_guc *guc)
 	xa_destroy(&guc->tlb_lookup);
 }
 
+static int guc_register_batch_init(struct intel_guc *guc);
+
 /*
  * Set up the memory resources to be shared with the GuC (via the GGTT)
  * at firmware loading time.
@@ -2118,12 +2122,18 @@ int intel_guc_submission_init(struct intel_guc *guc)
 		goto destroy_tlb;
 	}
 
+	ret = guc_register_batch_init(guc);
+	if (ret)
+		goto destroy_bitmap;
+
 	guc->timestamp.ping_delay = (POLL_TIME_CLKS / gt->clock_frequency + 1) * HZ;
 	guc->timestamp.shift = gpm_timestamp_shift(gt);
 	guc->submission_initialized = true;
 
 	return 0;
 
+destroy_bitmap:
+	bitmap_free(guc->submission_state.guc_ids_bitmap);
 destroy_tlb:
 	fini_tlb_lookup(guc);
 destroy_pool:
@@ -2140,6 +2150,8 @@ void intel_guc_submission_fini(struct intel_guc *guc)
 	guc_lrc_desc_pool_destroy_v69(guc);
 	i915_sched_engine_put(guc->sched_engine);
 	bitmap_free(guc->submission_state.guc_ids_bitmap);
+	kfree(guc->submission_state.register_batch);
+	guc->submission_state.register_batch = NULL;
 	fini_tlb_lookup(guc);
 	guc->submission_initialized = false;
 }
@@ -2425,19 +2437,106 @@ static int __guc_action_register_multi_lrc_v69(struct intel_guc *guc,
 	return guc_submission_send_busy_loop(guc, action, len, 0, loop);
 }
 
-static int __guc_action_register_multi_lrc_v70(struct intel_guc *guc,
-					       struct intel_context *ce,
-					       struct guc_ctxt_registration_info *info,
-					       bool loop)
+static int __guc_action_register_context_v69(struct intel_guc *guc,
+					     u32 guc_id,
+					     u32 offset,
+					     bool loop)
+{
+	u32 action[] = {
+		INTEL_GUC_ACTION_REGISTER_CONTEXT,
+		guc_id,
+		offset,
+	};
+
+	return guc_submission_send_busy_loop(guc, action, ARRAY_SIZE(action),
+					     0, loop);
+}
+
+struct context_policy {
+	u32 count;
+	struct guc_update_context_policy h2g;
+};
+
+static u32 __guc_context_policy_action_size(struct context_policy *policy)
+{
+	size_t bytes = sizeof(policy->h2g.header) +
+		       (sizeof(policy->h2g.klv[0]) * policy->count);
+
+	return bytes / sizeof(u32);
+}
+
+static void __guc_context_policy_start_klv(struct context_policy *policy, u16 guc_id)
+{
+	policy->h2g.header.action = INTEL_GUC_ACTION_HOST2GUC_UPDATE_CONTEXT_POLICIES;
+	policy->h2g.header.ctx_id = guc_id;
+	policy->count = 0;
+}
+
+#define MAKE_CONTEXT_POLICY_ADD(func, id) \
+static void __guc_context_policy_add_##func(struct context_policy *policy, u32 data) \
+{ \
+	GEM_BUG_ON(policy->count >= GUC_CONTEXT_POLICIES_KLV_NUM_IDS); \
+	policy->h2g.klv[policy->count].kl = \
+		FIELD_PREP(GUC_KLV_0_KEY, GUC_CONTEXT_POLICIES_KLV_ID_##id) | \
+		FIELD_PREP(GUC_KLV_0_LEN, 1); \
+	policy->h2g.klv[policy->count].value = data; \
+	policy->count++; \
+}
+
+MAKE_CONTEXT_POLICY_ADD(execution_quantum, EXECUTION_QUANTUM)
+MAKE_CONTEXT_POLICY_ADD(preemption_timeout, PREEMPTION_TIMEOUT)
+MAKE_CONTEXT_POLICY_ADD(priority, SCHEDULING_PRIORITY)
+MAKE_CONTEXT_POLICY_ADD(preempt_to_idle, PREEMPT_TO_IDLE_ON_QUANTUM_EXPIRY)
+
+#undef MAKE_CONTEXT_POLICY_ADD
+
+static int __guc_context_set_context_policies(struct intel_guc *guc,
+					      struct context_policy *policy,
+					      bool loop)
+{
+	return guc_submission_send_busy_loop(guc, (u32 *)&policy->h2g,
+					__guc_context_policy_action_size(policy),
+					0, loop);
+}
+
+static void guc_context_policy_prepare_v70(struct intel_context *ce,
+					   struct context_policy *policy)
+{
+	struct intel_engine_cs *engine = ce->engine;
+	u32 execution_quantum;
+	u32 preemption_timeout;
+
+	/* NB: For both of these, zero means disabled. */
+	GEM_BUG_ON(overflows_type(engine->props.timeslice_duration_ms * 1000,
+				  execution_quantum));
+	GEM_BUG_ON(overflows_type(engine->props.preempt_timeout_ms * 1000,
+				  preemption_timeout));
+	execution_quantum = engine->props.timeslice_duration_ms * 1000;
+	preemption_timeout = engine->props.preempt_timeout_ms * 1000;
+
+	__guc_context_policy_start_klv(policy, ce->guc_id.id);
+
+	__guc_context_policy_add_priority(policy, ce->guc_state.prio);
+	__guc_context_policy_add_execution_quantum(policy, execution_quantum);
+	__guc_context_policy_add_preemption_timeout(policy, preemption_timeout);
+
+	if (engine->flags & I915_ENGINE_WANT_FORCED_PREEMPTION)
+		__guc_context_policy_add_preempt_to_idle(policy, 1);
+}
+
+static u32 __guc_register_context_action_v70(struct intel_context *ce,
+					     const struct guc_ctxt_registration_info *info,
+					     u32 *action)
 {
 	struct intel_context *child;
-	u32 action[13 + (MAX_ENGINE_INSTANCE * 2)];
-	int len = 0;
+	u32 len = 0;
 	u32 next_id;
 
 	GEM_BUG_ON(ce->parallel.number_children > MAX_ENGINE_INSTANCE);
 
-	action[len++] = INTEL_GUC_ACTION_REGISTER_CONTEXT_MULTI_LRC;
+	action[len++] = intel_context_is_parent(ce) ?
+		INTEL_GUC_ACTION_REGISTER_CONTEXT_MULTI_LRC :
+		INTEL_GUC_ACTION_REGISTER_CONTEXT;
 	action[len++] = info->flags;
 	action[len++] = info->context_idx;
 	action[len++] = info->engine_class;
@@ -2447,7 +2546,8 @@ static int __guc_action_register_multi_lrc_v70(struct intel_guc *guc,
 	action[len++] = info->wq_base_lo;
 	action[len++] = info->wq_base_hi;
 	action[len++] = info->wq_size;
-	action[len++] = ce->parallel.number_children + 1;
+	if (intel_context_is_parent(ce))
+		action[len++] = ce->parallel.number_children + 1;
 	action[len++] = info->hwlrca_lo;
 	action[len++] = info->hwlrca_hi;
 
@@ -2463,52 +2563,44 @@ static int __guc_action_register_multi_lrc_v70(struct intel_guc *guc,
 		action[len++] = upper_32_bits(child->lrc.lrca);
 	}
 
-	GEM_BUG_ON(len > ARRAY_SIZE(action));
-
-	return guc_submission_send_busy_loop(guc, action, len, 0, loop);
+	return len;
 }
 
-static int __guc_action_register_context_v69(struct intel_guc *guc,
-					     u32 guc_id,
-					     u32 offset,
-					     bool loop)
-{
-	u32 action[] = {
-		INTEL_GUC_ACTION_REGISTER_CONTEXT,
-		guc_id,
-		offset,
-	};
+static void prepare_context_registration_info_v69(struct intel_context *ce);
+static void prepare_context_registration_info_v70(struct intel_context *ce,
+						  struct guc_ctxt_registration_info *info);
 
-	return guc_submission_send_busy_loop(guc, action, ARRAY_SIZE(action),
-					     0, loop);
-}
+#define GUC_REGISTER_CONTEXT_LEN_V70	(13 + (MAX_ENGINE_INSTANCE * 2))
 
-static int __guc_action_register_context_v70(struct intel_guc *guc,
-					     struct guc_ctxt_registration_info *info,
-					     bool loop)
+/*
+ * Contexts re-registered per H2G batch after a reset. Even for parallel
+ * contexts, the registrations and policies of a batch fit into the CT
+ * buffer several times over.
+ */
+#define GUC_REGISTER_BATCH_SIZE		8
+
+struct guc_register_batch {
+	struct intel_context *ce[GUC_REGISTER_BATCH_SIZE];
+	u32 action[GUC_REGISTER_BATCH_SIZE][GUC_REGISTER_CONTEXT_LEN_V70];
+	struct context_policy policy[GUC_REGISTER_BATCH_SIZE];
+	struct intel_guc_ct_msg msgs[2 * GUC_REGISTER_BATCH_SIZE];
+	unsigned int count;
+};
+
+static int guc_register_batch_init(struct intel_guc *guc)
 {
-	u32 action[] = {
-		INTEL_GUC_ACTION_REGISTER_CONTEXT,
-		info->flags,
-		info->context_idx,
-		info->engine_class,
-		info->engine_submit_mask,
-		info->wq_desc_lo,
-		info->wq_desc_hi,
-		info->wq_base_lo,
-		info->wq_base_hi,
-		info->wq_size,
-		info->hwlrca_lo,
-		info->hwlrca_hi,
-	};
+	/* Allocated up front, as it is used from the reset path */
+	if (GUC_SUBMIT_VER(guc) < MAKE_GUC_VER(1, 0, 0))
+		return 0;
 
-	return guc_submission_send_busy_loop(guc, action, ARRAY_SIZE(action),
-					     0, loop);
-}
+	guc->submission_state.register_batch =
+		kzalloc(sizeof(*guc->submission_state.register_batch),
+			GFP_KERNEL);
+	if (!guc->submission_state.register_batch)
+		return -ENOMEM;
 
-static void prepare_context_registration_info_v69(struct intel_context *ce);
-static void prepare_context_registration_info_v70(struct intel_context *ce,
-						  struct guc_ctxt_registration_info *info);
+	return 0;
+}
 
 static int
 register_context_v69(struct intel_guc *guc, struct intel_context *ce, bool loop)
@@ -2526,17 +2618,53 @@ register_context_v69(struct intel_guc *guc, struct intel_context *ce, bool loop)
 							 offset, loop);
 }
 
-static int
-register_context_v70(struct intel_guc *guc, struct intel_context *ce, bool loop)
+static void
+register_context_prepare_v70(struct intel_context *ce, u32 *action,
+			     struct context_policy *policy,
+			     struct intel_guc_ct_msg *msgs)
 {
 	struct guc_ctxt_registration_info info;
 
 	prepare_context_registration_info_v70(ce, &info);
 
-	if (intel_context_is_parent(ce))
-		return __guc_action_register_multi_lrc_v70(guc, ce, &info, loop);
-	else
-		return __guc_action_register_context_v70(guc, &info, loop);
+	msgs[0].action = action;
+	msgs[0].len = __guc_register_context_action_v70(ce, &info, action);
+	msgs[0].g2h_len_dw = 0;
+	GEM_BUG_ON(msgs[0].len > GUC_REGISTER_CONTEXT_LEN_V70);
+
+	/*
+	 * Send the initial scheduling policies together with the
+	 * registration, so that both are published to the GuC at once.
+	 */
+	guc_context_policy_prepare_v70(ce, policy);
+	msgs[1].action = (u32 *)&policy->h2g;
+	msgs[1].len = __guc_context_policy_action_size(policy);
+	msgs[1].g2h_len_dw = 0;
+}
+
+static int
+register_context_v70(struct intel_guc *guc, struct intel_context *ce, bool loop)
+{
+	u32 action[GUC_REGISTER_CONTEXT_LEN_V70];
+	struct context_policy policy;
+	struct intel_guc_ct_msg msgs[2];
+
+	register_context_prepare_v70(ce, action, &policy, msgs);
+
+	return intel_guc_send_batch_busy_loop(guc, msgs, ARRAY_SIZE(msgs), loop);
+}
+
+static void mark_context_registered(struct intel_guc *guc,
+				    struct intel_context *ce)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&ce->guc_state.lock, flags);
+	set_context_registered(ce);
+	/* v70 sends the policies in the same batch as the registration */
+	if (GUC_SUBMIT_VER(guc) >= MAKE_GUC_VER(1, 0, 0))
+		clr_context_policy_required(ce);
+	spin_unlock_irqrestore(&ce->guc_state.lock, flags);
 }
 
 static int register_context(struct intel_context *ce, bool loop)
@@ -2552,16 +2680,8 @@ static int register_context(struct intel_context *ce, bool loop)
 	else
 		ret = register_context_v69(guc, ce, loop);
 
-	if (likely(!ret)) {
-		unsigned long flags;
-
-		spin_lock_irqsave(&ce->guc_state.lock, flags);
-		set_context_registered(ce);
-		spin_unlock_irqrestore(&ce->guc_state.lock, flags);
-
-		if (GUC_SUBMIT_VER(guc) >= MAKE_GUC_VER(1, 0, 0))
-			guc_context_policy_init_v70(ce, loop);
-	}
+	if (likely(!ret))
+		mark_context_registered(guc, ce);
 
 	return ret;
 }
@@ -2610,80 +2730,14 @@ static inline u32 get_children_join_value(struct intel_context *ce,
 	return __get_parent_scratch(ce)->join[child_index].semaphore;
 }
 
-struct context_policy {
-	u32 count;
-	struct guc_update_context_policy h2g;
-};
-
-static u32 __guc_context_policy_action_size(struct context_policy *policy)
-{
-	size_t bytes = sizeof(policy->h2g.header) +
-		       (sizeof(policy->h2g.klv[0]) * policy->count);
-
-	return bytes / sizeof(u32);
-}
-
-static void __guc_context_policy_start_klv(struct context_policy *policy, u16 guc_id)
-{
-	policy->h2g.header.action = INTEL_GUC_ACTION_HOST2GUC_UPDATE_CONTEXT_POLICIES;
-	policy->h2g.header.ctx_id = guc_id;
-	policy->count = 0;
-}
-
-#define MAKE_CONTEXT_POLICY_ADD(func, id) \
-static void __guc_context_policy_add_##func(struct context_policy *policy, u32 data) \
-{ \
-	GEM_BUG_ON(policy->count >= GUC_CONTEXT_POLICIES_KLV_NUM_IDS); \
-	policy->h2g.klv[policy->count].kl = \
-		FIELD_PREP(GUC_KLV_0_KEY, GUC_CONTEXT_POLICIES_KLV_ID_##id) | \
-		FIELD_PREP(GUC_KLV_0_LEN, 1); \
-	policy->h2g.klv[policy->count].value = data; \
-	policy->count++; \
-}
-
-MAKE_CONTEXT_POLICY_ADD(execution_quantum, EXECUTION_QUANTUM)
-MAKE_CONTEXT_POLICY_ADD(preemption_timeout, PREEMPTION_TIMEOUT)
-MAKE_CONTEXT_POLICY_ADD(priority, SCHEDULING_PRIORITY)
-MAKE_CONTEXT_POLICY_ADD(preempt_to_idle, PREEMPT_TO_IDLE_ON_QUANTUM_EXPIRY)
-
-#undef MAKE_CONTEXT_POLICY_ADD
-
-static int __guc_context_set_context_policies(struct intel_guc *guc,
-					      struct context_policy *policy,
-					      bool loop)
-{
-	return guc_submission_send_busy_loop(guc, (u32 *)&policy->h2g,
-					__guc_context_policy_action_size(policy),
-					0, loop);
-}
-
 static int guc_context_policy_init_v70(struct intel_context *ce, bool loop)
 {
-	struct intel_engine_cs *engine = ce->engine;
-	struct intel_guc *guc = &engine->gt->uc.guc;
+	struct intel_guc *guc = ce_to_guc(ce);
 	struct context_policy policy;
-	u32 execution_quantum;
-	u32 preemption_timeout;
 	unsigned long flags;
 	int ret;
 
-	/* NB: For both of these, zero means disabled. */
-	GEM_BUG_ON(overflows_type(engine->props.timeslice_duration_ms * 1000,
-				  execution_quantum));
-	GEM_BUG_ON(overflows_type(engine->props.preempt_timeout_ms * 1000,
-				  preemption_timeout));
-	execution_quantum = engine->props.timeslice_duration_ms * 1000;
-	preemption_timeout = engine->props.preempt_timeout_ms * 1000;
-
-	__guc_context_policy_start_klv(&policy, ce->guc_id.id);
-
-	__guc_context_policy_add_priority(&policy, ce->guc_state.prio);
-	__guc_context_policy_add_execution_quantum(&policy, execution_quantum);
-	__guc_context_policy_add_preemption_timeout(&policy, preemption_timeout);
-
-	if (engine->flags & I915_ENGINE_WANT_FORCED_PREEMPTION)
-		__guc_context_policy_add_preempt_to_idle(&policy, 1);
-
+	guc_context_policy_prepare_v70(ce, &policy);
 	ret = __guc_context_set_context_policies(guc, &policy, loop);
 
 	spin_lock_irqsave(&ce->guc_state.lock, flags);
@@ -4403,8 +4457,85 @@ static inline int guc_kernel_context_pin(struct intel_guc *guc,
 	return ret;
 }
 
+static int guc_register_batch_flush(struct intel_guc *guc,
+				    struct guc_register_batch *batch)
+{
+	struct intel_runtime_pm *runtime_pm = guc_to_gt(guc)->uncore->rpm;
+	intel_wakeref_t wakeref;
+	unsigned int i;
+	int ret = 0;
+
+	if (!batch->count)
+		return 0;
+
+	with_intel_runtime_pm(runtime_pm, wakeref)
+		ret = intel_guc_send_batch_busy_loop(guc, batch->msgs,
+						     2 * batch->count, true);
+
+	for (i = 0; i < batch->count; i++) {
+		struct intel_context *ce = batch->ce[i];
+
+		if (likely(!ret)) {
+			mark_context_registered(guc, ce);
+			continue;
+		}
+
+		clr_ctx_id_mapping(guc, ce->guc_id.id);
+		if (ret != -ENODEV)
+			unpin_guc_id(guc, ce);
+	}
+	batch->count = 0;
+
+	return ret == -ENODEV ? 0 : ret; /* -ENODEV: will get registered later */
+}
+
+/*
+ * As guc_kernel_context_pin(), but queue the registration into @batch so
+ * that the pinned contexts of all engines are published to the GuC with a
+ * single doorbell per GUC_REGISTER_BATCH_SIZE contexts.
+ */
+static int guc_kernel_context_queue(struct intel_guc *guc,
+				    struct guc_register_batch *batch,
+				    struct intel_context *ce)
+{
+	unsigned int i;
+	int ret;
+
+	if (batch->count == GUC_REGISTER_BATCH_SIZE) {
+		ret = guc_register_batch_flush(guc, batch);
+		if (ret)
+			return ret;
+	}
+
+	if (context_guc_id_invalid(ce)) {
+		ret = pin_guc_id(guc, ce);
+
+		if (ret < 0)
+			return ret;
+	}
+
+	if (!test_bit(CONTEXT_GUC_INIT, &ce->flags))
+		guc_context_init(ce);
+
+	GEM_BUG_ON(!sched_state_is_init(ce));
+
+	/* The lookup was just emptied, there is no guc_id to steal back */
+	GEM_BUG_ON(ctx_id_mapped(guc, ce->guc_id.id));
+	set_ctx_id_mapping(guc, ce->guc_id.id, ce);
+
+	trace_intel_context_register(ce);
+
+	i = batch->count++;
+	batch->ce[i] = ce;
+	register_context_prepare_v70(ce, batch->action[i], &batch->policy[i],
+				     &batch->msgs[2 * i]);
+
+	return 0;
+}
+
 static inline int guc_init_submission(struct intel_guc *guc)
 {
+	struct guc_register_batch *batch = guc->submission_state.register_batch;
 	struct intel_gt *gt = guc_to_gt(guc);
 	struct intel_engine_cs *engine;
 	enum intel_engine_id id;
@@ -4419,6 +4550,10 @@ static inline int guc_init_submission(struct intel_guc *guc)
 	guc->stalled_request = NULL;
 	guc->submission_stall_reason = STALL_NONE;
 
+	/* Forget anything left queued by a previous, failed, attempt */
+	if (batch)
+		batch->count = 0;
+
 	/*
 	 * Some contexts might have been pinned before we enabled GuC
 	 * submission, so we need to add them to the GuC bookeeping.
@@ -4431,8 +4566,12 @@ static inline int guc_init_submission(struct intel_guc *guc)
 
 		list_for_each_entry(ce, &engine->pinned_contexts_list,
 				    pinned_contexts_link) {
-			int ret = guc_kernel_context_pin(guc, ce);
+			int ret;
 
+			if (batch)
+				ret = guc_kernel_context_queue(guc, batch, ce);
+			else
+				ret = guc_kernel_context_pin(guc, ce);
 			if (ret) {
 				/* No point in trying to clean up as i915 will wedge on failure */
 				return ret;
@@ -4440,7 +4579,7 @@ static inline int guc_init_submission(struct intel_guc *guc)
 		}
 	}
 
-	return 0;
+	return batch ? guc_register_batch_flush(guc, batch) : 0;
 }
 
 static void guc_release(struct intel_engine_cs *engine)
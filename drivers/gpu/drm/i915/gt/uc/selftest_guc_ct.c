@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "gem/i915_gem_internal.h"
+
+#include "i915_selftest.h"
+#include "selftests/mock_gem_device.h"
+
+#define MOCK_CT_MSG_LEN 3
+
+/*
+ * A software stand-in for the GuC, owning the far side of a CT channel that
+ * is backed by plain kernel memory. It consumes H2G messages, checking that
+ * they arrive intact and in order, and advances the descriptor head.
+ */
+struct mock_guc {
+	struct intel_guc_ct *ct;
+	struct drm_i915_gem_object *obj;
+	void *blob;
+	unsigned long consumed;
+	u32 seqno;
+	u16 fence;
+};
+
+static int mock_guc_init(struct mock_guc *m, struct drm_i915_private *i915)
+{
+	const u32 blob_size =
+		2 * CTB_DESC_SIZE + CTB_H2G_BUFFER_SIZE + CTB_G2H_BUFFER_SIZE;
+	struct intel_guc_ct *ct = &to_gt(i915)->uc.guc.ct;
+	struct i915_vma *vma;
+
+	memset(m, 0, sizeof(*m));
+	m->ct = ct;
+
+	/* The write barrier only inspects where the CT blob lives */
+	m->obj = i915_gem_object_create_internal(i915, PAGE_SIZE);
+	if (IS_ERR(m->obj))
+		return PTR_ERR(m->obj);
+
+	vma = i915_vma_instance(m->obj, &to_gt(i915)->ggtt->vm, NULL);
+	if (IS_ERR(vma)) {
+		i915_gem_object_put(m->obj);
+		return PTR_ERR(vma);
+	}
+
+	m->blob = kzalloc(blob_size, GFP_KERNEL);
+	if (!m->blob) {
+		i915_gem_object_put(m->obj);
+		return -ENOMEM;
+	}
+
+	GEM_BUG_ON(ct->vma);
+	ct->vma = vma;
+	guc_ct_buffer_init(&ct->ctbs.send, m->blob,
+			   m->blob + 2 * CTB_DESC_SIZE,
+			   CTB_H2G_BUFFER_SIZE, 0);
+	guc_ct_buffer_init(&ct->ctbs.recv, m->blob + CTB_DESC_SIZE,
+			   m->blob + 2 * CTB_DESC_SIZE + CTB_H2G_BUFFER_SIZE,
+			   CTB_G2H_BUFFER_SIZE, G2H_ROOM_BUFFER_SIZE);
+	ct->requests.last_fence = 0;
+	ct->stall_time = KTIME_MAX;
+	ct->enabled = true;
+
+	return 0;
+}
+
+static void mock_guc_fini(struct mock_guc *m)
+{
+	m->ct->enabled = false;
+	m->ct->vma = NULL;
+	m->ct->ctbs.send.desc = NULL;
+	m->ct->ctbs.recv.desc = NULL;
+
+	kfree(m->blob);
+	i915_gem_object_put(m->obj);
+}
+
+static int mock_guc_consume(struct mock_guc *m)
+{
+	struct intel_guc_ct_buffer *ctb = &m->ct->ctbs.send;
+	struct guc_ct_buffer_desc *desc = ctb->desc;
+	u32 tail = READ_ONCE(desc->tail);
+	u32 head = desc->head;
+
+	while (head != tail) {
+		u32 header = ctb->cmds[head];
+		u32 hxg = ctb->cmds[(head + 1) % ctb->size];
+		u32 seqno = ctb->cmds[(head + 2) % ctb->size];
+		u32 len = FIELD_GET(GUC_CTB_MSG_0_NUM_DWORDS, header);
+
+		if (len != MOCK_CT_MSG_LEN ||
+		    FIELD_GET(GUC_CTB_MSG_0_FENCE, header) != ++m->fence ||
+		    FIELD_GET(GUC_HXG_MSG_0_TYPE, hxg) != GUC_HXG_TYPE_FAST_REQUEST ||
+		    seqno != m->seqno) {
+			pr_err("Unexpected H2G at head %u: header=%08x hxg=%08x seqno=%u, expected fence %u seqno %u\n",
+			       head, header, hxg, seqno, m->fence, m->seqno);
+			return -EINVAL;
+		}
+
+		head = (head + len + GUC_CTB_HDR_LEN) % ctb->size;
+		m->consumed++;
+		m->seqno++;
+	}
+
+	WRITE_ONCE(desc->head, head);
+	return 0;
+}
+
+static void fill_msgs(struct intel_guc_ct_msg *msgs, u32 *action,
+		      unsigned int count, u32 seqno, u32 g2h_len_dw)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		u32 *cs = &action[i * MOCK_CT_MSG_LEN];
+
+		cs[0] = INTEL_GUC_ACTION_SCHED_CONTEXT_MODE_SET;
+		cs[1] = seqno + i;
+		cs[2] = GUC_CONTEXT_ENABLE;
+
+		msgs[i].action = cs;
+		msgs[i].len = MOCK_CT_MSG_LEN;
+		msgs[i].g2h_len_dw = g2h_len_dw;
+	}
+}
+
+static int igt_ct_send_batch(void *arg)
+{
+	const unsigned int max = (CTB_H2G_BUFFER_SIZE / 4 - 1) /
+		(MOCK_CT_MSG_LEN + GUC_CTB_HDR_LEN);
+	struct drm_i915_private *i915 = arg;
+	struct intel_guc_ct_msg *msgs;
+	struct intel_guc_ct_buffer *ctb;
+	struct mock_guc m;
+	unsigned int n;
+	u32 seqno = 0;
+	u32 *action;
+	int space;
+	u32 tail;
+	int err;
+
+	/*
+	 * A batch is all or nothing: it is either written in full and
+	 * published with a single tail update, or not at all. Messages must
+	 * arrive in order with consecutive fences, also across the wrap.
+	 */
+
+	msgs = kcalloc(2 * max, sizeof(*msgs), GFP_KERNEL);
+	action = kcalloc(2 * max, MOCK_CT_MSG_LEN * sizeof(*action), GFP_KERNEL);
+	if (!msgs || !action) {
+		err = -ENOMEM;
+		goto out_free;
+	}
+
+	err = mock_guc_init(&m, i915);
+	if (err)
+		goto out_free;
+
+	ctb = &m.ct->ctbs.send;
+
+	for (n = 1; n <= 2 * max; n = n * 2 + 1) {
+		fill_msgs(msgs, action, min(n, max), seqno, 0);
+		err = intel_guc_ct_send_batch(m.ct, msgs, min(n, max));
+		if (err) {
+			pr_err("Batch of %u failed, err=%d\n", min(n, max), err);
+			goto out;
+		}
+		seqno += min(n, max);
+
+		err = mock_guc_consume(&m);
+		if (err)
+			goto out;
+	}
+
+	fill_msgs(msgs, action, 2 * max, seqno, 0);
+	err = intel_guc_ct_send_batch(m.ct, msgs, 2 * max);
+	if (err != -E2BIG) {
+		pr_err("Oversized batch not rejected, err=%d\n", err);
+		err = -EINVAL;
+		goto out;
+	}
+
+	/* Fill all but one slot, then a batch of two must not fit */
+	fill_msgs(msgs, action, max - 1, seqno, 0);
+	err = intel_guc_ct_send_batch(m.ct, msgs, max - 1);
+	if (err)
+		goto out;
+	seqno += max - 1;
+
+	tail = READ_ONCE(ctb->desc->tail);
+	fill_msgs(msgs, action, 2, seqno, 0);
+	err = intel_guc_ct_send_batch(m.ct, msgs, 2);
+	if (err != -EBUSY || READ_ONCE(ctb->desc->tail) != tail) {
+		pr_err("Partial batch written to a full buffer, err=%d\n", err);
+		err = -EINVAL;
+		goto out;
+	}
+
+	err = mock_guc_consume(&m);
+	if (err)
+		goto out;
+
+	/* Expected replies are reserved for the whole batch up front */
+	space = atomic_read(&m.ct->ctbs.recv.space);
+	fill_msgs(msgs, action, 8, seqno, G2H_LEN_DW_SCHED_CONTEXT_MODE_SET);
+	err = intel_guc_ct_send_batch(m.ct, msgs, 8);
+	if (err)
+		goto out;
+	seqno += 8;
+
+	if (space - atomic_read(&m.ct->ctbs.recv.space) !=
+	    8 * (G2H_LEN_DW_SCHED_CONTEXT_MODE_SET + GUC_CTB_HXG_MSG_MIN_LEN)) {
+		pr_err("G2H space not reserved for the batch: before %d, after %d\n",
+		       space, atomic_read(&m.ct->ctbs.recv.space));
+		err = -EINVAL;
+		goto out;
+	}
+	g2h_release_space(m.ct, space - atomic_read(&m.ct->ctbs.recv.space));
+
+	err = mock_guc_consume(&m);
+	if (err)
+		goto out;
+
+	if (m.consumed != seqno) {
+		pr_err("Software GuC consumed %lu messages, expected %u\n",
+		       m.consumed, seqno);
+		err = -EINVAL;
+	}
+
+out:
+	mock_guc_fini(&m);
+out_free:
+	kfree(action);
+	kfree(msgs);
+	return err;
+}
+
+static int __perf_ct_send(struct mock_guc *m,
+			  struct intel_guc_ct_msg *msgs, u32 *action,
+			  unsigned int total, unsigned int batch,
+			  ktime_t *dt)
+{
+	u32 seqno = m->seqno;
+	unsigned int n;
+	int err = 0;
+
+	*dt = ktime_get_raw();
+	for (n = 0; n < total; n += batch) {
+		fill_msgs(msgs, action, batch, seqno, 0);
+		do {
+			if (batch == 1)
+				err = intel_guc_ct_send(m->ct, action,
+							MOCK_CT_MSG_LEN,
+							NULL, 0,
+							MAKE_SEND_FLAGS(0));
+			else
+				err = intel_guc_ct_send_batch(m->ct,
+							      msgs, batch);
+			if (err == -EBUSY && mock_guc_consume(m))
+				return -EINVAL;
+		} while (err == -EBUSY);
+		if (err)
+			return err;
+
+		seqno += batch;
+	}
+	err = mock_guc_consume(m);
+	*dt = ktime_sub(ktime_get_raw(), *dt);
+
+	return err;
+}
+
+static int perf_ct_send_batch(void *arg)
+{
+	static const unsigned int batches[] = { 1, 4, 16, 64 };
+	const unsigned int total = 64 * 1024;
+	struct drm_i915_private *i915 = arg;
+	struct intel_guc_ct_msg *msgs;
+	struct mock_guc m;
+	unsigned int n;
+	u32 *action;
+	int err;
+
+	/*
+	 * Compare sending a burst of H2G one message at a time against
+	 * sending the same burst in batches. Both include the time for the
+	 * software GuC to drain the buffer. Note that the mock doorbell is a
+	 * nop and the barrier a wmb(), so on real HW the saving per coalesced
+	 * tail update and notification is larger.
+	 */
+
+	msgs = kcalloc(batches[ARRAY_SIZE(batches) - 1], sizeof(*msgs),
+		       GFP_KERNEL);
+	action = kcalloc(batches[ARRAY_SIZE(batches) - 1],
+			 MOCK_CT_MSG_LEN * sizeof(*action), GFP_KERNEL);
+	if (!msgs || !action) {
+		err = -ENOMEM;
+		goto out_free;
+	}
+
+	err = mock_guc_init(&m, i915);
+	if (err)
+		goto out_free;
+
+	for (n = 0; n < ARRAY_SIZE(batches); n++) {
+		ktime_t dt;
+		u64 ns;
+
+		err = __perf_ct_send(&m, msgs, action, total, batches[n], &dt);
+		if (err) {
+			pr_err("Failed to send batches of %u, err=%d\n",
+			       batches[n], err);
+			break;
+		}
+
+		ns = ktime_to_ns(dt) + 1;
+		pr_info("%s: %u messages in batches of %u: %llu msgs/s, %lluns/msg, %u doorbells\n",
+			__func__, total, batches[n],
+			div64_u64(mul_u32_u32(total, NSEC_PER_SEC), ns),
+			div_u64(ns, total), total / batches[n]);
+
+		cond_resched();
+	}
+
+	mock_guc_fini(&m);
+out_free:
+	kfree(action);
+	kfree(msgs);
+	return err;
+}
+
+int intel_guc_ct_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_ct_send_batch),
+		SUBTEST(perf_ct_send_batch),
+	};
+	struct drm_i915_private *i915;
+	int err;
+
+	i915 = mock_gem_device();
+	if (!i915)
+		return -ENOMEM;
+
+	err = i915_subtests(tests, i915);
+
+	mock_destroy_device(i915);
+	return err;
+}
@@ -1890,9 +1890,120 @@ static int audit_bb_end(struct parser_exec_state *s, void *va)
 	return -EBADRQC;
 }
 
+/*
+ * Guests tend to resubmit the same privileged batch buffers over and over.
+ * Keep a pristine copy of the last few batches we shadowed, and if the
+ * batch read back from the guest at the same GMA still matches the copy,
+ * reuse its size instead of walking the guest batch command by command.
+ * The comparison on every hit is what makes reuse safe: the batch may have
+ * been rewritten by the guest CPU, the GPU or device DMA alike, and the
+ * GMA may since point at different pages.
+ *
+ * Only the guest copy is reused; the shadow is still scanned in full for
+ * every workload, as the command handlers patch it and record per-workload
+ * state. All of the cache is protected by vgpu_lock.
+ */
+#define GVT_BB_CACHE_MAX_ENTRIES	64
+#define GVT_BB_CACHE_MAX_SIZE		SZ_64K
+
+struct intel_vgpu_bb_cache_entry {
+	struct list_head link;
+	unsigned long gma;
+	bool ppgtt;
+	u32 size;
+	u32 end_cmd_offset;
+	void *image;
+};
+
+static void bb_cache_free(struct intel_vgpu_bb_cache_entry *e)
+{
+	kvfree(e->image);
+	kfree(e);
+}
+
+static void bb_cache_evict(struct intel_vgpu *vgpu,
+			   struct intel_vgpu_bb_cache_entry *e)
+{
+	list_del(&e->link);
+	vgpu->submission.bb_cache_count--;
+
+	bb_cache_free(e);
+}
+
+static struct intel_vgpu_bb_cache_entry *
+bb_cache_lookup(struct parser_exec_state *s, unsigned long gma)
+{
+	struct intel_vgpu *vgpu = s->vgpu;
+	bool ppgtt = s->buf_addr_type != GTT_BUFFER;
+	struct intel_vgpu_bb_cache_entry *e;
+
+	if (unlikely(vgpu->failsafe))
+		return NULL;
+
+	list_for_each_entry(e, &vgpu->submission.bb_cache, link) {
+		if (e->gma != gma || e->ppgtt != ppgtt)
+			continue;
+
+		list_move(&e->link, &vgpu->submission.bb_cache);
+		return e;
+	}
+
+	return NULL;
+}
+
+static void bb_cache_insert(struct parser_exec_state *s, unsigned long gma,
+			    const void *va, unsigned long size,
+			    unsigned long end_cmd_offset)
+{
+	struct intel_vgpu *vgpu = s->vgpu;
+	struct intel_vgpu_submission *ss = &vgpu->submission;
+	struct intel_vgpu_bb_cache_entry *e;
+
+	if (size > GVT_BB_CACHE_MAX_SIZE || unlikely(vgpu->failsafe))
+		return;
+
+	e = kzalloc(sizeof(*e), GFP_KERNEL);
+	if (!e)
+		return;
+
+	e->image = kvmalloc(size, GFP_KERNEL);
+	if (!e->image) {
+		kfree(e);
+		return;
+	}
+	memcpy(e->image, va, size);
+
+	e->gma = gma;
+	e->ppgtt = s->buf_addr_type != GTT_BUFFER;
+	e->size = size;
+	e->end_cmd_offset = end_cmd_offset;
+
+	if (ss->bb_cache_count == GVT_BB_CACHE_MAX_ENTRIES)
+		bb_cache_evict(vgpu, list_last_entry(&ss->bb_cache,
+						     typeof(*e), link));
+
+	list_add(&e->link, &ss->bb_cache);
+	ss->bb_cache_count++;
+}
+
+/**
+ * intel_gvt_bb_cache_flush - drop all cached batch buffers of a vGPU
+ * @vgpu: a vGPU
+ */
+void intel_gvt_bb_cache_flush(struct intel_vgpu *vgpu)
+{
+	struct intel_vgpu_bb_cache_entry *e, *n;
+
+	list_for_each_entry_safe(e, n, &vgpu->submission.bb_cache, link)
+		bb_cache_evict(vgpu, e);
+
+	GEM_BUG_ON(vgpu->submission.bb_cache_count);
+}
+
 static int perform_bb_shadow(struct parser_exec_state *s)
 {
 	struct intel_vgpu *vgpu = s->vgpu;
+	struct intel_vgpu_bb_cache_entry *cached;
 	struct intel_vgpu_shadow_bb *bb;
 	unsigned long gma = 0;
 	unsigned long bb_size;
@@ -1907,9 +2018,16 @@ static int perform_bb_shadow(struct parser_exec_state *s)
 	if (gma == INTEL_GVT_INVALID_ADDR)
 		return -EFAULT;
 
-	ret = find_bb_size(s, &bb_size, &bb_end_cmd_offset);
-	if (ret)
-		return ret;
+	cached = bb_cache_lookup(s, gma);
+retry:
+	if (cached) {
+		bb_size = cached->size;
+		bb_end_cmd_offset = cached->end_cmd_offset;
+	} else {
+		ret = find_bb_size(s, &bb_size, &bb_end_cmd_offset);
+		if (ret)
+			return ret;
+	}
 
 	bb = kzalloc(sizeof(*bb), GFP_KERNEL);
 	if (!bb)
@@ -1954,10 +2072,29 @@ static int perform_bb_shadow(struct parser_exec_state *s)
 		goto err_unmap;
 	}
 
+	/*
+	 * The cached size is only trusted if the contents are unchanged,
+	 * otherwise start over and size the batch from scratch.
+	 */
+	if (cached && memcmp(bb->va + start_offset, cached->image, bb_size)) {
+		bb_cache_evict(vgpu, cached);
+		cached = NULL;
+
+		i915_gem_object_unpin_map(bb->obj);
+		i915_gem_object_put(bb->obj);
+		kfree(bb);
+		goto retry;
+	}
+
 	ret = audit_bb_end(s, bb->va + start_offset + bb_end_cmd_offset);
 	if (ret)
 		goto err_unmap;
 
+	/* Cache the guest copy before the scan starts patching the shadow */
+	if (!cached)
+		bb_cache_insert(s, gma, bb->va + start_offset,
+				bb_size, bb_end_cmd_offset);
+
 	i915_gem_object_unlock(bb->obj);
 	INIT_LIST_HEAD(&bb->list);
 	list_add(&bb->list, &s->workload->shadow_bb);
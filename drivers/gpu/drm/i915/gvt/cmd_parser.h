@@ -55,4 +55,6 @@ void intel_gvt_update_reg_whitelist(struct intel_vgpu *vgpu);
 
 int intel_gvt_scan_engine_context(struct intel_vgpu_workload *workload);
 
+void intel_gvt_bb_cache_flush(struct intel_vgpu *vgpu);
+
 #endif
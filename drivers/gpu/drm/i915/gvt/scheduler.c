@@ -1322,6 +1322,7 @@ void intel_vgpu_clean_submission(struct intel_vgpu *vgpu)
 	enum intel_engine_id id;
 
 	intel_vgpu_select_submission_ops(vgpu, ALL_ENGINES, 0);
+	intel_gvt_bb_cache_flush(vgpu);
 
 	i915_context_ppgtt_root_restore(s, i915_vm_to_ppgtt(s->shadow[0]->vm));
 	for_each_engine(engine, vgpu->gvt->gt, id)
@@ -1348,6 +1349,7 @@ void intel_vgpu_reset_submission(struct intel_vgpu *vgpu,
 		return;
 
 	intel_vgpu_clean_workloads(vgpu, engine_mask);
+	intel_gvt_bb_cache_flush(vgpu);
 	s->ops->reset(vgpu, engine_mask);
 }
 
@@ -1436,6 +1438,9 @@ int intel_vgpu_setup_submission(struct intel_vgpu *vgpu)
 
 	memset(s->last_ctx, 0, sizeof(s->last_ctx));
 
+	INIT_LIST_HEAD(&s->bb_cache);
+	s->bb_cache_count = 0;
+
 	i915_vm_put(&ppgtt->vm);
 	return 0;
 
@@ -27,7 +27,12 @@
 
 #include <linux/highmem.h>
 
+#include <asm/unaligned.h>
+
+#include <crypto/sha2.h>
+
 #include <drm/drm_cache.h>
+#include <drm/drm_print.h>
 
 #include "gt/intel_engine.h"
 #include "gt/intel_engine_regs.h"
@@ -944,6 +949,167 @@ static void fini_hash_table(struct intel_engine_cs *engine)
 	}
 }
 
+/*
+ * Validated batch cache
+ *
+ * Userspace frequently resubmits byte-identical batches. Once a batch has
+ * been copied into the shadow, we hash the copy (i.e. exactly what is going
+ * to be executed, out of reach of userspace) and look it up in a small
+ * per-engine cache of previous verdicts. The scan only depends upon the
+ * contents and length of the batch, with the exception of the terminating
+ * MI_BATCH_BUFFER_START whose target is relative to the batch address. For
+ * that we remember its location along with the jump whitelist, and check
+ * it afresh on every hit.
+ */
+#define CMD_CACHE_ORDER 6
+#define CMD_CACHE_MAX_ENTRIES 64
+#define CMD_CACHE_MAX_LENGTH SZ_256K
+#define CMD_CACHE_NO_BBSTART U32_MAX
+
+struct intel_engine_cmd_cache {
+	struct mutex lock; /* guards ht, lru and count */
+	DECLARE_HASHTABLE(ht, CMD_CACHE_ORDER);
+	struct list_head lru;
+	unsigned int count;
+
+	unsigned long hits;
+	unsigned long misses;
+};
+
+struct cmd_cache_entry {
+	struct hlist_node node;
+	struct list_head link;
+
+	u8 digest[SHA256_DIGEST_SIZE];
+	u32 length;
+	bool trampoline;
+
+	int ret; /* verdict of the scan, up to the terminating BB_START */
+	u32 bbstart; /* dword offset of the terminating BB_START */
+	u32 bbstart_length;
+	unsigned long whitelist[];
+};
+
+static struct intel_engine_cmd_cache *cmd_cache_create(void)
+{
+	struct intel_engine_cmd_cache *cache;
+
+	cache = kzalloc(sizeof(*cache), GFP_KERNEL);
+	if (!cache)
+		return NULL;
+
+	mutex_init(&cache->lock);
+	hash_init(cache->ht);
+	INIT_LIST_HEAD(&cache->lru);
+
+	return cache;
+}
+
+static void cmd_cache_destroy(struct intel_engine_cmd_cache *cache)
+{
+	struct cmd_cache_entry *e, *en;
+
+	if (!cache)
+		return;
+
+	list_for_each_entry_safe(e, en, &cache->lru, link)
+		kfree(e);
+
+	mutex_destroy(&cache->lock);
+	kfree(cache);
+}
+
+static u32 cmd_cache_key(const u8 *digest)
+{
+	return get_unaligned((const u32 *)digest);
+}
+
+static struct cmd_cache_entry *
+cmd_cache_lookup(struct intel_engine_cmd_cache *cache,
+		 const u8 *digest, u32 length, bool trampoline)
+{
+	struct cmd_cache_entry *e;
+
+	lockdep_assert_held(&cache->lock);
+
+	hash_for_each_possible(cache->ht, e, node, cmd_cache_key(digest)) {
+		if (e->length == length &&
+		    e->trampoline == trampoline &&
+		    !memcmp(e->digest, digest, sizeof(e->digest)))
+			return e;
+	}
+
+	return NULL;
+}
+
+static void cmd_cache_insert(struct intel_engine_cmd_cache *cache,
+			     const u8 *digest, u32 length, bool trampoline,
+			     int ret, u32 bbstart, u32 bbstart_length,
+			     const unsigned long *jump_whitelist)
+{
+	unsigned int nbits = 0;
+	struct cmd_cache_entry *e;
+
+	if (bbstart != CMD_CACHE_NO_BBSTART && jump_whitelist)
+		nbits = DIV_ROUND_UP(length, sizeof(u32));
+
+	e = kmalloc(struct_size(e, whitelist, BITS_TO_LONGS(nbits)),
+		    GFP_KERNEL | __GFP_NOWARN);
+	if (!e)
+		return;
+
+	memcpy(e->digest, digest, sizeof(e->digest));
+	e->length = length;
+	e->trampoline = trampoline;
+	e->ret = ret;
+	e->bbstart = bbstart;
+	e->bbstart_length = bbstart_length;
+	if (nbits)
+		bitmap_copy(e->whitelist, jump_whitelist, nbits);
+
+	mutex_lock(&cache->lock);
+	if (cmd_cache_lookup(cache, digest, length, trampoline)) {
+		mutex_unlock(&cache->lock);
+		kfree(e);
+		return;
+	}
+
+	if (cache->count == CMD_CACHE_MAX_ENTRIES) {
+		struct cmd_cache_entry *old;
+
+		old = list_last_entry(&cache->lru, typeof(*old), link);
+		hash_del(&old->node);
+		list_del(&old->link);
+		kfree(old);
+		cache->count--;
+	}
+
+	hash_add(cache->ht, &e->node, cmd_cache_key(digest));
+	list_add(&e->link, &cache->lru);
+	cache->count++;
+	mutex_unlock(&cache->lock);
+}
+
+/**
+ * intel_engine_cmd_parser_dump_cache() - report the validated batch cache
+ * @engine: the engine whose command parser cache to report
+ * @p: where to print
+ */
+void intel_engine_cmd_parser_dump_cache(struct intel_engine_cs *engine,
+					struct drm_printer *p)
+{
+	struct intel_engine_cmd_cache *cache = engine->cmd_cache;
+
+	if (!cache)
+		return;
+
+	mutex_lock(&cache->lock);
+	drm_printf(p, "%s: %u/%u batches cached, %lu hits, %lu misses\n",
+		   engine->name, cache->count, CMD_CACHE_MAX_ENTRIES,
+		   cache->hits, cache->misses);
+	mutex_unlock(&cache->lock);
+}
+
 /**
  * intel_engine_init_cmd_parser() - set cmd parser related fields for an engine
  * @engine: the engine to initialize
@@ -1050,6 +1216,9 @@ int intel_engine_init_cmd_parser(struct intel_engine_cs *engine)
 
 	engine->flags |= I915_ENGINE_USING_CMD_PARSER;
 
+	/* The cache is only an optimisation, carry on without it */
+	engine->cmd_cache = cmd_cache_create();
+
 out:
 	if (intel_engine_requires_cmd_parser(engine) &&
 	    !intel_engine_using_cmd_parser(engine))
@@ -1070,6 +1239,7 @@ void intel_engine_cleanup_cmd_parser(struct intel_engine_cs *engine)
 	if (!intel_engine_using_cmd_parser(engine))
 		return;
 
+	cmd_cache_destroy(fetch_and_zero(&engine->cmd_cache));
 	fini_hash_table(engine);
 }
 
@@ -1421,58 +1591,14 @@ static unsigned long *alloc_whitelist(u32 batch_length)
 
 #define LENGTH_BIAS 2
 
-/**
- * intel_engine_cmd_parser() - parse a batch buffer for privilege violations
- * @engine: the engine on which the batch is to execute
- * @batch: the batch buffer in question
- * @batch_offset: byte offset in the batch at which execution starts
- * @batch_length: length of the commands in batch_obj
- * @shadow: validated copy of the batch buffer in question
- * @trampoline: true if we need to trampoline into privileged execution
- *
- * Parses the specified batch buffer looking for privilege violations as
- * described in the overview.
- *
- * Return: non-zero if the parser finds violations or otherwise fails; -EACCES
- * if the batch appears legal but should use hardware parsing
- */
-
-int intel_engine_cmd_parser(struct intel_engine_cs *engine,
-			    struct i915_vma *batch,
-			    unsigned long batch_offset,
-			    unsigned long batch_length,
-			    struct i915_vma *shadow,
-			    bool trampoline)
+static int scan_batch(struct intel_engine_cs *engine,
+		      u32 *cmd, u32 batch_length,
+		      unsigned long *jump_whitelist,
+		      u32 *bbstart, u32 *bbstart_length)
 {
-	u32 *cmd, *batch_end, offset = 0;
 	struct drm_i915_cmd_descriptor default_desc = noop_desc;
 	const struct drm_i915_cmd_descriptor *desc = &default_desc;
-	bool needs_clflush_after = false;
-	unsigned long *jump_whitelist;
-	u64 batch_addr, shadow_addr;
-	int ret = 0;
-
-	GEM_BUG_ON(!IS_ALIGNED(batch_offset, sizeof(*cmd)));
-	GEM_BUG_ON(!IS_ALIGNED(batch_length, sizeof(*cmd)));
-	GEM_BUG_ON(range_overflows_t(u64, batch_offset, batch_length,
-				     batch->size));
-	GEM_BUG_ON(!batch_length);
-
-	cmd = copy_batch(shadow->obj, batch->obj,
-			 batch_offset, batch_length,
-			 &needs_clflush_after);
-	if (IS_ERR(cmd)) {
-		DRM_DEBUG("CMD: Failed to copy batch\n");
-		return PTR_ERR(cmd);
-	}
-
-	jump_whitelist = NULL;
-	if (!trampoline)
-		/* Defer failure until attempted use */
-		jump_whitelist = alloc_whitelist(batch_length);
-
-	shadow_addr = gen8_canonical_addr(i915_vma_offset(shadow));
-	batch_addr = gen8_canonical_addr(i915_vma_offset(batch) + batch_offset);
+	u32 *batch_end, offset = 0;
 
 	/*
 	 * We use the batch length as size because the shadow object is as
@@ -1484,13 +1610,12 @@ int intel_engine_cmd_parser(struct intel_engine_cs *engine,
 		u32 length;
 
 		if (*cmd == MI_BATCH_BUFFER_END)
-			break;
+			return 0;
 
 		desc = find_cmd(engine, *cmd, desc, &default_desc);
 		if (!desc) {
 			DRM_DEBUG("CMD: Unrecognized command: 0x%08X\n", *cmd);
-			ret = -EINVAL;
-			break;
+			return -EINVAL;
 		}
 
 		if (desc->flags & CMD_DESC_FIXED)
@@ -1503,20 +1628,17 @@ int intel_engine_cmd_parser(struct intel_engine_cs *engine,
 				  *cmd,
 				  length,
 				  batch_end - cmd);
-			ret = -EINVAL;
-			break;
+			return -EINVAL;
 		}
 
-		if (!check_cmd(engine, desc, cmd, length)) {
-			ret = -EACCES;
-			break;
-		}
+		if (!check_cmd(engine, desc, cmd, length))
+			return -EACCES;
 
+		/* Leave the jump itself to check_bbstart() */
 		if (cmd_desc_is(desc, MI_BATCH_BUFFER_START)) {
-			ret = check_bbstart(cmd, offset, length, batch_length,
-					    batch_addr, shadow_addr,
-					    jump_whitelist);
-			break;
+			*bbstart = offset;
+			*bbstart_length = length;
+			return 0;
 		}
 
 		if (!IS_ERR_OR_NULL(jump_whitelist))
@@ -1526,11 +1648,122 @@ int intel_engine_cmd_parser(struct intel_engine_cs *engine,
 		offset += length;
 		if  (cmd >= batch_end) {
 			DRM_DEBUG("CMD: Got to the end of the buffer w/o a BBE cmd!\n");
-			ret = -EINVAL;
-			break;
+			return -EINVAL;
 		}
 	} while (1);
+}
+
+static int parse_batch(struct intel_engine_cs *engine,
+		       u32 *cmd, u32 batch_length,
+		       u64 batch_addr, u64 shadow_addr,
+		       bool trampoline)
+{
+	struct intel_engine_cmd_cache *cache = engine->cmd_cache;
+	u32 bbstart = CMD_CACHE_NO_BBSTART, bbstart_length = 0;
+	u8 digest[SHA256_DIGEST_SIZE];
+	unsigned long *jump_whitelist;
+	int ret;
+
+	if (batch_length > CMD_CACHE_MAX_LENGTH)
+		cache = NULL;
+
+	if (cache) {
+		struct cmd_cache_entry *e;
+
+		sha256((const u8 *)cmd, batch_length, digest);
+
+		mutex_lock(&cache->lock);
+		e = cmd_cache_lookup(cache, digest, batch_length, trampoline);
+		if (e) {
+			cache->hits++;
+			list_move(&e->link, &cache->lru);
+
+			ret = e->ret;
+			if (!ret && e->bbstart != CMD_CACHE_NO_BBSTART)
+				ret = check_bbstart(cmd + e->bbstart,
+						    e->bbstart,
+						    e->bbstart_length,
+						    batch_length,
+						    batch_addr, shadow_addr,
+						    trampoline ? NULL : e->whitelist);
+			mutex_unlock(&cache->lock);
+			return ret;
+		}
+		cache->misses++;
+		mutex_unlock(&cache->lock);
+	}
+
+	jump_whitelist = NULL;
+	if (!trampoline)
+		/* Defer failure until attempted use */
+		jump_whitelist = alloc_whitelist(batch_length);
+
+	ret = scan_batch(engine, cmd, batch_length, jump_whitelist,
+			 &bbstart, &bbstart_length);
+
+	if (cache && !IS_ERR(jump_whitelist))
+		cmd_cache_insert(cache, digest, batch_length, trampoline,
+				 ret, bbstart, bbstart_length, jump_whitelist);
+
+	if (!ret && bbstart != CMD_CACHE_NO_BBSTART)
+		ret = check_bbstart(cmd + bbstart, bbstart, bbstart_length,
+				    batch_length, batch_addr, shadow_addr,
+				    jump_whitelist);
+
+	if (!IS_ERR_OR_NULL(jump_whitelist))
+		kfree(jump_whitelist);
+	return ret;
+}
+
+/**
+ * intel_engine_cmd_parser() - parse a batch buffer for privilege violations
+ * @engine: the engine on which the batch is to execute
+ * @batch: the batch buffer in question
+ * @batch_offset: byte offset in the batch at which execution starts
+ * @batch_length: length of the commands in batch_obj
+ * @shadow: validated copy of the batch buffer in question
+ * @trampoline: true if we need to trampoline into privileged execution
+ *
+ * Parses the specified batch buffer looking for privilege violations as
+ * described in the overview.
+ *
+ * Return: non-zero if the parser finds violations or otherwise fails; -EACCES
+ * if the batch appears legal but should use hardware parsing
+ */
+
+int intel_engine_cmd_parser(struct intel_engine_cs *engine,
+			    struct i915_vma *batch,
+			    unsigned long batch_offset,
+			    unsigned long batch_length,
+			    struct i915_vma *shadow,
+			    bool trampoline)
+{
+	u32 *cmd, *batch_end;
+	bool needs_clflush_after = false;
+	u64 batch_addr, shadow_addr;
+	int ret;
 
+	GEM_BUG_ON(!IS_ALIGNED(batch_offset, sizeof(*cmd)));
+	GEM_BUG_ON(!IS_ALIGNED(batch_length, sizeof(*cmd)));
+	GEM_BUG_ON(range_overflows_t(u64, batch_offset, batch_length,
+				     batch->size));
+	GEM_BUG_ON(!batch_length);
+
+	cmd = copy_batch(shadow->obj, batch->obj,
+			 batch_offset, batch_length,
+			 &needs_clflush_after);
+	if (IS_ERR(cmd)) {
+		DRM_DEBUG("CMD: Failed to copy batch\n");
+		return PTR_ERR(cmd);
+	}
+
+	shadow_addr = gen8_canonical_addr(i915_vma_offset(shadow));
+	batch_addr = gen8_canonical_addr(i915_vma_offset(batch) + batch_offset);
+
+	ret = parse_batch(engine, cmd, batch_length,
+			  batch_addr, shadow_addr, trampoline);
+
+	batch_end = cmd + batch_length / sizeof(*batch_end);
 	if (trampoline) {
 		/*
 		 * With the trampoline, the shadow is executed twice.
@@ -1548,7 +1781,6 @@ int intel_engine_cmd_parser(struct intel_engine_cs *engine,
 
 		if (ret) {
 			/* Batch unsafe to execute with privileges, cancel! */
-			cmd = page_mask_bits(shadow->obj->mm.mapping);
 			*cmd = MI_BATCH_BUFFER_END;
 
 			/* If batch is unsafe but valid, jump to the original */
@@ -1570,9 +1802,6 @@ int intel_engine_cmd_parser(struct intel_engine_cs *engine,
 	}
 
 	i915_gem_object_flush_map(shadow->obj);
-
-	if (!IS_ERR_OR_NULL(jump_whitelist))
-		kfree(jump_whitelist);
 	i915_gem_object_unpin_map(shadow->obj);
 	return ret;
 }
@@ -1622,3 +1851,7 @@ int i915_cmd_parser_get_version(struct drm_i915_private *dev_priv)
 	 */
 	return 10;
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#include "selftests/i915_cmd_parser.c"
+#endif
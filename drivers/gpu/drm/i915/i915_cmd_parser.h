@@ -9,6 +9,7 @@
 #include <linux/types.h>
 
 struct drm_i915_private;
+struct drm_printer;
 struct intel_engine_cs;
 struct i915_vma;
 
@@ -23,4 +24,7 @@ int intel_engine_cmd_parser(struct intel_engine_cs *engine,
 			    bool trampoline);
 #define I915_CMD_PARSER_TRAMPOLINE_SIZE 8
 
+void intel_engine_cmd_parser_dump_cache(struct intel_engine_cs *engine,
+					struct drm_printer *p);
+
 #endif /* __I915_CMD_PARSER_H__ */
@@ -48,6 +48,7 @@
 #include "gt/intel_rps.h"
 #include "gt/intel_sseu_debugfs.h"
 
+#include "i915_cmd_parser.h"
 #include "i915_debugfs.h"
 #include "i915_debugfs_params.h"
 #include "i915_driver.h"
@@ -294,6 +295,13 @@ static int i915_gem_object_info(struct seq_file *m, void *data)
 		   i915->mm.shrink_count,
 		   atomic_read(&i915->mm.free_count),
 		   i915->mm.shrink_memory);
+	if (nr_node_ids > 1) {
+		int nid;
+
+		for (nid = 0; nid < nr_node_ids; nid++)
+			seq_printf(m, "  node%d: %llu bytes\n", nid,
+				   READ_ONCE(i915->mm.lru[nid].shrink_memory));
+	}
 	for_each_memory_region(mr, i915, id)
 		intel_memory_region_debug(mr, &p);
 
@@ -690,6 +698,19 @@ static int i915_sseu_status(struct seq_file *m, void *unused)
 	return intel_sseu_status(m, gt);
 }
 
+static int i915_cmd_parser_cache(struct seq_file *m, void *unused)
+{
+	struct drm_i915_private *i915 = node_to_i915(m->private);
+	struct intel_engine_cs *engine;
+	struct drm_printer p;
+
+	p = drm_seq_file_printer(m);
+	for_each_uabi_engine(engine, i915)
+		intel_engine_cmd_parser_dump_cache(engine, &p);
+
+	return 0;
+}
+
 static int i915_forcewake_open(struct inode *inode, struct file *file)
 {
 	struct drm_i915_private *i915 = inode->i_private;
@@ -727,6 +748,7 @@ static const struct drm_info_list i915_debugfs_list[] = {
 	{"i915_swizzle_info", i915_swizzle_info, 0},
 	{"i915_runtime_pm_status", i915_runtime_pm_status, 0},
 	{"i915_engine_info", i915_engine_info, 0},
+	{"i915_cmd_parser_cache", i915_cmd_parser_cache, 0},
 	{"i915_wa_registers", i915_wa_registers, 0},
 	{"i915_sseu_status", i915_sseu_status, 0},
 	{"i915_rps_boost_info", i915_rps_boost_info, 0},
@@ -254,7 +254,9 @@ static int i915_driver_early_probe(struct drm_i915_private *dev_priv)
 	if (ret < 0)
 		goto err_rootgt;
 
-	i915_gem_init_early(dev_priv);
+	ret = i915_gem_init_early(dev_priv);
+	if (ret < 0)
+		goto err_rootgt;
 
 	/* This must be called before any calls to HAS_PCH_* */
 	intel_detect_pch(dev_priv);
@@ -116,6 +116,21 @@ struct intel_l3_parity {
 	int which_slice;
 };
 
+struct i915_gem_mm_lru {
+	/**
+	 * List of objects which are purgeable.
+	 */
+	struct list_head purge_list;
+
+	/**
+	 * List of objects which have allocated pages and are shrinkable.
+	 */
+	struct list_head shrink_list;
+
+	/** Size of all objects on either list */
+	u64 shrink_memory;
+};
+
 struct i915_gem_mm {
 	/*
 	 * Shortcut for the stolen region. This points to either
@@ -134,14 +149,11 @@ struct i915_gem_mm {
 	spinlock_t obj_lock;
 
 	/**
-	 * List of objects which are purgeable.
-	 */
-	struct list_head purge_list;
-
-	/**
-	 * List of objects which have allocated pages and are shrinkable.
+	 * Per NUMA node lists of purgeable and shrinkable objects, indexed
+	 * by the node of their backing pages, so that reclaim on one node
+	 * only considers the objects it can actually free memory from.
 	 */
-	struct list_head shrink_list;
+	struct i915_gem_mm_lru *lru;
 
 	/**
 	 * List of objects which are pending destruction.
@@ -37,6 +37,7 @@
 #include <linux/mman.h>
 
 #include <drm/drm_cache.h>
+#include <drm/drm_managed.h>
 #include <drm/drm_vma_manager.h>
 
 #include "display/intel_display.h"
@@ -1078,16 +1079,9 @@ i915_gem_madvise_ioctl(struct drm_device *dev, void *data,
 		unsigned long flags;
 
 		spin_lock_irqsave(&i915->mm.obj_lock, flags);
-		if (!list_empty(&obj->mm.link)) {
-			struct list_head *list;
-
-			if (obj->mm.madv != I915_MADV_WILLNEED)
-				list = &i915->mm.purge_list;
-			else
-				list = &i915->mm.shrink_list;
-			list_move_tail(&obj->mm.link, list);
-
-		}
+		if (!list_empty(&obj->mm.link))
+			__i915_gem_object_lru_move(obj,
+						   obj->mm.madv != I915_MADV_WILLNEED);
 		spin_unlock_irqrestore(&i915->mm.obj_lock, flags);
 	}
 
@@ -1213,6 +1207,7 @@ int i915_gem_init(struct drm_i915_private *dev_priv)
 	i915_gem_drain_workqueue(dev_priv);
 
 	if (ret != -EIO) {
+		i915_gem_lmem_pool_enable(dev_priv, false);
 		for_each_gt(gt, dev_priv, i) {
 			intel_gt_driver_remove(gt);
 			intel_gt_driver_release(gt);
@@ -1260,6 +1255,13 @@ void i915_gem_driver_remove(struct drm_i915_private *dev_priv)
 	struct intel_gt *gt;
 	unsigned int i;
 
+	/*
+	 * The cleared lmem pool refills using the migrate context, which
+	 * intel_gt_driver_remove() tears down; stop it (and wait for any
+	 * refill in flight) before the frees during teardown can kick it.
+	 */
+	i915_gem_lmem_pool_enable(dev_priv, false);
+
 	i915_gem_suspend_late(dev_priv);
 	for_each_gt(gt, dev_priv, i)
 		intel_gt_driver_remove(gt);
@@ -1285,22 +1287,38 @@ void i915_gem_driver_release(struct drm_i915_private *dev_priv)
 	drm_WARN_ON(&dev_priv->drm, !list_empty(&dev_priv->gem.contexts.list));
 }
 
-static void i915_gem_init__mm(struct drm_i915_private *i915)
+static int i915_gem_init__mm(struct drm_i915_private *i915)
 {
+	int nid;
+
 	spin_lock_init(&i915->mm.obj_lock);
 
 	init_llist_head(&i915->mm.free_list);
 
-	INIT_LIST_HEAD(&i915->mm.purge_list);
-	INIT_LIST_HEAD(&i915->mm.shrink_list);
+	i915->mm.lru = drmm_kcalloc(&i915->drm, nr_node_ids,
+				    sizeof(*i915->mm.lru), GFP_KERNEL);
+	if (!i915->mm.lru)
+		return -ENOMEM;
+
+	for (nid = 0; nid < nr_node_ids; nid++) {
+		INIT_LIST_HEAD(&i915->mm.lru[nid].purge_list);
+		INIT_LIST_HEAD(&i915->mm.lru[nid].shrink_list);
+	}
 
 	i915_gem_init__objects(i915);
+	return 0;
 }
 
-void i915_gem_init_early(struct drm_i915_private *dev_priv)
+int i915_gem_init_early(struct drm_i915_private *dev_priv)
 {
-	i915_gem_init__mm(dev_priv);
+	int err;
+
+	err = i915_gem_init__mm(dev_priv);
+	if (err)
+		return err;
+
 	i915_gem_init__contexts(dev_priv);
+	return 0;
 }
 
 void i915_gem_cleanup_early(struct drm_i915_private *dev_priv)
@@ -148,6 +148,7 @@ int i915_getparam_ioctl(struct drm_device *dev, void *data,
 	case I915_PARAM_HAS_EXEC_SUBMIT_FENCE:
 	case I915_PARAM_HAS_EXEC_TIMELINE_FENCES:
 	case I915_PARAM_HAS_USERPTR_PROBE:
+	case I915_PARAM_HAS_EXEC_RESIDENT_SET:
 		/* For the time being all of these are always true;
 		 * if some supported hardware does not have one of these
 		 * features this value needs to be provided from
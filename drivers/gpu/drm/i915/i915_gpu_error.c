@@ -72,48 +72,71 @@ static void __sg_set_buf(struct scatterlist *sg,
 	sg->dma_address = it;
 }
 
-static bool __i915_error_grow(struct drm_i915_error_state_buf *e, size_t len)
+static void *__i915_error_alloc(size_t size, gfp_t gfp)
 {
-	if (!len)
-		return false;
+	struct page *page;
 
-	if (e->bytes + len + 1 <= e->size)
+	/* Every chunk in the sgl is page-backed and owns a reference */
+	page = alloc_pages(gfp | __GFP_COMP, get_order(size));
+	return page ? page_address(page) : NULL;
+}
+
+static void __i915_error_flush(struct drm_i915_error_state_buf *e)
+{
+	if (!e->bytes)
+		return;
+
+	__sg_set_buf(e->cur++, e->buf, e->bytes, e->iter);
+	e->iter += e->bytes;
+	e->buf = NULL;
+	e->bytes = 0;
+	e->size = 0;
+}
+
+static bool __i915_error_next_sg(struct drm_i915_error_state_buf *e)
+{
+	struct scatterlist *sgl;
+
+	if (e->cur != e->end)
 		return true;
 
-	if (e->bytes) {
-		__sg_set_buf(e->cur++, e->buf, e->bytes, e->iter);
-		e->iter += e->bytes;
-		e->buf = NULL;
-		e->bytes = 0;
+	sgl = (typeof(sgl))__get_free_page(ALLOW_FAIL);
+	if (!sgl) {
+		e->err = -ENOMEM;
+		return false;
 	}
 
-	if (e->cur == e->end) {
-		struct scatterlist *sgl;
+	if (e->cur) {
+		e->cur->offset = 0;
+		e->cur->length = 0;
+		e->cur->page_link =
+			(unsigned long)sgl | SG_CHAIN;
+	} else {
+		e->sgl = sgl;
+	}
 
-		sgl = (typeof(sgl))__get_free_page(ALLOW_FAIL);
-		if (!sgl) {
-			e->err = -ENOMEM;
-			return false;
-		}
+	e->cur = sgl;
+	e->end = sgl + SG_MAX_SINGLE_ALLOC - 1;
+	return true;
+}
 
-		if (e->cur) {
-			e->cur->offset = 0;
-			e->cur->length = 0;
-			e->cur->page_link =
-				(unsigned long)sgl | SG_CHAIN;
-		} else {
-			e->sgl = sgl;
-		}
+static bool __i915_error_grow(struct drm_i915_error_state_buf *e, size_t len)
+{
+	if (!len)
+		return false;
 
-		e->cur = sgl;
-		e->end = sgl + SG_MAX_SINGLE_ALLOC - 1;
-	}
+	if (e->bytes + len + 1 <= e->size)
+		return true;
+
+	__i915_error_flush(e);
+	if (!__i915_error_next_sg(e))
+		return false;
 
 	e->size = ALIGN(len + 1, SZ_64K);
-	e->buf = kmalloc(e->size, ALLOW_FAIL);
+	e->buf = __i915_error_alloc(e->size, ALLOW_FAIL);
 	if (!e->buf) {
 		e->size = PAGE_ALIGN(len + 1);
-		e->buf = kmalloc(e->size, GFP_KERNEL);
+		e->buf = __i915_error_alloc(e->size, GFP_KERNEL);
 	}
 	if (!e->buf) {
 		e->err = -ENOMEM;
@@ -123,6 +146,22 @@ static bool __i915_error_grow(struct drm_i915_error_state_buf *e, size_t len)
 	return true;
 }
 
+static void i915_error_splice_page(struct drm_i915_error_state_buf *e,
+				   struct page *page, unsigned int len)
+{
+	if (e->err || !len)
+		return;
+
+	/* Insert the page directly into the stream, no copy */
+	__i915_error_flush(e);
+	if (!__i915_error_next_sg(e))
+		return;
+
+	get_page(page);
+	__sg_set_buf(e->cur++, page_address(page), len, e->iter);
+	e->iter += len;
+}
+
 __printf(2, 0)
 static void i915_error_vprintf(struct drm_i915_error_state_buf *e,
 			       const char *fmt, va_list args)
@@ -242,7 +281,90 @@ static void pool_free(struct folio_batch *fbatch, void *addr)
 		folio_put(folio);
 }
 
-#ifdef CONFIG_DRM_I915_COMPRESS_ERROR
+static void i915_vma_coredump_put_snapshot(struct i915_vma_coredump *vma)
+{
+	while (vma->snapshot_count)
+		put_page(vma->snapshot[--vma->snapshot_count]);
+
+	kvfree(fetch_and_zero(&vma->snapshot));
+}
+
+#if IS_ENABLED(CONFIG_DRM_I915_COMPRESS_ERROR_ASYNC)
+
+/*
+ * Nothing is compressed while capturing. System memory pages are only
+ * referenced, and anything that may not survive the reset (GGTT or local
+ * memory) is copied raw into the snapshot; the snapshot is then compressed
+ * later by error_compress_work(). If we cannot allocate the snapshot, the
+ * pages are copied raw into the page_list and emitted uncompressed.
+ */
+struct i915_vma_compress {
+	struct folio_batch pool;
+};
+
+static bool compress_init(struct i915_vma_compress *c)
+{
+	return pool_init(&c->pool, ALLOW_FAIL) == 0;
+}
+
+static bool compress_start(struct i915_vma_compress *c,
+			   struct i915_vma_coredump *dst, u64 size)
+{
+	dst->snapshot_max = size >> PAGE_SHIFT;
+	dst->snapshot = kvmalloc_array(dst->snapshot_max,
+				       sizeof(*dst->snapshot), ALLOW_FAIL);
+	if (!dst->snapshot)
+		dst->snapshot_max = 0;
+
+	return true;
+}
+
+static int compress_page(struct i915_vma_compress *c,
+			 void *src,
+			 struct i915_vma_coredump *dst,
+			 bool wc)
+{
+	void *ptr;
+
+	ptr = pool_alloc(&c->pool, ALLOW_FAIL);
+	if (!ptr)
+		return -ENOMEM;
+
+	if (!(wc && i915_memcpy_from_wc(ptr, src, PAGE_SIZE)))
+		memcpy(ptr, src, PAGE_SIZE);
+	if (dst->snapshot) {
+		GEM_BUG_ON(dst->snapshot_count == dst->snapshot_max);
+		dst->snapshot[dst->snapshot_count++] = virt_to_page(ptr);
+	} else {
+		list_add_tail(&virt_to_page(ptr)->lru, &dst->page_list);
+	}
+	cond_resched();
+
+	return 0;
+}
+
+static int compress_flush(struct i915_vma_compress *c,
+			  struct i915_vma_coredump *dst)
+{
+	return 0;
+}
+
+static void compress_finish(struct i915_vma_compress *c)
+{
+}
+
+static void compress_fini(struct i915_vma_compress *c)
+{
+	pool_fini(&c->pool);
+}
+
+static void err_compression_marker(struct drm_i915_error_state_buf *m)
+{
+	/* Only for what was left uncompressed, see intel_gpu_error_print_vma() */
+	err_puts(m, "~");
+}
+
+#elif defined(CONFIG_DRM_I915_COMPRESS_ERROR)
 
 struct i915_vma_compress {
 	struct folio_batch pool;
@@ -272,7 +394,8 @@ static bool compress_init(struct i915_vma_compress *c)
 	return true;
 }
 
-static bool compress_start(struct i915_vma_compress *c)
+static bool compress_start(struct i915_vma_compress *c,
+			   struct i915_vma_coredump *dst, u64 size)
 {
 	struct z_stream_s *zstream = &c->zstream;
 	void *workspace = zstream->workspace;
@@ -390,7 +513,8 @@ static bool compress_init(struct i915_vma_compress *c)
 	return pool_init(&c->pool, ALLOW_FAIL) == 0;
 }
 
-static bool compress_start(struct i915_vma_compress *c)
+static bool compress_start(struct i915_vma_compress *c,
+			   struct i915_vma_coredump *dst, u64 size)
 {
 	return true;
 }
@@ -436,6 +560,272 @@ static void err_compression_marker(struct drm_i915_error_state_buf *m)
 
 #endif
 
+#if IS_ENABLED(CONFIG_DRM_I915_COMPRESS_ERROR_ASYNC)
+
+/*
+ * Nothing is waiting on the worker, so trade some of the ratio for speed.
+ * The output is the same zlib stream as from CONFIG_DRM_I915_COMPRESS_ERROR,
+ * so existing decoders can read it.
+ */
+#define ERROR_DEFLATE_LEVEL Z_BEST_SPEED
+
+struct error_deflate {
+	struct z_stream_s zstream;
+	u32 *tmp;
+
+	struct i915_vma_coredump *dst;
+	char *text;
+	unsigned int len;
+};
+
+static bool compress_can_snapshot(const struct i915_vma_resource *vma_res)
+{
+	/* Only pages from the system region can be held by reference */
+	return vma_res->mr && vma_res->mr->type == INTEL_MEMORY_SYSTEM;
+}
+
+static int compress_snapshot_page(struct i915_vma_compress *c,
+				  struct i915_vma_coredump *dst,
+				  struct page *page)
+{
+	void *s;
+	int err;
+
+	if (dst->snapshot) {
+		GEM_BUG_ON(dst->snapshot_count == dst->snapshot_max);
+		get_page(page);
+		dst->snapshot[dst->snapshot_count++] = page;
+		return 0;
+	}
+
+	/* No room to defer, copy the page now and leave it uncompressed */
+	drm_clflush_pages(&page, 1);
+
+	s = kmap_local_page(page);
+	err = compress_page(c, s, dst, false);
+	kunmap_local(s);
+
+	return err;
+}
+
+static int deflate_emit(struct error_deflate *z, const char *str)
+{
+	while (*str) {
+		if (z->len == PAGE_SIZE) {
+			struct page *page;
+
+			page = alloc_page(GFP_KERNEL | __GFP_NOWARN);
+			if (!page)
+				return -ENOMEM;
+
+			list_add_tail(&page->lru, &z->dst->page_list);
+			z->text = page_address(page);
+			z->len = 0;
+		}
+
+		z->text[z->len++] = *str++;
+	}
+
+	return 0;
+}
+
+static int deflate_encode(struct error_deflate *z, size_t len)
+{
+	char out[ASCII85_BUFSZ];
+	int i, err = 0;
+
+	/*
+	 * Encode the compressed stream as ascii85 text now, so that reading
+	 * the error state can splice the pages straight into the output.
+	 */
+	memset((void *)z->tmp + len, 0, ALIGN(len, sizeof(u32)) - len);
+	for (i = 0; !err && i < ascii85_encode_len(len); i++)
+		err = deflate_emit(z, ascii85_encode(z->tmp[i], out));
+
+	return err;
+}
+
+static int deflate_drain(struct error_deflate *z)
+{
+	struct z_stream_s *zstream = &z->zstream;
+	int err;
+
+	if (zstream->avail_out)
+		return 0;
+
+	err = deflate_encode(z, PAGE_SIZE);
+	zstream->next_out = (void *)z->tmp;
+	zstream->avail_out = PAGE_SIZE;
+	return err;
+}
+
+static int deflate_compress_vma(struct error_deflate *z,
+				struct i915_vma_coredump *vma)
+{
+	struct z_stream_s *zstream = &z->zstream;
+	void *workspace = zstream->workspace;
+	unsigned int n;
+	int ret, err;
+
+	memset(zstream, 0, sizeof(*zstream));
+	zstream->workspace = workspace;
+	if (zlib_deflateInit(zstream, ERROR_DEFLATE_LEVEL) != Z_OK)
+		return -EIO;
+
+	zstream->next_out = (void *)z->tmp;
+	zstream->avail_out = PAGE_SIZE;
+
+	z->dst = vma;
+	z->len = PAGE_SIZE;
+
+	for (n = 0; n < vma->snapshot_count; n++) {
+		struct page *page = vma->snapshot[n];
+		void *src;
+
+		drm_clflush_pages(&page, 1);
+
+		err = 0;
+		src = kmap_local_page(page);
+		zstream->next_in = src;
+		zstream->avail_in = PAGE_SIZE;
+		while (!err && zstream->avail_in) {
+			err = deflate_drain(z);
+			if (!err && zlib_deflate(zstream, Z_NO_FLUSH) != Z_OK)
+				err = -EIO;
+		}
+		kunmap_local(src);
+		if (err)
+			goto out;
+
+		cond_resched();
+	}
+
+	do {
+		err = deflate_drain(z);
+		if (err)
+			goto out;
+
+		ret = zlib_deflate(zstream, Z_FINISH);
+	} while (ret == Z_OK);
+	if (ret != Z_STREAM_END) {
+		err = -EIO;
+		goto out;
+	}
+
+	err = deflate_encode(z, PAGE_SIZE - zstream->avail_out);
+	if (err)
+		goto out;
+
+	vma->unused = PAGE_SIZE - z->len;
+	vma->encoded = true;
+out:
+	zlib_deflateEnd(zstream);
+	return err;
+}
+
+static void deflate_compress_list(struct error_deflate *z,
+				  struct i915_vma_coredump *vma)
+{
+	for (; vma; vma = vma->next) {
+		if (!vma->snapshot)
+			continue;
+
+		/* On failure, keep the snapshot and emit it uncompressed */
+		if (!z->zstream.workspace || deflate_compress_vma(z, vma)) {
+			struct page *page, *n;
+
+			list_for_each_entry_safe(page, n, &vma->page_list, lru) {
+				list_del_init(&page->lru);
+				__free_page(page);
+			}
+			vma->unused = 0;
+			continue;
+		}
+
+		i915_vma_coredump_put_snapshot(vma);
+	}
+}
+
+static void error_compress_work(struct work_struct *wrk)
+{
+	struct i915_gpu_coredump *error =
+		container_of(wrk, typeof(*error), compress_work);
+	struct error_deflate z = {};
+	struct intel_gt_coredump *gt;
+
+	z.tmp = (u32 *)__get_free_page(GFP_KERNEL);
+	if (z.tmp)
+		z.zstream.workspace =
+			kvmalloc(zlib_deflate_workspacesize(MAX_WBITS,
+							    MAX_MEM_LEVEL),
+				 GFP_KERNEL);
+
+	for (gt = error->gt; gt; gt = gt->next) {
+		struct intel_engine_coredump *ee;
+
+		for (ee = gt->engine; ee; ee = ee->next)
+			deflate_compress_list(&z, ee->vma);
+
+		if (gt->uc) {
+			deflate_compress_list(&z, gt->uc->guc.vma_log);
+			deflate_compress_list(&z, gt->uc->guc.vma_ctb);
+		}
+	}
+
+	kvfree(z.zstream.workspace);
+	free_page((unsigned long)z.tmp);
+
+	i915_gpu_coredump_put(error);
+}
+
+static void error_compress_init(struct i915_gpu_coredump *error)
+{
+	INIT_WORK(&error->compress_work, error_compress_work);
+}
+
+static void error_compress_queue(struct i915_gpu_coredump *error)
+{
+	if (xchg(&error->compress_queued, true))
+		return;
+
+	i915_gpu_coredump_get(error);
+	queue_work(system_unbound_wq, &error->compress_work);
+}
+
+static void error_compress_sync(struct i915_gpu_coredump *error)
+{
+	error_compress_queue(error);
+	flush_work(&error->compress_work);
+}
+
+#else
+
+static bool compress_can_snapshot(const struct i915_vma_resource *vma_res)
+{
+	return false;
+}
+
+static int compress_snapshot_page(struct i915_vma_compress *c,
+				  struct i915_vma_coredump *dst,
+				  struct page *page)
+{
+	return -ENODEV;
+}
+
+static void error_compress_init(struct i915_gpu_coredump *error)
+{
+}
+
+static void error_compress_queue(struct i915_gpu_coredump *error)
+{
+}
+
+static void error_compress_sync(struct i915_gpu_coredump *error)
+{
+}
+
+#endif
+
 static void error_print_instdone(struct drm_i915_error_state_buf *m,
 				 const struct intel_engine_coredump *ee)
 {
@@ -610,12 +1000,23 @@ void i915_error_printf(struct drm_i915_error_state_buf *e, const char *f, ...)
 	va_end(args);
 }
 
+static void err_print_ascii85(struct drm_i915_error_state_buf *m,
+			      const u32 *addr, int len)
+{
+	char out[ASCII85_BUFSZ];
+	int i;
+
+	len = ascii85_encode_len(len);
+	for (i = 0; i < len; i++)
+		err_puts(m, ascii85_encode(addr[i], out));
+}
+
 static void intel_gpu_error_print_vma(struct drm_i915_error_state_buf *m,
 				      const struct intel_engine_cs *engine,
 				      const struct i915_vma_coredump *vma)
 {
-	char out[ASCII85_BUFSZ];
 	struct page *page;
+	unsigned int n;
 
 	if (!vma)
 		return;
@@ -628,18 +1029,43 @@ static void intel_gpu_error_print_vma(struct drm_i915_error_state_buf *m,
 	if (vma->gtt_page_sizes > I915_GTT_PAGE_SIZE_4K)
 		err_printf(m, "gtt_page_sizes = 0x%08x\n", vma->gtt_page_sizes);
 
+	if (vma->encoded) {
+		/* Already deflated and ascii85 encoded by error_compress_work() */
+		err_puts(m, ":");
+		list_for_each_entry(page, &vma->page_list, lru) {
+			int len = PAGE_SIZE;
+
+			if (page == list_last_entry(&vma->page_list,
+						    typeof(*page), lru))
+				len -= vma->unused;
+
+			i915_error_splice_page(m, page, len);
+		}
+		err_puts(m, "\n");
+		return;
+	}
+
 	err_compression_marker(m);
 	list_for_each_entry(page, &vma->page_list, lru) {
-		int i, len;
-		const u32 *addr = page_address(page);
+		int len;
 
 		len = PAGE_SIZE;
 		if (page == list_last_entry(&vma->page_list, typeof(*page), lru))
 			len -= vma->unused;
-		len = ascii85_encode_len(len);
 
-		for (i = 0; i < len; i++)
-			err_puts(m, ascii85_encode(addr[i], out));
+		err_print_ascii85(m, page_address(page), len);
+	}
+
+	/* A snapshot the worker failed to compress */
+	for (n = 0; n < vma->snapshot_count; n++) {
+		void *addr;
+
+		page = vma->snapshot[n];
+		drm_clflush_pages(&page, 1);
+
+		addr = kmap_local_page(page);
+		err_print_ascii85(m, addr, PAGE_SIZE);
+		kunmap_local(addr);
 	}
 	err_puts(m, "\n");
 }
@@ -709,7 +1135,7 @@ static void err_free_sgl(struct scatterlist *sgl)
 		struct scatterlist *sg;
 
 		for (sg = sgl; !sg_is_chain(sg); sg++) {
-			kfree(sg_virt(sg));
+			put_page(sg_page(sg));
 			if (sg_is_last(sg))
 				break;
 		}
@@ -919,16 +1345,14 @@ static int err_print_to_sgl(struct i915_gpu_coredump *error)
 	if (READ_ONCE(error->sgl))
 		return 0;
 
+	error_compress_sync(error);
+
 	memset(&m, 0, sizeof(m));
 	m.i915 = error->i915;
 
 	__err_print_to_sgl(&m, error);
 
-	if (m.buf) {
-		__sg_set_buf(m.cur++, m.buf, m.bytes, m.iter);
-		m.bytes = 0;
-		m.buf = NULL;
-	}
+	__i915_error_flush(&m);
 	if (m.cur) {
 		GEM_BUG_ON(m.end < m.cur);
 		sg_mark_end(m.cur - 1);
@@ -957,6 +1381,13 @@ ssize_t i915_gpu_coredump_copy_to_buffer(struct i915_gpu_coredump *error,
 	if (!error || !rem)
 		return 0;
 
+	/*
+	 * The first read renders the whole error state into error->sgl,
+	 * splicing in the pre-encoded buffer pages, and subsequent reads
+	 * only copy out the requested window. Rendering is not done per
+	 * offset, so the text for the non-buffer state is held until the
+	 * coredump is freed.
+	 */
 	err = err_print_to_sgl(error);
 	if (err)
 		return err;
@@ -1020,6 +1451,7 @@ static void i915_vma_coredump_free(struct i915_vma_coredump *vma)
 			list_del_init(&page->lru);
 			__free_page(page);
 		}
+		i915_vma_coredump_put_snapshot(vma);
 
 		kfree(vma);
 		vma = next;
@@ -1082,6 +1514,24 @@ void __i915_gpu_coredump_free(struct kref *error_ref)
 	kfree(error);
 }
 
+/*
+ * How much we will walk below, through either the struct pages or the dma
+ * addresses, which may cover more than the vma_size.
+ */
+static u64 sgt_size(const struct sg_table *st)
+{
+	struct scatterlist *sg;
+	u64 cpu = 0, dma = 0;
+	unsigned int i;
+
+	for_each_sgtable_sg(st, sg, i) {
+		cpu += sg->length;
+		dma += sg_dma_len(sg);
+	}
+
+	return PAGE_ALIGN(max(cpu, dma));
+}
+
 static struct i915_vma_coredump *
 i915_vma_coredump_create(const struct intel_gt *gt,
 			 const struct i915_vma_resource *vma_res,
@@ -1104,11 +1554,6 @@ i915_vma_coredump_create(const struct intel_gt *gt,
 	if (!dst)
 		return NULL;
 
-	if (!compress_start(compress)) {
-		kfree(dst);
-		return NULL;
-	}
-
 	INIT_LIST_HEAD(&dst->page_list);
 	strcpy(dst->name, name);
 	dst->next = NULL;
@@ -1118,8 +1563,26 @@ i915_vma_coredump_create(const struct intel_gt *gt,
 	dst->gtt_page_sizes = vma_res->page_sizes_gtt;
 	dst->unused = 0;
 
+	dst->snapshot = NULL;
+	dst->snapshot_count = 0;
+	dst->snapshot_max = 0;
+	dst->encoded = false;
+
+	if (!compress_start(compress, dst, sgt_size(vma_res->bi.pages))) {
+		kfree(dst);
+		return NULL;
+	}
+
 	ret = -EINVAL;
-	if (drm_mm_node_allocated(&ggtt->error_capture)) {
+	if (compress_can_snapshot(vma_res)) {
+		struct page *page;
+
+		for_each_sgt_page(page, iter, vma_res->bi.pages) {
+			ret = compress_snapshot_page(compress, dst, page);
+			if (ret)
+				break;
+		}
+	} else if (drm_mm_node_allocated(&ggtt->error_capture)) {
 		void __iomem *s;
 		dma_addr_t dma;
 
@@ -1196,6 +1659,7 @@ i915_vma_coredump_create(const struct intel_gt *gt,
 			list_del_init(&page->lru);
 			pool_free(&compress->pool, page_address(page));
 		}
+		i915_vma_coredump_put_snapshot(dst);
 
 		kfree(dst);
 		dst = NULL;
@@ -2019,6 +2483,7 @@ i915_gpu_coredump_alloc(struct drm_i915_private *i915, gfp_t gfp)
 
 	kref_init(&error->ref);
 	error->i915 = i915;
+	error_compress_init(error);
 
 	error->time = ktime_get_real();
 	error->boottime = ktime_get_boottime();
@@ -2173,6 +2638,7 @@ void i915_error_state_store(struct i915_gpu_coredump *error)
 		return;
 
 	i915_gpu_coredump_get(error);
+	error_compress_queue(error);
 
 	if (!xchg(&warned, true) &&
 	    ktime_get_real_seconds() - DRIVER_TIMESTAMP < DAY_AS_SECONDS(180)) {
@@ -11,6 +11,7 @@
 #include <linux/kref.h>
 #include <linux/ktime.h>
 #include <linux/sched.h>
+#include <linux/workqueue.h>
 
 #include <drm/drm_mm.h>
 
@@ -44,6 +45,12 @@ struct i915_vma_coredump {
 
 	int unused;
 	struct list_head page_list;
+
+	/* Pages awaiting deferred compression, released once compressed */
+	struct page **snapshot;
+	unsigned int snapshot_count;
+	unsigned int snapshot_max;
+	bool encoded; /* page_list holds compressed ascii85 text */
 };
 
 struct i915_request_coredump {
@@ -221,6 +228,9 @@ struct i915_gpu_coredump {
 	struct intel_overlay_error_state *overlay;
 
 	struct scatterlist *sgl, *fit;
+
+	struct work_struct compress_work;
+	bool compress_queued;
 };
 
 struct i915_gpu_error {
@@ -22,6 +22,7 @@
  *
  */
 
+#include <linux/io.h>
 #include <linux/kernel.h>
 #include <linux/string.h>
 #include <linux/cpufeature.h>
@@ -36,6 +37,9 @@
 #endif
 
 static DEFINE_STATIC_KEY_FALSE(has_movntdqa);
+static DEFINE_STATIC_KEY_FALSE(has_movntdq);
+static DEFINE_STATIC_KEY_FALSE(has_avx2);
+static DEFINE_STATIC_KEY_FALSE(has_avx512);
 
 static void __memcpy_ntdqa(void *dst, const void *src, unsigned long len)
 {
@@ -95,6 +99,230 @@ static void __memcpy_ntdqu(void *dst, const void *src, unsigned long len)
 	kernel_fpu_end();
 }
 
+/*
+ * The wider variants below copy in blocks of 4 registers, then mop up the
+ * remainder 16 bytes at a time using the VEX encoded xmm forms, so that
+ * they can be used for any length that the SSE4.1 paths accept. The
+ * streaming loads and aligned stores require the natural alignment of the
+ * register width for both @src and @dst.
+ */
+static void __memcpy_ntdqa_avx2(void *dst, const void *src, unsigned long len)
+{
+	kernel_fpu_begin();
+
+	while (len >= 8) {
+		asm("vmovntdqa   (%0), %%ymm0\n"
+		    "vmovntdqa 32(%0), %%ymm1\n"
+		    "vmovntdqa 64(%0), %%ymm2\n"
+		    "vmovntdqa 96(%0), %%ymm3\n"
+		    "vmovdqa %%ymm0,   (%1)\n"
+		    "vmovdqa %%ymm1, 32(%1)\n"
+		    "vmovdqa %%ymm2, 64(%1)\n"
+		    "vmovdqa %%ymm3, 96(%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 128;
+		dst += 128;
+		len -= 8;
+	}
+	while (len--) {
+		asm("vmovntdqa (%0), %%xmm0\n"
+		    "vmovdqa %%xmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 16;
+		dst += 16;
+	}
+	asm volatile("vzeroupper");
+
+	kernel_fpu_end();
+}
+
+static void __memcpy_ntdqu_avx2(void *dst, const void *src, unsigned long len)
+{
+	kernel_fpu_begin();
+
+	while (len >= 8) {
+		asm("vmovntdqa   (%0), %%ymm0\n"
+		    "vmovntdqa 32(%0), %%ymm1\n"
+		    "vmovntdqa 64(%0), %%ymm2\n"
+		    "vmovntdqa 96(%0), %%ymm3\n"
+		    "vmovdqu %%ymm0,   (%1)\n"
+		    "vmovdqu %%ymm1, 32(%1)\n"
+		    "vmovdqu %%ymm2, 64(%1)\n"
+		    "vmovdqu %%ymm3, 96(%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 128;
+		dst += 128;
+		len -= 8;
+	}
+	while (len--) {
+		asm("vmovntdqa (%0), %%xmm0\n"
+		    "vmovdqu %%xmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 16;
+		dst += 16;
+	}
+	asm volatile("vzeroupper");
+
+	kernel_fpu_end();
+}
+
+#ifdef CONFIG_AS_AVX512
+static void __memcpy_ntdqa_avx512(void *dst, const void *src, unsigned long len)
+{
+	kernel_fpu_begin();
+
+	while (len >= 16) {
+		asm("vmovntdqa    (%0), %%zmm0\n"
+		    "vmovntdqa  64(%0), %%zmm1\n"
+		    "vmovntdqa 128(%0), %%zmm2\n"
+		    "vmovntdqa 192(%0), %%zmm3\n"
+		    "vmovdqa64 %%zmm0,    (%1)\n"
+		    "vmovdqa64 %%zmm1,  64(%1)\n"
+		    "vmovdqa64 %%zmm2, 128(%1)\n"
+		    "vmovdqa64 %%zmm3, 192(%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 256;
+		dst += 256;
+		len -= 16;
+	}
+	while (len >= 4) {
+		asm("vmovntdqa (%0), %%zmm0\n"
+		    "vmovdqa64 %%zmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 64;
+		dst += 64;
+		len -= 4;
+	}
+	while (len--) {
+		asm("vmovntdqa (%0), %%xmm0\n"
+		    "vmovdqa %%xmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 16;
+		dst += 16;
+	}
+	asm volatile("vzeroupper");
+
+	kernel_fpu_end();
+}
+#else
+static void __memcpy_ntdqa_avx512(void *dst, const void *src, unsigned long len)
+{
+	__memcpy_ntdqa_avx2(dst, src, len);
+}
+#endif
+
+/*
+ * And in the opposite direction, streaming stores into WC from cacheable
+ * memory. Only the destination needs to be aligned, and as the stores are
+ * weakly ordered we have to fence before handing the data over.
+ */
+static void __memcpy_ntdq(void *dst, const void *src, unsigned long len)
+{
+	kernel_fpu_begin();
+
+	while (len >= 4) {
+		asm("movdqu   (%0), %%xmm0\n"
+		    "movdqu 16(%0), %%xmm1\n"
+		    "movdqu 32(%0), %%xmm2\n"
+		    "movdqu 48(%0), %%xmm3\n"
+		    "movntdq %%xmm0,   (%1)\n"
+		    "movntdq %%xmm1, 16(%1)\n"
+		    "movntdq %%xmm2, 32(%1)\n"
+		    "movntdq %%xmm3, 48(%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 64;
+		dst += 64;
+		len -= 4;
+	}
+	while (len--) {
+		asm("movdqu (%0), %%xmm0\n"
+		    "movntdq %%xmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 16;
+		dst += 16;
+	}
+	asm volatile("sfence" ::: "memory");
+
+	kernel_fpu_end();
+}
+
+static void __memcpy_ntdq_avx2(void *dst, const void *src, unsigned long len)
+{
+	kernel_fpu_begin();
+
+	while (len >= 8) {
+		asm("vmovdqu   (%0), %%ymm0\n"
+		    "vmovdqu 32(%0), %%ymm1\n"
+		    "vmovdqu 64(%0), %%ymm2\n"
+		    "vmovdqu 96(%0), %%ymm3\n"
+		    "vmovntdq %%ymm0,   (%1)\n"
+		    "vmovntdq %%ymm1, 32(%1)\n"
+		    "vmovntdq %%ymm2, 64(%1)\n"
+		    "vmovntdq %%ymm3, 96(%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 128;
+		dst += 128;
+		len -= 8;
+	}
+	while (len--) {
+		asm("vmovdqu (%0), %%xmm0\n"
+		    "vmovntdq %%xmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 16;
+		dst += 16;
+	}
+	asm volatile("vzeroupper\n"
+		     "sfence" ::: "memory");
+
+	kernel_fpu_end();
+}
+
+#ifdef CONFIG_AS_AVX512
+static void __memcpy_ntdq_avx512(void *dst, const void *src, unsigned long len)
+{
+	kernel_fpu_begin();
+
+	while (len >= 16) {
+		asm("vmovdqu64    (%0), %%zmm0\n"
+		    "vmovdqu64  64(%0), %%zmm1\n"
+		    "vmovdqu64 128(%0), %%zmm2\n"
+		    "vmovdqu64 192(%0), %%zmm3\n"
+		    "vmovntdq %%zmm0,    (%1)\n"
+		    "vmovntdq %%zmm1,  64(%1)\n"
+		    "vmovntdq %%zmm2, 128(%1)\n"
+		    "vmovntdq %%zmm3, 192(%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 256;
+		dst += 256;
+		len -= 16;
+	}
+	while (len >= 4) {
+		asm("vmovdqu64 (%0), %%zmm0\n"
+		    "vmovntdq %%zmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 64;
+		dst += 64;
+		len -= 4;
+	}
+	while (len--) {
+		asm("vmovdqu (%0), %%xmm0\n"
+		    "vmovntdq %%xmm0, (%1)\n"
+		    :: "r" (src), "r" (dst) : "memory");
+		src += 16;
+		dst += 16;
+	}
+	asm volatile("vzeroupper\n"
+		     "sfence" ::: "memory");
+
+	kernel_fpu_end();
+}
+#else
+static void __memcpy_ntdq_avx512(void *dst, const void *src, unsigned long len)
+{
+	__memcpy_ntdq_avx2(dst, src, len);
+}
+#endif
+
 /**
  * i915_memcpy_from_wc: perform an accelerated *aligned* read from WC
  * @dst: destination pointer
@@ -118,7 +346,16 @@ bool i915_memcpy_from_wc(void *dst, const void *src, unsigned long len)
 		return false;
 
 	if (static_branch_likely(&has_movntdqa)) {
-		if (likely(len))
+		unsigned long align = (unsigned long)dst | (unsigned long)src;
+
+		if (unlikely(!len))
+			return true;
+
+		if (static_branch_likely(&has_avx512) && IS_ALIGNED(align, 64))
+			__memcpy_ntdqa_avx512(dst, src, len >> 4);
+		else if (static_branch_likely(&has_avx2) && IS_ALIGNED(align, 32))
+			__memcpy_ntdqa_avx2(dst, src, len >> 4);
+		else
 			__memcpy_ntdqa(dst, src, len >> 4);
 		return true;
 	}
@@ -126,6 +363,79 @@ bool i915_memcpy_from_wc(void *dst, const void *src, unsigned long len)
 	return false;
 }
 
+/**
+ * i915_memcpy_to_wc: perform an accelerated *aligned* write to WC
+ * @dst: destination pointer
+ * @src: source pointer
+ * @len: how many bytes to copy
+ *
+ * i915_memcpy_to_wc copies @len bytes from @src to @dst using
+ * non-temporal stores where available, bypassing the cache for the
+ * destination. The destination @dst must be aligned to 16 bytes and @len
+ * must be a multiple of 16, whereas @src may be unaligned. The stores are
+ * fenced before returning.
+ *
+ * To test whether accelerated writes to WC are supported, use
+ * i915_memcpy_to_wc(NULL, NULL, 0);
+ *
+ * Returns true if the copy was successful, false if the preconditions
+ * are not met.
+ */
+bool i915_memcpy_to_wc(void *dst, const void *src, unsigned long len)
+{
+	if (unlikely(((unsigned long)dst | len) & 15))
+		return false;
+
+	if (static_branch_likely(&has_movntdq)) {
+		if (unlikely(!len))
+			return true;
+
+		if (static_branch_likely(&has_avx512) &&
+		    IS_ALIGNED((unsigned long)dst, 64))
+			__memcpy_ntdq_avx512(dst, src, len >> 4);
+		else if (static_branch_likely(&has_avx2) &&
+			 IS_ALIGNED((unsigned long)dst, 32))
+			__memcpy_ntdq_avx2(dst, src, len >> 4);
+		else
+			__memcpy_ntdq(dst, src, len >> 4);
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * i915_memcpy_toio: perform a mostly accelerated write to WC iomem
+ * @dst: destination pointer
+ * @src: source pointer
+ * @len: how many bytes to copy
+ *
+ * Like memcpy_toio(), but the 16-byte aligned bulk of the copy is streamed
+ * into @dst using i915_memcpy_to_wc() where available, which pays off for
+ * WC mappings of local memory. Neither pointer nor @len need be aligned.
+ */
+void i915_memcpy_toio(void __iomem *dst, const void *src, unsigned long len)
+{
+	unsigned long x;
+
+	if (!i915_has_memcpy_to_wc()) {
+		memcpy_toio(dst, src, len);
+		return;
+	}
+
+	x = min(ALIGN((unsigned long)dst, 16) - (unsigned long)dst, len);
+	memcpy_toio(dst, src, x);
+
+	len -= x;
+	dst += x;
+	src += x;
+
+	/* On x86, iomem is just as addressable by the streaming stores */
+	x = round_down(len, 16);
+	i915_memcpy_to_wc((void __force *)dst, src, x);
+	memcpy_toio(dst + x, src + x, len - x);
+}
+
 /**
  * i915_unaligned_memcpy_from_wc: perform a mostly accelerated read from WC
  * @dst: destination pointer
@@ -144,7 +454,16 @@ void i915_unaligned_memcpy_from_wc(void *dst, const void *src, unsigned long len
 	CI_BUG_ON(!i915_has_memcpy_from_wc());
 
 	addr = (unsigned long)src;
-	if (!IS_ALIGNED(addr, 16)) {
+	if (static_branch_likely(&has_avx2) && len >= 128 &&
+	    !IS_ALIGNED(addr, 32)) {
+		unsigned long x = ALIGN(addr, 32) - addr;
+
+		memcpy(dst, src, x);
+
+		len -= x;
+		dst += x;
+		src += x;
+	} else if (!IS_ALIGNED(addr, 16)) {
 		unsigned long x = min(ALIGN(addr, 16) - addr, len);
 
 		memcpy(dst, src, x);
@@ -154,7 +473,12 @@ void i915_unaligned_memcpy_from_wc(void *dst, const void *src, unsigned long len
 		src += x;
 	}
 
-	if (likely(len))
+	if (unlikely(!len))
+		return;
+
+	if (static_branch_likely(&has_avx2) && IS_ALIGNED((unsigned long)src, 32))
+		__memcpy_ntdqu_avx2(dst, src, DIV_ROUND_UP(len, 16));
+	else
 		__memcpy_ntdqu(dst, src, DIV_ROUND_UP(len, 16));
 }
 
@@ -164,7 +488,32 @@ void i915_memcpy_init_early(struct drm_i915_private *dev_priv)
 	 * Some hypervisors (e.g. KVM) don't support VEX-prefix instructions
 	 * emulation. So don't enable movntdqa in hypervisor guest.
 	 */
-	if (static_cpu_has(X86_FEATURE_XMM4_1) &&
-	    !boot_cpu_has(X86_FEATURE_HYPERVISOR))
+	if (boot_cpu_has(X86_FEATURE_HYPERVISOR))
+		return;
+
+	if (static_cpu_has(X86_FEATURE_XMM2))
+		static_branch_enable(&has_movntdq);
+
+	if (static_cpu_has(X86_FEATURE_XMM4_1))
 		static_branch_enable(&has_movntdqa);
+
+	/*
+	 * The wider variants are only used on top of the SSE paths, and only
+	 * if the OS has enabled saving of the extended register state.
+	 */
+	if (!static_cpu_has(X86_FEATURE_XMM4_1) ||
+	    !cpu_has_xfeatures(XFEATURE_MASK_SSE | XFEATURE_MASK_YMM, NULL))
+		return;
+
+	if (static_cpu_has(X86_FEATURE_AVX2))
+		static_branch_enable(&has_avx2);
+
+	if (IS_ENABLED(CONFIG_AS_AVX512) &&
+	    static_cpu_has(X86_FEATURE_AVX512F) &&
+	    cpu_has_xfeatures(XFEATURE_MASK_AVX512, NULL))
+		static_branch_enable(&has_avx512);
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#include "selftests/i915_memcpy.c"
+#endif
@@ -14,6 +14,8 @@ void i915_memcpy_init_early(struct drm_i915_private *i915);
 
 bool i915_memcpy_from_wc(void *dst, const void *src, unsigned long len);
 void i915_unaligned_memcpy_from_wc(void *dst, const void *src, unsigned long len);
+bool i915_memcpy_to_wc(void *dst, const void *src, unsigned long len);
+void i915_memcpy_toio(void __iomem *dst, const void *src, unsigned long len);
 
 /* The movntdqa instructions used for memcpy-from-wc require 16-byte alignment,
  * as well as SSE4.1 support. i915_memcpy_from_wc() will report if it cannot
@@ -31,4 +33,11 @@ void i915_unaligned_memcpy_from_wc(void *dst, const void *src, unsigned long len
 #define i915_has_memcpy_from_wc() \
 	i915_memcpy_from_wc(NULL, NULL, 0)
 
+/* Likewise, the movntdq streaming stores used for memcpy-to-wc require the
+ * destination to be 16-byte aligned, and SSE2 support.
+ * i915_memcpy_toio() takes care of the alignment itself.
+ */
+#define i915_has_memcpy_to_wc() \
+	i915_memcpy_to_wc(NULL, NULL, 0)
+
 #endif /* __I915_MEMCPY_H__ */
@@ -69,7 +69,7 @@
  * pairs, instead of a fixed struct with multiple miscellaneous config members,
  * interleaved with event-type specific members.
  *
- * i915 perf doesn't support exposing metrics via an mmap'd circular buffer.
+ * By default i915 perf doesn't expose metrics via an mmap'd circular buffer.
  * The supported metrics are being written to memory by the GPU unsynchronized
  * with the CPU, using HW specific packing formats for counter sets. Sometimes
  * the constraints on HW configuration require reports to be filtered before it
@@ -78,6 +78,13 @@
  * interface is a good fit, and provides an opportunity to filter data as it
  * gets copied from the GPU mapped buffers to userspace buffers.
  *
+ * Streams that aren't filtered have nothing to hide though, and at high
+ * sampling frequencies the copy dominates. Those can opt in to mapping the OA
+ * buffer read-only with DRM_I915_PERF_PROP_OA_BUFFER_MMAP, consuming reports
+ * in place and handing space back by advancing a head pointer in a shared
+ * control page. The kernel then only deals with buffer overflow and lost
+ * reports, which are still reported through read().
+ *
  *
  * Issues hit with first prototype based on Core Perf
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -357,6 +364,7 @@ static const u32 mtl_oa_base[] = {
  *        (see get_default_sseu_config())
  * @poll_oa_period: The period in nanoseconds at which the CPU will check for OA
  * data availability
+ * @oa_buffer_mmap: Whether userspace will mmap the OA buffer instead of read()
  *
  * As read_properties_unlocked() enumerates and validates the properties given
  * to open a stream of metrics the configuration is built up in the structure
@@ -381,6 +389,8 @@ struct perf_open_properties {
 	struct intel_sseu sseu;
 
 	u64 poll_oa_period;
+
+	bool oa_buffer_mmap;
 };
 
 struct i915_oa_config_bo {
@@ -516,6 +526,115 @@ static void oa_context_id_squash(struct i915_perf_stream *stream, u32 *report)
 		report[2] = INVALID_CTX_ID;
 }
 
+static void oa_report_clear(struct i915_perf_stream *stream, u8 *report)
+{
+	int report_size = stream->oa_buffer.format->size;
+
+	if (is_power_of_2(report_size)) {
+		/*
+		 * Clear out the report id and timestamp as a means
+		 * to detect unlanded reports.
+		 */
+		oa_report_id_clear(stream, (u32 *)report);
+		oa_timestamp_clear(stream, (u32 *)report);
+	} else {
+		u8 *oa_buf_base = stream->oa_buffer.vaddr;
+		u32 part = oa_buf_base + OA_BUFFER_SIZE - report;
+
+		/* Zero out the entire report */
+		if (report_size <= part) {
+			memset(report, 0, report_size);
+		} else {
+			memset(report, 0, part);
+			memset(oa_buf_base, 0, report_size - part);
+		}
+	}
+}
+
+static void oa_head_ptr_write(struct i915_perf_stream *stream, u32 head)
+{
+	u32 gtt_offset = i915_ggtt_offset(stream->oa_buffer.vma);
+	i915_reg_t oaheadptr;
+
+	lockdep_assert_held(&stream->oa_buffer.ptr_lock);
+
+	oaheadptr = GRAPHICS_VER(stream->perf->i915) == 12 ?
+		    __oa_regs(stream)->oa_head_ptr :
+		    GEN8_OAHEADPTR;
+
+	/*
+	 * We index relative to oa_buf_base everywhere else, so put back the
+	 * gtt_offset here...
+	 */
+	intel_uncore_write(stream->uncore, oaheadptr,
+			   (head + gtt_offset) & GEN12_OAG_OAHEADPTR_MASK);
+	stream->oa_buffer.head = head;
+}
+
+/* Userspace may only hand back whole reports that we gave it */
+static bool oa_mmap_head_valid(struct i915_perf_stream *stream,
+			       u32 head, u32 new_head)
+{
+	int report_size = stream->oa_buffer.format->size;
+	u32 tail = stream->oa_buffer.tail;
+
+	lockdep_assert_held(&stream->oa_buffer.ptr_lock);
+
+	return new_head != head &&
+	       new_head < OA_BUFFER_SIZE &&
+	       !(OA_TAKEN(new_head, head) % report_size) &&
+	       OA_TAKEN(new_head, head) <= OA_TAKEN(tail, head);
+}
+
+/*
+ * With the OA buffer mapped, userspace consumes the reports in place and
+ * only tells us how far it got by advancing the head in the control page.
+ * Clear what it consumed, so that oa_buffer_check_unlocked() can still spot
+ * unlanded reports, and hand the space back to the OA unit.
+ *
+ * Until the new head is written, the consumed reports belong to neither
+ * userspace nor the OA unit, so they are cleared outside of the ptr_lock.
+ * Clearing is idempotent, a concurrent update only has to avoid moving the
+ * head backwards, and the buffer reset clears everything anyway.
+ */
+static void oa_mmap_update_head(struct i915_perf_stream *stream)
+{
+	int report_size = stream->oa_buffer.format->size;
+	u32 head, new_head, pos;
+	unsigned long flags;
+	bool valid;
+
+	new_head = READ_ONCE(stream->oa_buffer.mmap->head);
+
+	spin_lock_irqsave(&stream->oa_buffer.ptr_lock, flags);
+	head = stream->oa_buffer.head;
+	valid = oa_mmap_head_valid(stream, head, new_head);
+	spin_unlock_irqrestore(&stream->oa_buffer.ptr_lock, flags);
+	if (!valid)
+		return;
+
+	for (pos = head; pos != new_head;
+	     pos = (pos + report_size) & (OA_BUFFER_SIZE - 1))
+		oa_report_clear(stream, stream->oa_buffer.vaddr + pos);
+
+	spin_lock_irqsave(&stream->oa_buffer.ptr_lock, flags);
+	if (stream->oa_buffer.head == head &&
+	    oa_mmap_head_valid(stream, head, new_head))
+		oa_head_ptr_write(stream, new_head);
+	spin_unlock_irqrestore(&stream->oa_buffer.ptr_lock, flags);
+}
+
+static void oa_mmap_reset(struct i915_perf_stream *stream)
+{
+	lockdep_assert_held(&stream->oa_buffer.ptr_lock);
+
+	if (!stream->oa_buffer.mmap)
+		return;
+
+	WRITE_ONCE(stream->oa_buffer.mmap->head, 0);
+	WRITE_ONCE(stream->oa_buffer.mmap->tail, 0);
+}
+
 /**
  * oa_buffer_check_unlocked - check for data and update tail ptr state
  * @stream: i915 stream instance
@@ -552,6 +671,9 @@ static bool oa_buffer_check_unlocked(struct i915_perf_stream *stream)
 	 * could result in an OA buffer reset which might reset the head and
 	 * tail state.
 	 */
+	if (stream->oa_buffer.mmap)
+		oa_mmap_update_head(stream);
+
 	spin_lock_irqsave(&stream->oa_buffer.ptr_lock, flags);
 
 	hw_tail = stream->perf->ops.oa_hw_tail_read(stream);
@@ -598,6 +720,10 @@ static bool oa_buffer_check_unlocked(struct i915_perf_stream *stream)
 
 	stream->oa_buffer.tail = tail;
 
+	/* Everything up to the tail has landed, see above */
+	if (stream->oa_buffer.mmap)
+		smp_store_release(&stream->oa_buffer.mmap->tail, tail);
+
 	pollin = OA_TAKEN(stream->oa_buffer.tail,
 			  stream->oa_buffer.head) >= report_size;
 
@@ -729,7 +855,6 @@ static int gen8_append_oa_reports(struct i915_perf_stream *stream,
 	struct intel_uncore *uncore = stream->uncore;
 	int report_size = stream->oa_buffer.format->size;
 	u8 *oa_buf_base = stream->oa_buffer.vaddr;
-	u32 gtt_offset = i915_ggtt_offset(stream->oa_buffer.vma);
 	u32 mask = (OA_BUFFER_SIZE - 1);
 	size_t start_offset = *offset;
 	unsigned long flags;
@@ -875,45 +1000,12 @@ static int gen8_append_oa_reports(struct i915_perf_stream *stream,
 			stream->oa_buffer.last_ctx_id = ctx_id;
 		}
 
-		if (is_power_of_2(report_size)) {
-			/*
-			 * Clear out the report id and timestamp as a means
-			 * to detect unlanded reports.
-			 */
-			oa_report_id_clear(stream, report32);
-			oa_timestamp_clear(stream, report32);
-		} else {
-			u8 *oa_buf_end = stream->oa_buffer.vaddr +
-					 OA_BUFFER_SIZE;
-			u32 part = oa_buf_end - (u8 *)report32;
-
-			/* Zero out the entire report */
-			if (report_size <= part) {
-				memset(report32, 0, report_size);
-			} else {
-				memset(report32, 0, part);
-				memset(oa_buf_base, 0, report_size - part);
-			}
-		}
+		oa_report_clear(stream, report);
 	}
 
 	if (start_offset != *offset) {
-		i915_reg_t oaheadptr;
-
-		oaheadptr = GRAPHICS_VER(stream->perf->i915) == 12 ?
-			    __oa_regs(stream)->oa_head_ptr :
-			    GEN8_OAHEADPTR;
-
 		spin_lock_irqsave(&stream->oa_buffer.ptr_lock, flags);
-
-		/*
-		 * We removed the gtt_offset for the copy loop above, indexing
-		 * relative to oa_buf_base so put back here...
-		 */
-		intel_uncore_write(uncore, oaheadptr,
-				   (head + gtt_offset) & GEN12_OAG_OAHEADPTR_MASK);
-		stream->oa_buffer.head = head;
-
+		oa_head_ptr_write(stream, head);
 		spin_unlock_irqrestore(&stream->oa_buffer.ptr_lock, flags);
 	}
 
@@ -931,6 +1023,9 @@ static int gen8_append_oa_reports(struct i915_perf_stream *stream,
  * status records for userspace (such as for a buffer full condition) and then
  * initiate appending any buffered OA reports.
  *
+ * If userspace has mapped the OA buffer, the reports are left for it to
+ * consume in place and only the status records are copied.
+ *
  * Updates @offset according to the number of bytes successfully copied into
  * the userspace buffer.
  *
@@ -1007,6 +1102,12 @@ static int gen8_oa_read(struct i915_perf_stream *stream,
 				  GEN8_OASTATUS_TAIL_POINTER_WRAP) : 0);
 	}
 
+	if (stream->oa_buffer.mmap) {
+		/* Pick up the latest head, rather than wait for the hrtimer */
+		oa_buffer_check_unlocked(stream);
+		return 0;
+	}
+
 	return gen8_append_oa_reports(stream, buf, count, offset);
 }
 
@@ -1630,6 +1731,9 @@ free_oa_buffer(struct i915_perf_stream *stream)
 				   I915_VMA_RELEASE_MAP);
 
 	stream->oa_buffer.vaddr = NULL;
+
+	free_page((unsigned long)stream->oa_buffer.mmap);
+	stream->oa_buffer.mmap = NULL;
 }
 
 static void
@@ -1766,6 +1870,7 @@ static void gen8_init_oa_buffer(struct i915_perf_stream *stream)
 
 	/* Mark that we need updated tail pointers to read from... */
 	stream->oa_buffer.tail = 0;
+	oa_mmap_reset(stream);
 
 	/*
 	 * Reset state used to recognise context switches, affecting which
@@ -1819,6 +1924,7 @@ static void gen12_init_oa_buffer(struct i915_perf_stream *stream)
 
 	/* Mark that we need updated tail pointers to read from... */
 	stream->oa_buffer.tail = 0;
+	oa_mmap_reset(stream);
 
 	/*
 	 * Reset state used to recognise context switches, affecting which
@@ -1907,6 +2013,23 @@ static int alloc_oa_buffer(struct i915_perf_stream *stream)
 	return ret;
 }
 
+static int alloc_oa_mmap(struct i915_perf_stream *stream)
+{
+	struct drm_i915_perf_oa_buffer_mmap *ctl;
+
+	ctl = (void *)get_zeroed_page(GFP_KERNEL);
+	if (!ctl)
+		return -ENOMEM;
+
+	ctl->size = OA_BUFFER_SIZE;
+	ctl->report_size = stream->oa_buffer.format->size;
+	ctl->offset = PAGE_SIZE;
+
+	stream->oa_buffer.mmap = ctl;
+
+	return 0;
+}
+
 static u32 *save_restore_register(struct i915_perf_stream *stream, u32 *cs,
 				  bool save, i915_reg_t reg, u32 offset,
 				  u32 dword_count)
@@ -3299,6 +3422,21 @@ static int i915_oa_stream_init(struct i915_perf_stream *stream,
 		return -ENODEV;
 	}
 
+	if (props->oa_buffer_mmap) {
+		if (GRAPHICS_VER(perf->i915) < 8) {
+			drm_dbg(&stream->perf->i915->drm,
+				"OA buffer mmap not supported\n");
+			return -ENODEV;
+		}
+
+		/* Reports of other contexts can't be hidden once mapped */
+		if (stream->ctx || !(props->sample_flags & SAMPLE_OA_REPORT)) {
+			drm_dbg(&stream->perf->i915->drm,
+				"OA buffer mmap requires an unfiltered OA stream\n");
+			return -EINVAL;
+		}
+	}
+
 	/*
 	 * To avoid the complexity of having to accurately filter
 	 * counter reports and marshal to the appropriate client
@@ -3377,6 +3515,14 @@ static int i915_oa_stream_init(struct i915_perf_stream *stream,
 	if (ret)
 		goto err_oa_buf_alloc;
 
+	if (props->oa_buffer_mmap) {
+		ret = alloc_oa_mmap(stream);
+		if (ret) {
+			free_oa_buffer(stream);
+			goto err_oa_buf_alloc;
+		}
+	}
+
 	stream->ops = &i915_oa_stream_ops;
 
 	stream->engine->gt->perf.sseu = props->sseu;
@@ -3472,7 +3618,8 @@ static ssize_t i915_perf_read(struct file *file,
 	if (!stream->enabled || !(stream->sample_flags & SAMPLE_OA_REPORT))
 		return -EIO;
 
-	if (!(file->f_flags & O_NONBLOCK)) {
+	/* With the OA buffer mapped there may never be anything to read() */
+	if (!(file->f_flags & O_NONBLOCK) && !stream->oa_buffer.mmap) {
 		/* There's the small chance of false positives from
 		 * stream->ops->wait_unlocked.
 		 *
@@ -3782,6 +3929,68 @@ static int i915_perf_release(struct inode *inode, struct file *file)
 	return 0;
 }
 
+/**
+ * i915_perf_mmap - handles mmap() of a stream opened with
+ * `DRM_I915_PERF_PROP_OA_BUFFER_MMAP`
+ * @file: An i915 perf stream file
+ * @vma: The userspace mapping
+ *
+ * Offset 0 maps the &struct drm_i915_perf_oa_buffer_mmap control page
+ * read-write, the offset advertised in it maps the whole OA buffer read-only.
+ * Both stay valid for as long as the mapping keeps the stream file open.
+ *
+ * Returns: zero on success or a negative error code.
+ */
+static int i915_perf_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct i915_perf_stream *stream = file->private_data;
+	struct drm_i915_perf_oa_buffer_mmap *ctl = stream->oa_buffer.mmap;
+	unsigned long size = vma->vm_end - vma->vm_start;
+	unsigned long addr = vma->vm_start;
+	struct sgt_iter iter;
+	struct page *page;
+	int err;
+
+	if (!ctl)
+		return -ENODEV;
+
+	vm_flags_set(vma, VM_DONTEXPAND | VM_DONTDUMP);
+	vm_flags_clear(vma, VM_MAYEXEC);
+
+	if (vma->vm_pgoff == 0) {
+		if (size != PAGE_SIZE)
+			return -EINVAL;
+
+		return vm_insert_page(vma, addr, virt_to_page(ctl));
+	}
+
+	if (vma->vm_pgoff != ctl->offset >> PAGE_SHIFT || size != ctl->size)
+		return -EINVAL;
+
+	/* Only the head in the control page is for userspace to move */
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	/*
+	 * The OA buffer pages belong to the object's backing store and are
+	 * not ours to refcount through vm_insert_page(); on discrete, TTM
+	 * hands out the tail pages of non-compound higher order allocations.
+	 * Map them as raw PFNs instead, like xe does. The object stays pinned
+	 * for the lifetime of the stream, which outlives the mapping.
+	 */
+	vm_flags_mod(vma, VM_PFNMAP, VM_MAYWRITE);
+
+	for_each_sgt_page(page, iter, stream->oa_buffer.vma->obj->mm.pages) {
+		err = remap_pfn_range(vma, addr, page_to_pfn(page), PAGE_SIZE,
+				      vma->vm_page_prot);
+		if (err)
+			return err;
+
+		addr += PAGE_SIZE;
+	}
+
+	return 0;
+}
 
 static const struct file_operations fops = {
 	.owner		= THIS_MODULE,
@@ -3789,6 +3998,7 @@ static const struct file_operations fops = {
 	.release	= i915_perf_release,
 	.poll		= i915_perf_poll,
 	.read		= i915_perf_read,
+	.mmap		= i915_perf_mmap,
 	.unlocked_ioctl	= i915_perf_ioctl,
 	/* Our ioctl have no arguments, so it's safe to use the same function
 	 * to handle 32bits compatibility.
@@ -4122,6 +4332,9 @@ static int read_properties_unlocked(struct i915_perf *perf,
 		case DRM_I915_PERF_PROP_HOLD_PREEMPTION:
 			props->hold_preemption = !!value;
 			break;
+		case DRM_I915_PERF_PROP_OA_BUFFER_MMAP:
+			props->oa_buffer_mmap = !!value;
+			break;
 		case DRM_I915_PERF_PROP_GLOBAL_SSEU: {
 			if (GRAPHICS_VER_FULL(perf->i915) >= IP_VER(12, 50)) {
 				drm_dbg(&perf->i915->drm,
@@ -5285,6 +5498,9 @@ int i915_perf_ioctl_version(struct drm_i915_private *i915)
 	 *    DRM_I915_PERF_PROP_OA_ENGINE_INSTANCE
 	 *
 	 * 7: Add support for video decode and enhancement classes.
+	 *
+	 * 8: Add DRM_I915_PERF_PROP_OA_BUFFER_MMAP to consume reports from a
+	 *    read-only mapping of the OA buffer instead of read().
 	 */
 
 	/*
@@ -5296,7 +5512,7 @@ int i915_perf_ioctl_version(struct drm_i915_private *i915)
 	    intel_check_bios_c6_setup(&i915->media_gt->rc6))
 		return 6;
 
-	return 7;
+	return 8;
 }
 
 #if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
@@ -328,6 +328,12 @@ struct i915_perf_stream {
 		 * read by userspace.
 		 */
 		u32 tail;
+
+		/**
+		 * @oa_buffer.mmap: Control page shared with userspace when
+		 * the OA buffer is mapped rather than read(), else NULL.
+		 */
+		struct drm_i915_perf_oa_buffer_mmap *mmap;
 	} oa_buffer;
 
 	/**
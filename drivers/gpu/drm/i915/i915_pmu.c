@@ -137,14 +137,32 @@ static unsigned int event_bit(struct perf_event *event)
 	return config_bit(event->attr.config);
 }
 
-static u32 frequency_enabled_mask(void)
+static bool req_freq_needs_sampling(struct intel_gt *gt)
 {
+	/*
+	 * With host RPS, we know when the requested frequency changes and
+	 * account for it there. SLPC changes it behind our back.
+	 */
+	return intel_uc_uses_guc_slpc(&gt->uc);
+}
+
+static u32 frequency_sampled_mask(struct i915_pmu *pmu)
+{
+	struct drm_i915_private *i915 = pmu_to_i915(pmu);
+	struct intel_gt *gt;
 	unsigned int i;
 	u32 mask = 0;
 
-	for (i = 0; i < I915_PMU_MAX_GT; i++)
-		mask |= config_mask(__I915_PMU_ACTUAL_FREQUENCY(i)) |
-			config_mask(__I915_PMU_REQUESTED_FREQUENCY(i));
+	/*
+	 * The actual frequency is chosen by the HW, which has no counter
+	 * integrating it over time, so it still needs the sampling timer.
+	 * Only the requested frequency is accounted as it changes.
+	 */
+	for_each_gt(gt, i915, i) {
+		mask |= config_mask(__I915_PMU_ACTUAL_FREQUENCY(i));
+		if (req_freq_needs_sampling(gt))
+			mask |= config_mask(__I915_PMU_REQUESTED_FREQUENCY(i));
+	}
 
 	return mask;
 }
@@ -165,7 +183,7 @@ static bool pmu_needs_timer(struct i915_pmu *pmu)
 	 * Mask out all the ones which do not need the timer, or in
 	 * other words keep all the ones that could need the timer.
 	 */
-	enable &= frequency_enabled_mask() | ENGINE_SAMPLE_MASK;
+	enable &= frequency_sampled_mask(pmu) | ENGINE_SAMPLE_MASK;
 
 	/*
 	 * Also there is software busyness tracking available we do not
@@ -287,6 +305,66 @@ static void park_rc6(struct intel_gt *gt)
 	pmu->sleep_last[gt->info.id] = ktime_get_raw();
 }
 
+static void __req_freq_update(struct i915_pmu *pmu, struct intel_gt *gt,
+			      bool awake)
+{
+	struct i915_pmu_freq *f = &pmu->freq[gt->info.id];
+	u32 req = 0;
+	ktime_t now;
+
+	lockdep_assert_held(&pmu->lock);
+
+	/* Report 0 requested frequency while parked. */
+	if (awake)
+		req = intel_rps_get_requested_frequency(&gt->rps);
+
+	write_seqcount_begin(&f->seq);
+
+	now = ktime_get();
+	f->req_accum += (u64)f->req * ktime_us_delta(now, f->last);
+	f->last = now;
+	f->req = req;
+
+	write_seqcount_end(&f->seq);
+}
+
+static u64 read_req_freq(struct i915_pmu *pmu, struct intel_gt *gt)
+{
+	struct i915_pmu_freq *f = &pmu->freq[gt->info.id];
+	unsigned int seq;
+	u64 val;
+
+	do {
+		seq = read_seqcount_begin(&f->seq);
+
+		val = f->req_accum + (u64)f->req *
+		      ktime_us_delta(ktime_get(), f->last);
+	} while (read_seqcount_retry(&f->seq, seq));
+
+	return div_u64(val, USEC_PER_SEC /* to MHz */);
+}
+
+/**
+ * i915_pmu_gt_freq_changed - account for a new requested frequency
+ * @gt: the GT whose RPS frequency was just changed
+ */
+void i915_pmu_gt_freq_changed(struct intel_gt *gt)
+{
+	struct i915_pmu *pmu = &gt->i915->pmu;
+	unsigned long flags;
+
+	if (!pmu->base.event_init || req_freq_needs_sampling(gt))
+		return;
+
+	spin_lock_irqsave(&pmu->lock, flags);
+
+	/* Unparking accounts for whatever was set before it */
+	if (pmu->unparked & BIT(gt->info.id))
+		__req_freq_update(pmu, gt, true);
+
+	spin_unlock_irqrestore(&pmu->lock, flags);
+}
+
 static void __i915_pmu_maybe_start_timer(struct i915_pmu *pmu)
 {
 	if (!pmu->timer_enabled && pmu_needs_timer(pmu)) {
@@ -309,6 +387,9 @@ void i915_pmu_gt_parked(struct intel_gt *gt)
 
 	park_rc6(gt);
 
+	if (!req_freq_needs_sampling(gt))
+		__req_freq_update(pmu, gt, false);
+
 	/*
 	 * Signal sampling timer to stop if only engine events are enabled and
 	 * GPU went idle.
@@ -337,6 +418,9 @@ void i915_pmu_gt_unparked(struct intel_gt *gt)
 
 	pmu->unparked |= BIT(gt->info.id);
 
+	if (!req_freq_needs_sampling(gt))
+		__req_freq_update(pmu, gt, true);
+
 	spin_unlock_irq(&pmu->lock);
 }
 
@@ -469,7 +553,8 @@ frequency_sample(struct intel_gt *gt, unsigned int period_ns)
 				val, period_ns / 1000);
 	}
 
-	if (pmu->enable & config_mask(__I915_PMU_REQUESTED_FREQUENCY(gt_id))) {
+	if (pmu->enable & config_mask(__I915_PMU_REQUESTED_FREQUENCY(gt_id)) &&
+	    req_freq_needs_sampling(gt)) {
 		add_sample_mult(pmu, gt_id, __I915_SAMPLE_FREQ_REQ,
 				intel_rps_get_requested_frequency(rps),
 				period_ns / 1000);
@@ -673,10 +758,13 @@ static u64 __i915_pmu_event_read(struct perf_event *event)
 				   USEC_PER_SEC /* to MHz */);
 			break;
 		case I915_PMU_REQUESTED_FREQUENCY:
-			val =
-			   div_u64(read_sample(pmu, gt_id,
-					       __I915_SAMPLE_FREQ_REQ),
-				   USEC_PER_SEC /* to MHz */);
+			if (!req_freq_needs_sampling(i915->gt[gt_id]))
+				val = read_req_freq(pmu, i915->gt[gt_id]);
+			else
+				val =
+				   div_u64(read_sample(pmu, gt_id,
+						       __I915_SAMPLE_FREQ_REQ),
+					   USEC_PER_SEC /* to MHz */);
 			break;
 		case I915_PMU_INTERRUPTS:
 			val = READ_ONCE(pmu->irq_count);
@@ -1253,6 +1341,7 @@ void i915_pmu_register(struct drm_i915_private *i915)
 		NULL
 	};
 
+	unsigned int i;
 	int ret = -ENOMEM;
 
 	if (GRAPHICS_VER(i915) <= 2) {
@@ -1261,6 +1350,8 @@ void i915_pmu_register(struct drm_i915_private *i915)
 	}
 
 	spin_lock_init(&pmu->lock);
+	for (i = 0; i < ARRAY_SIZE(pmu->freq); i++)
+		seqcount_init(&pmu->freq[i].seq);
 	hrtimer_init(&pmu->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
 	pmu->timer.function = i915_sample;
 	pmu->cpuhp.cpu = -1;
@@ -9,6 +9,7 @@
 
 #include <linux/hrtimer.h>
 #include <linux/perf_event.h>
+#include <linux/seqlock.h>
 #include <linux/spinlock_types.h>
 #include <uapi/drm/i915_drm.h>
 
@@ -55,6 +56,29 @@ struct i915_pmu_sample {
 	u64 cur;
 };
 
+/*
+ * Requested frequency residency accumulated at RPS change points and
+ * park/unpark transitions, instead of being sampled from the timer.
+ */
+struct i915_pmu_freq {
+	/**
+	 * @seq: Lets readers snapshot the state, writers hold pmu->lock.
+	 */
+	seqcount_t seq;
+	/**
+	 * @last: When @req last changed.
+	 */
+	ktime_t last;
+	/**
+	 * @req: Requested frequency in MHz since @last, 0 while parked.
+	 */
+	u32 req;
+	/**
+	 * @req_accum: Sum of requested frequency over time up to @last, MHz*us.
+	 */
+	u64 req_accum;
+};
+
 struct i915_pmu {
 	/**
 	 * @cpuhp: Struct used for CPU hotplug handling.
@@ -128,6 +152,13 @@ struct i915_pmu {
 	 * struct intel_engine_cs.
 	 */
 	struct i915_pmu_sample sample[I915_PMU_MAX_GT][__I915_NUM_PMU_SAMPLERS];
+	/**
+	 * @freq: Event driven requested frequency counters, for when the
+	 * driver controls RPS and so knows when the requested frequency
+	 * changes. The actual frequency, and the requested one with SLPC,
+	 * are still sampled into @sample.
+	 */
+	struct i915_pmu_freq freq[I915_PMU_MAX_GT];
 	/**
 	 * @sleep_last: Last time GT parked for RC6 estimation.
 	 */
@@ -161,6 +192,7 @@ void i915_pmu_register(struct drm_i915_private *i915);
 void i915_pmu_unregister(struct drm_i915_private *i915);
 void i915_pmu_gt_parked(struct intel_gt *gt);
 void i915_pmu_gt_unparked(struct intel_gt *gt);
+void i915_pmu_gt_freq_changed(struct intel_gt *gt);
 #else
 static inline int i915_pmu_init(void) { return 0; }
 static inline void i915_pmu_exit(void) {}
@@ -168,6 +200,7 @@ static inline void i915_pmu_register(struct drm_i915_private *i915) {}
 static inline void i915_pmu_unregister(struct drm_i915_private *i915) {}
 static inline void i915_pmu_gt_parked(struct intel_gt *gt) {}
 static inline void i915_pmu_gt_unparked(struct intel_gt *gt) {}
+static inline void i915_pmu_gt_freq_changed(struct intel_gt *gt) {}
 #endif
 
 #endif
@@ -1899,10 +1899,118 @@ static bool busywait_stop(unsigned long timeout, unsigned int cpu)
 	return this_cpu != cpu;
 }
 
+/*
+ * Waits are bucketed by how long the request took to complete once the
+ * waiter found it running: bucket 0 is under ~1us, bucket n under ~2^n us,
+ * and the last bucket is everything longer.
+ */
+#define WAIT_HIST_MIN_SAMPLES 8
+#define WAIT_HIST_MAX_SAMPLES 64
+
+static unsigned long wait_bucket_ns(unsigned int n)
+{
+	return BIT(n) << 10;
+}
+
+static unsigned int wait_bucket(u64 ns)
+{
+	u64 us = ns >> 10;
+
+	return min_t(unsigned int, us ? ilog2(us) + 1 : 0,
+		     INTEL_ENGINE_WAIT_BUCKETS - 1);
+}
+
+static void wait_hist_record(struct intel_engine_wait_hist *h, u64 ns)
+{
+	unsigned int total = 0, n;
+
+	for (n = 0; n < INTEL_ENGINE_WAIT_BUCKETS; n++)
+		total += READ_ONCE(h->count[n]);
+
+	/* Decay the history so that we follow changes in the workload */
+	if (total >= WAIT_HIST_MAX_SAMPLES) {
+		for (n = 0; n < INTEL_ENGINE_WAIT_BUCKETS; n++)
+			WRITE_ONCE(h->count[n], READ_ONCE(h->count[n]) / 2);
+	}
+
+	n = wait_bucket(ns);
+	WRITE_ONCE(h->count[n], READ_ONCE(h->count[n]) + 1);
+}
+
+static unsigned long
+wait_hist_budget(const struct intel_engine_wait_hist *h, unsigned long max)
+{
+	unsigned int count[INTEL_ENGINE_WAIT_BUCKETS];
+	unsigned int total = 0, sum = 0, n;
+
+	for (n = 0; n < INTEL_ENGINE_WAIT_BUCKETS; n++) {
+		count[n] = READ_ONCE(h->count[n]);
+		total += count[n];
+	}
+
+	/* Until we know better, keep to the fixed budget */
+	if (total < WAIT_HIST_MIN_SAMPLES)
+		return max;
+
+	for (n = 0; n < INTEL_ENGINE_WAIT_BUCKETS - 1; n++) {
+		unsigned long bound = wait_bucket_ns(n);
+
+		sum += count[n];
+		if (bound > max)
+			break;
+
+		/* Spin only as long as it takes to catch most completions */
+		if (8 * sum >= 7 * total)
+			return bound;
+	}
+
+	/* Spin for the full budget only if it often pays off */
+	return 2 * sum >= total ? max : 0;
+}
+
+/*
+ * Once the request completes, it may be retired and drop the last reference
+ * to its context, and to a virtual engine along with it, before the waiter
+ * gets around to recording the sample. So look up where the sample goes up
+ * front, while the request is still running, and only ever keep it on a
+ * physical engine, which lives as long as the device.
+ */
+static struct intel_engine_wait_hist *wait_hist_get(struct i915_request *rq)
+{
+	struct intel_engine_cs *engine;
+
+	rcu_read_lock(); /* the engine is alive until the request is retired */
+	engine = READ_ONCE(rq->engine);
+	if (!i915_request_is_running(rq) ||
+	    i915_request_completed(rq) ||
+	    intel_engine_is_virtual(engine))
+		engine = NULL;
+	rcu_read_unlock();
+
+	return engine ? &engine->busywait.hist : NULL;
+}
+
+static void wait_record(struct i915_request *rq,
+			struct intel_engine_wait_hist *hist,
+			ktime_t start)
+{
+	ktime_t end;
+
+	if (test_bit(DMA_FENCE_FLAG_TIMESTAMP_BIT, &rq->fence.flags))
+		end = rq->fence.timestamp;
+	else
+		end = ktime_get();
+
+	wait_hist_record(hist,
+			 max_t(s64, ktime_to_ns(ktime_sub(end, start)), 0));
+}
+
 static bool __i915_spin_request(struct i915_request * const rq, int state)
 {
-	unsigned long timeout_ns;
+	struct intel_engine_cs *engine = rq->engine;
+	unsigned long timeout_ns, start_ns;
 	unsigned int cpu;
+	bool completed = false;
 
 	/*
 	 * Only wait for the request if we know it is likely to complete.
@@ -1927,13 +2035,28 @@ static bool __i915_spin_request(struct i915_request * const rq, int state)
 	 * if it is a slow request, we want to sleep as quickly as possible.
 	 * The tradeoff between waiting and sleeping is roughly the time it
 	 * takes to sleep on a request, on the order of a microsecond.
+	 *
+	 * With CONFIG_DRM_I915_ADAPTIVE_BUSYWAIT, we use the history of how
+	 * long previous waits on this engine took to trim the spin, or to
+	 * skip it entirely if the request is unlikely to complete in time.
 	 */
 
-	timeout_ns = READ_ONCE(rq->engine->props.max_busywait_duration_ns);
-	timeout_ns += local_clock_ns(&cpu);
+	timeout_ns = READ_ONCE(engine->props.max_busywait_duration_ns);
+	if (IS_ENABLED(CONFIG_DRM_I915_ADAPTIVE_BUSYWAIT))
+		timeout_ns = wait_hist_budget(&engine->busywait.hist,
+					      timeout_ns);
+	if (!timeout_ns) {
+		atomic_long_inc(&engine->busywait.skips);
+		return false;
+	}
+
+	start_ns = local_clock_ns(&cpu);
+	timeout_ns += start_ns;
 	do {
-		if (dma_fence_is_signaled(&rq->fence))
-			return true;
+		if (dma_fence_is_signaled(&rq->fence)) {
+			completed = true;
+			break;
+		}
 
 		if (signal_pending_state(state, current))
 			break;
@@ -1944,7 +2067,13 @@ static bool __i915_spin_request(struct i915_request * const rq, int state)
 		cpu_relax();
 	} while (!need_resched());
 
-	return false;
+	atomic_long_inc(&engine->busywait.spins);
+	if (completed)
+		atomic_long_inc(&engine->busywait.hits);
+	atomic64_add(local_clock_ns(&cpu) - start_ns,
+		     &engine->busywait.spin_ns);
+
+	return completed;
 }
 
 struct request_wait {
@@ -1984,7 +2113,9 @@ long i915_request_wait_timeout(struct i915_request *rq,
 {
 	const int state = flags & I915_WAIT_INTERRUPTIBLE ?
 		TASK_INTERRUPTIBLE : TASK_UNINTERRUPTIBLE;
+	struct intel_engine_wait_hist *hist = NULL;
 	struct request_wait wait;
+	ktime_t start = 0;
 
 	might_sleep();
 	GEM_BUG_ON(timeout < 0);
@@ -2026,8 +2157,15 @@ long i915_request_wait_timeout(struct i915_request *rq,
 	 * polling". The suggestion there is to sleep until just before you
 	 * expect to be woken by the device interrupt and then poll for its
 	 * completion. That requires having a good predictor for the request
-	 * duration, which we currently lack.
+	 * duration; the closest we have is how long waits on this engine
+	 * have taken before, see wait_hist_budget().
 	 */
+	if (IS_ENABLED(CONFIG_DRM_I915_ADAPTIVE_BUSYWAIT)) {
+		hist = wait_hist_get(rq);
+		if (hist)
+			start = ktime_get();
+	}
+
 	if (CONFIG_DRM_I915_MAX_REQUEST_BUSYWAIT &&
 	    __i915_spin_request(rq, state))
 		goto out;
@@ -2094,6 +2232,9 @@ long i915_request_wait_timeout(struct i915_request *rq,
 	GEM_BUG_ON(!list_empty(&wait.cb.node));
 
 out:
+	if (hist && dma_fence_is_signaled(&rq->fence))
+		wait_record(rq, hist, start);
+
 	mutex_release(&rq->engine->gt->reset.mutex.dep_map, _THIS_IP_);
 	trace_i915_request_wait_end(rq);
 	return timeout;
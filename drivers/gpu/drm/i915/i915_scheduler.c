@@ -4,6 +4,7 @@
  * Copyright © 2018 Intel Corporation
  */
 
+#include <linux/list_sort.h>
 #include <linux/mutex.h>
 
 #include "i915_drv.h"
@@ -286,18 +287,110 @@ static void __i915_schedule(struct i915_sched_node *node,
 	spin_unlock(&sched_engine->lock);
 }
 
+static bool defer_schedule(struct i915_request *rq,
+			   const struct i915_sched_attr *attr)
+{
+	struct i915_sched_node *node = &rq->sched;
+	struct i915_sched_engine *sched_engine = NULL;
+	unsigned long flags;
+
+	/*
+	 * A request must be assigned its priority before it is first
+	 * queued (see __i915_schedule), so only boosts are deferred.
+	 */
+	if (READ_ONCE(node->attr.priority) == I915_PRIORITY_INVALID)
+		return false;
+
+	spin_lock_irqsave(&schedule_lock, flags);
+	if (attr->priority > max(node->attr.priority, node->boost) &&
+	    !node_signaled(node)) {
+		if (list_empty(&node->boost_link)) {
+			sched_engine = READ_ONCE(rq->engine)->sched_engine;
+			list_add_tail(&node->boost_link, &sched_engine->boosts);
+		}
+		node->boost = attr->priority;
+	}
+	spin_unlock_irqrestore(&schedule_lock, flags);
+
+	if (sched_engine)
+		tasklet_hi_schedule(&sched_engine->tasklet);
+
+	return true;
+}
+
 void i915_schedule(struct i915_request *rq, const struct i915_sched_attr *attr)
 {
+	if (IS_ENABLED(CONFIG_DRM_I915_DEFERRED_PRIORITY) &&
+	    defer_schedule(rq, attr))
+		return;
+
 	spin_lock_irq(&schedule_lock);
 	__i915_schedule(&rq->sched, attr);
 	spin_unlock_irq(&schedule_lock);
 }
 
+static int boost_cmp(void *priv,
+		     const struct list_head *A, const struct list_head *B)
+{
+	const struct i915_sched_node *a =
+		list_entry(A, typeof(*a), boost_link);
+	const struct i915_sched_node *b =
+		list_entry(B, typeof(*b), boost_link);
+
+	return (a->boost < b->boost) - (a->boost > b->boost);
+}
+
+/**
+ * i915_sched_engine_flush_boosts - propagate the deferred priority boosts
+ * @sched_engine: the schedule engine
+ *
+ * Called from the submission tasklet to apply all the priority boosts
+ * queued against @sched_engine since its last run.
+ */
+void i915_sched_engine_flush_boosts(struct i915_sched_engine *sched_engine)
+{
+	unsigned long flags;
+	LIST_HEAD(batch);
+
+	if (list_empty(&sched_engine->boosts))
+		return;
+
+	spin_lock_irqsave(&schedule_lock, flags);
+	list_splice_init(&sched_engine->boosts, &batch);
+
+	/*
+	 * Apply the highest boosts first. As every signaler of a boosted
+	 * request is then at least as high, a lower boost stops as soon as
+	 * it reaches a request already updated in this batch, and so we
+	 * walk each request at most once.
+	 */
+	list_sort(NULL, &batch, boost_cmp);
+	while (!list_empty(&batch)) {
+		struct i915_sched_node *node =
+			list_first_entry(&batch, typeof(*node), boost_link);
+		const struct i915_sched_attr attr = { .priority = node->boost };
+
+		list_del_init(&node->boost_link);
+		node->boost = I915_PRIORITY_INVALID;
+
+		if (attr.priority > node->attr.priority)
+			__i915_schedule(node, &attr);
+
+		/* Bound the irqs-off section to a single boost */
+		if (!list_empty(&batch)) {
+			spin_unlock_irqrestore(&schedule_lock, flags);
+			spin_lock_irqsave(&schedule_lock, flags);
+		}
+	}
+	spin_unlock_irqrestore(&schedule_lock, flags);
+}
+
 void i915_sched_node_init(struct i915_sched_node *node)
 {
 	INIT_LIST_HEAD(&node->signalers_list);
 	INIT_LIST_HEAD(&node->waiters_list);
 	INIT_LIST_HEAD(&node->link);
+	INIT_LIST_HEAD(&node->boost_link);
 
 	i915_sched_node_reinit(node);
 }
@@ -305,12 +398,14 @@ void i915_sched_node_init(struct i915_sched_node *node)
 void i915_sched_node_reinit(struct i915_sched_node *node)
 {
 	node->attr.priority = I915_PRIORITY_INVALID;
+	node->boost = I915_PRIORITY_INVALID;
 	node->semaphores = 0;
 	node->flags = 0;
 
 	GEM_BUG_ON(!list_empty(&node->signalers_list));
 	GEM_BUG_ON(!list_empty(&node->waiters_list));
 	GEM_BUG_ON(!list_empty(&node->link));
+	GEM_BUG_ON(!list_empty(&node->boost_link));
 }
 
 static struct i915_dependency *
@@ -377,6 +472,9 @@ void i915_sched_node_fini(struct i915_sched_node *node)
 
 	spin_lock_irq(&schedule_lock);
 
+	/* Drop any boost still pending, we are no longer in need */
+	list_del_init(&node->boost_link);
+
 	/*
 	 * Everyone we depended upon (the fences we wait to be signaled)
 	 * should retire before us and remove themselves from our list.
@@ -466,6 +564,7 @@ i915_sched_engine_create(unsigned int subclass)
 
 	INIT_LIST_HEAD(&sched_engine->requests);
 	INIT_LIST_HEAD(&sched_engine->hold);
+	INIT_LIST_HEAD(&sched_engine->boosts);
 
 	spin_lock_init(&sched_engine->lock);
 	lockdep_set_subclass(&sched_engine->lock, subclass);
@@ -509,3 +608,7 @@ int __init i915_scheduler_module_init(void)
 	kmem_cache_destroy(slab_priorities);
 	return -ENOMEM;
 }
+
+#if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
+#include "selftests/i915_scheduler.c"
+#endif
@@ -38,6 +38,7 @@ void i915_sched_node_fini(struct i915_sched_node *node);
 
 void i915_schedule(struct i915_request *request,
 		   const struct i915_sched_attr *attr);
+void i915_sched_engine_flush_boosts(struct i915_sched_engine *sched_engine);
 
 struct list_head *
 i915_sched_lookup_priolist(struct i915_sched_engine *sched_engine, int prio);
@@ -63,7 +63,9 @@ struct i915_sched_node {
 	struct list_head signalers_list; /* those before us, we depend upon */
 	struct list_head waiters_list; /* those after us, they depend upon us */
 	struct list_head link;
+	struct list_head boost_link; /* pending deferred boost, see boosts */
 	struct i915_sched_attr attr;
+	int boost; /* highest pending deferred priority */
 	unsigned int flags;
 #define I915_SCHED_HAS_EXTERNAL_CHAIN	BIT(0)
 	intel_engine_mask_t semaphores;
@@ -129,6 +131,13 @@ struct i915_sched_engine {
 	 */
 	struct tasklet_struct tasklet;
 
+	/**
+	 * @boosts: requests with a deferred priority boost, propagated in
+	 * a single batch on the next @tasklet run (protected by the global
+	 * schedule_lock, not @lock)
+	 */
+	struct list_head boosts;
+
 	/**
 	 * @default_priolist: priority list for I915_PRIORITY_NORMAL
 	 */
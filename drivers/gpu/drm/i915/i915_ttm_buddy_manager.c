@@ -7,6 +7,7 @@
 
 #include <drm/ttm/ttm_placement.h>
 #include <drm/ttm/ttm_bo.h>
+#include <drm/ttm/ttm_tt.h>
 
 #include <drm/drm_buddy.h>
 
@@ -23,6 +24,26 @@ struct i915_ttm_buddy_manager {
 	unsigned long visible_avail;
 	unsigned long visible_reserved;
 	u64 default_page_size;
+
+	/* Blocks already cleared in the background, see init_pool() */
+	struct {
+		struct list_head blocks;
+		struct delayed_work work;
+		int (*clear)(void *data, struct drm_buddy *mm,
+			     struct list_head *blocks);
+		void *data;
+		u64 block_size;
+		u64 size;
+		u64 inflight; /* being cleared by the worker */
+		u64 low;
+		u64 high;
+		bool enabled;
+
+		unsigned long hits;
+		unsigned long misses;
+		u64 cleared;
+		u64 clear_ns;
+	} pool;
 };
 
 static struct i915_ttm_buddy_manager *
@@ -31,6 +52,148 @@ to_buddy_manager(struct ttm_resource_manager *man)
 	return container_of(man, struct i915_ttm_buddy_manager, manager);
 }
 
+/*
+ * Only set memory aside for the pool while there is plenty of it free, so
+ * that we do not fight over the last blocks with real allocations, nor
+ * refill straight after draining the pool under memory pressure.
+ */
+static bool pool_has_headroom(const struct i915_ttm_buddy_manager *bman)
+{
+	return bman->mm.avail >= bman->pool.high + bman->pool.block_size;
+}
+
+static void pool_kick(struct i915_ttm_buddy_manager *bman)
+{
+	lockdep_assert_held(&bman->lock);
+
+	if (bman->pool.enabled &&
+	    bman->pool.size + bman->pool.inflight < bman->pool.low &&
+	    bman->mm.avail >= 2 * bman->pool.high)
+		queue_delayed_work(system_unbound_wq, &bman->pool.work, 0);
+}
+
+static bool pool_drain(struct i915_ttm_buddy_manager *bman)
+{
+	lockdep_assert_held(&bman->lock);
+
+	if (!bman->pool.size)
+		return false;
+
+	drm_buddy_free_list(&bman->mm, &bman->pool.blocks);
+	bman->pool.size = 0;
+
+	return true;
+}
+
+/*
+ * Return everything the pool holds to the buddy allocator, including the
+ * blocks the worker is still clearing, which we have to wait for.
+ */
+static bool pool_reclaim(struct i915_ttm_buddy_manager *bman)
+{
+	lockdep_assert_held(&bman->lock);
+
+	if (bman->pool.inflight) {
+		mutex_unlock(&bman->lock);
+		flush_delayed_work(&bman->pool.work);
+		mutex_lock(&bman->lock);
+	}
+
+	return pool_drain(bman);
+}
+
+static bool pool_wants(const struct i915_ttm_buddy_manager *bman,
+		       const struct ttm_buffer_object *bo,
+		       unsigned long flags, u64 size, u64 min_page_size)
+{
+	const struct ttm_resource *res = bo->resource;
+
+	if (!bman->pool.enabled)
+		return false;
+
+	if (flags & (DRM_BUDDY_RANGE_ALLOCATION |
+		     DRM_BUDDY_CONTIGUOUS_ALLOCATION))
+		return false;
+
+	if (min_page_size > bman->pool.block_size ||
+	    !IS_ALIGNED(size, bman->pool.block_size))
+		return false;
+
+	/* Only worth it if the move would otherwise need to clear */
+	return !res || (res->mem_type == TTM_PL_SYSTEM &&
+			(!bo->ttm || !ttm_tt_is_populated(bo->ttm)));
+}
+
+static bool pool_get(struct i915_ttm_buddy_manager *bman,
+		     struct list_head *blocks, u64 size)
+{
+	struct drm_buddy_block *block, *bn;
+
+	lockdep_assert_held(&bman->lock);
+
+	if (size > bman->pool.size)
+		return false;
+
+	bman->pool.size -= size;
+	list_for_each_entry_safe(block, bn, &bman->pool.blocks, link) {
+		list_move_tail(&block->link, blocks);
+		size -= bman->pool.block_size;
+		if (!size)
+			break;
+	}
+
+	return true;
+}
+
+static void pool_refill(struct work_struct *wrk)
+{
+	struct i915_ttm_buddy_manager *bman =
+		container_of(wrk, typeof(*bman), pool.work.work);
+	struct drm_buddy *mm = &bman->mm;
+	LIST_HEAD(blocks);
+	u64 size = 0;
+	ktime_t dt;
+	int err;
+
+	mutex_lock(&bman->lock);
+	while (bman->pool.enabled &&
+	       bman->pool.size + size < bman->pool.high &&
+	       pool_has_headroom(bman)) {
+		if (drm_buddy_alloc_blocks(mm, 0, mm->size,
+					   bman->pool.block_size,
+					   bman->pool.block_size,
+					   &blocks, 0))
+			break;
+
+		size += bman->pool.block_size;
+	}
+	bman->pool.inflight = size;
+	mutex_unlock(&bman->lock);
+	if (!size)
+		return;
+
+	dt = ktime_get();
+	err = bman->pool.clear(bman->pool.data, mm, &blocks);
+	dt = ktime_sub(ktime_get(), dt);
+
+	mutex_lock(&bman->lock);
+	bman->pool.inflight = 0;
+	if (!err && bman->pool.enabled) {
+		list_splice_tail(&blocks, &bman->pool.blocks);
+		bman->pool.size += size;
+		bman->pool.cleared += size;
+		bman->pool.clear_ns += ktime_to_ns(dt);
+	} else {
+		drm_buddy_free_list(mm, &blocks);
+
+		/* The copy engine is in use, try again later */
+		if (err == -EBUSY && bman->pool.enabled)
+			queue_delayed_work(system_unbound_wq,
+					   &bman->pool.work, HZ / 10);
+	}
+	mutex_unlock(&bman->lock);
+}
+
 static int i915_ttm_buddy_man_alloc(struct ttm_resource_manager *man,
 				    struct ttm_buffer_object *bo,
 				    const struct ttm_place *place,
@@ -83,6 +246,25 @@ static int i915_ttm_buddy_man_alloc(struct ttm_resource_manager *man,
 	n_pages = size >> ilog2(mm->chunk_size);
 
 	mutex_lock(&bman->lock);
+	if (pool_wants(bman, bo, bman_res->flags, size, min_page_size)) {
+		if (pool_get(bman, &bman_res->blocks, size)) {
+			/* The pool is all visible, and counted as available */
+			bman_res->cleared = true;
+			bman_res->used_visible_size = PFN_UP(size);
+			bman->visible_avail -= bman_res->used_visible_size;
+			bman->pool.hits++;
+			pool_kick(bman);
+			mutex_unlock(&bman->lock);
+
+			*res = &bman_res->base;
+			return 0;
+		}
+
+		bman->pool.misses++;
+		pool_kick(bman);
+	}
+
+	/* The pool is counted as available, it is drained below if needed */
 	if (lpfn <= bman->visible_size && n_pages > bman->visible_avail) {
 		mutex_unlock(&bman->lock);
 		err = -ENOSPC;
@@ -95,6 +277,14 @@ static int i915_ttm_buddy_man_alloc(struct ttm_resource_manager *man,
 				     min_page_size,
 				     &bman_res->blocks,
 				     bman_res->flags);
+	if (unlikely(err == -ENOSPC) && pool_reclaim(bman))
+		err = drm_buddy_alloc_blocks(mm,
+					     (u64)place->fpfn << PAGE_SHIFT,
+					     (u64)lpfn << PAGE_SHIFT,
+					     (u64)n_pages << PAGE_SHIFT,
+					     min_page_size,
+					     &bman_res->blocks,
+					     bman_res->flags);
 	if (unlikely(err))
 		goto err_free_blocks;
 
@@ -143,6 +333,7 @@ static void i915_ttm_buddy_man_free(struct ttm_resource_manager *man,
 	mutex_lock(&bman->lock);
 	drm_buddy_free_list(&bman->mm, &bman_res->blocks);
 	bman->visible_avail += bman_res->used_visible_size;
+	pool_kick(bman);
 	mutex_unlock(&bman->lock);
 
 	ttm_resource_fini(man, res);
@@ -235,6 +426,19 @@ static void i915_ttm_buddy_man_debug(struct ttm_resource_manager *man,
 		   (u64)bman->visible_size << PAGE_SHIFT >> 20);
 	drm_printf(printer, "visible_reserved: %lluMiB\n",
 		   (u64)bman->visible_reserved << PAGE_SHIFT >> 20);
+	if (bman->pool.clear) {
+		drm_printf(printer, "cleared pool: %lluMiB [%lluMiB, %lluMiB]%s\n",
+			   bman->pool.size >> 20,
+			   bman->pool.low >> 20, bman->pool.high >> 20,
+			   bman->pool.enabled ? "" : ", disabled");
+		drm_printf(printer, "cleared pool hits: %lu, misses: %lu\n",
+			   bman->pool.hits, bman->pool.misses);
+		drm_printf(printer, "cleared pool bandwidth: %lluMiB in %llums, %lluMiB/s\n",
+			   bman->pool.cleared >> 20,
+			   div_u64(bman->pool.clear_ns, NSEC_PER_MSEC),
+			   div64_u64(bman->pool.cleared * NSEC_PER_SEC >> 20,
+				     bman->pool.clear_ns + 1));
+	}
 
 	drm_buddy_print(&bman->mm, printer);
 
@@ -299,6 +503,8 @@ int i915_ttm_buddy_man_init(struct ttm_device *bdev,
 
 	mutex_init(&bman->lock);
 	INIT_LIST_HEAD(&bman->reserved);
+	INIT_LIST_HEAD(&bman->pool.blocks);
+	INIT_DELAYED_WORK(&bman->pool.work, pool_refill);
 	GEM_BUG_ON(default_page_size < chunk_size);
 	bman->default_page_size = default_page_size;
 	bman->visible_size = visible_size >> PAGE_SHIFT;
@@ -344,6 +550,8 @@ int i915_ttm_buddy_man_fini(struct ttm_device *bdev, unsigned int type)
 
 	ttm_set_driver_manager(bdev, type, NULL);
 
+	i915_ttm_buddy_man_enable_pool(man, false);
+
 	mutex_lock(&bman->lock);
 	drm_buddy_free_list(mm, &bman->reserved);
 	drm_buddy_fini(mm);
@@ -423,12 +631,108 @@ void i915_ttm_buddy_man_avail(struct ttm_resource_manager *man,
 {
 	struct i915_ttm_buddy_manager *bman = to_buddy_manager(man);
 
+	/* The cleared pool is still free for anyone to use */
 	mutex_lock(&bman->lock);
-	*avail = bman->mm.avail >> PAGE_SHIFT;
+	*avail = (bman->mm.avail + bman->pool.size + bman->pool.inflight) >>
+		 PAGE_SHIFT;
 	*visible_avail = bman->visible_avail;
 	mutex_unlock(&bman->lock);
 }
 
+/**
+ * i915_ttm_buddy_man_init_pool - Keep a pool of cleared blocks
+ * @man: The buddy allocator ttm manager
+ * @block_size: The size in bytes of each pooled block
+ * @low: Refill the pool once it drops below this many bytes
+ * @high: The number of bytes to refill the pool up to
+ * @clear: Callback to clear a list of blocks, returning -EBUSY if it should
+ * be retried later
+ * @data: Passed to @clear
+ *
+ * A background worker keeps between @low and @high bytes of cleared blocks
+ * available. Allocations that would otherwise need clearing, whose size is
+ * a multiple of @block_size and which have no placement restrictions, are
+ * then satisfied from the pool, and their resource marked as cleared, see
+ * i915_ttm_buddy_man_cleared(). The pool is drained whenever we would
+ * otherwise run out of space, and is only refilled while the allocator has
+ * plenty of free space. The pool still counts as available memory.
+ *
+ * The pool is only used when all of the memory is CPU visible, which keeps
+ * the visible accounting simple.
+ */
+void i915_ttm_buddy_man_init_pool(struct ttm_resource_manager *man,
+				  u64 block_size, u64 low, u64 high,
+				  int (*clear)(void *data, struct drm_buddy *mm,
+					       struct list_head *blocks),
+				  void *data)
+{
+	struct i915_ttm_buddy_manager *bman = to_buddy_manager(man);
+
+	GEM_BUG_ON(block_size < bman->default_page_size);
+	GEM_BUG_ON(!is_power_of_2(block_size));
+	GEM_BUG_ON(low > high);
+
+	if ((u64)bman->visible_size << PAGE_SHIFT < bman->mm.size)
+		return;
+
+	mutex_lock(&bman->lock);
+	bman->pool.block_size = block_size;
+	bman->pool.low = round_up(low, block_size);
+	bman->pool.high = round_up(high, block_size);
+	bman->pool.clear = clear;
+	bman->pool.data = data;
+	mutex_unlock(&bman->lock);
+}
+
+/**
+ * i915_ttm_buddy_man_enable_pool - Start or stop using the cleared pool
+ * @man: The buddy allocator ttm manager
+ * @enable: Whether to use the pool
+ *
+ * Disabling the pool releases all of its blocks, e.g. across suspend where
+ * the contents of the memory are not preserved.
+ */
+void i915_ttm_buddy_man_enable_pool(struct ttm_resource_manager *man,
+				    bool enable)
+{
+	struct i915_ttm_buddy_manager *bman = to_buddy_manager(man);
+
+	if (!bman->pool.clear)
+		return;
+
+	mutex_lock(&bman->lock);
+	bman->pool.enabled = enable;
+	if (enable)
+		pool_kick(bman);
+	mutex_unlock(&bman->lock);
+
+	if (enable)
+		return;
+
+	cancel_delayed_work_sync(&bman->pool.work);
+
+	mutex_lock(&bman->lock);
+	pool_drain(bman);
+	mutex_unlock(&bman->lock);
+}
+
+/**
+ * i915_ttm_buddy_man_cleared - Whether a resource was allocated pre-cleared
+ * @man: The ttm manager owning the resource
+ * @res: The resource
+ *
+ * Return: true if @res came from the cleared pool of a buddy manager, and
+ * so does not need to be cleared again.
+ */
+bool i915_ttm_buddy_man_cleared(struct ttm_resource_manager *man,
+				struct ttm_resource *res)
+{
+	if (man->func != &i915_ttm_buddy_manager_func)
+		return false;
+
+	return to_ttm_buddy_resource(res)->cleared;
+}
+
 #if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
 void i915_ttm_buddy_man_force_visible_size(struct ttm_resource_manager *man,
 					   u64 size)
@@ -437,4 +741,11 @@ void i915_ttm_buddy_man_force_visible_size(struct ttm_resource_manager *man,
 
 	bman->visible_size = size;
 }
+
+void i915_ttm_buddy_man_flush_pool(struct ttm_resource_manager *man)
+{
+	struct i915_ttm_buddy_manager *bman = to_buddy_manager(man);
+
+	flush_delayed_work(&bman->pool.work);
+}
 #endif
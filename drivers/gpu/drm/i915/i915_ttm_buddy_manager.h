@@ -24,6 +24,7 @@ struct drm_buddy;
  * @used_visible_size: How much of this resource, if any, uses the CPU visible
  * portion, in pages.
  * @mm: the struct i915_buddy_mm for this resource
+ * @cleared: the blocks were taken from the pool of already cleared blocks
  *
  * Extends the struct ttm_resource to manage an address space allocation with
  * one or more struct i915_buddy_block.
@@ -34,6 +35,7 @@ struct i915_ttm_buddy_resource {
 	unsigned long flags;
 	unsigned long used_visible_size;
 	struct drm_buddy *mm;
+	bool cleared;
 };
 
 /**
@@ -64,9 +66,20 @@ u64 i915_ttm_buddy_man_visible_size(struct ttm_resource_manager *man);
 void i915_ttm_buddy_man_avail(struct ttm_resource_manager *man,
 			      u64 *avail, u64 *avail_visible);
 
+void i915_ttm_buddy_man_init_pool(struct ttm_resource_manager *man,
+				  u64 block_size, u64 low, u64 high,
+				  int (*clear)(void *data, struct drm_buddy *mm,
+					       struct list_head *blocks),
+				  void *data);
+void i915_ttm_buddy_man_enable_pool(struct ttm_resource_manager *man,
+				    bool enable);
+bool i915_ttm_buddy_man_cleared(struct ttm_resource_manager *man,
+				struct ttm_resource *res);
+
 #if IS_ENABLED(CONFIG_DRM_I915_SELFTEST)
 void i915_ttm_buddy_man_force_visible_size(struct ttm_resource_manager *man,
 					   u64 size);
+void i915_ttm_buddy_man_flush_pool(struct ttm_resource_manager *man);
 #endif
 
 #endif
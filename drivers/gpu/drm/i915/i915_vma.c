@@ -1287,13 +1287,17 @@ __i915_vma_get_pages(struct i915_vma *vma)
 		break;
 
 	case I915_GTT_VIEW_ROTATED:
-		pages =
-			intel_rotate_pages(&vma->gtt_view.rotated, vma->obj);
+		pages = xchg(&vma->cached_pages, NULL);
+		if (!pages)
+			pages = intel_rotate_pages(&vma->gtt_view.rotated,
+						   vma->obj);
 		break;
 
 	case I915_GTT_VIEW_REMAPPED:
-		pages =
-			intel_remap_pages(&vma->gtt_view.remapped, vma->obj);
+		pages = xchg(&vma->cached_pages, NULL);
+		if (!pages)
+			pages = intel_remap_pages(&vma->gtt_view.remapped,
+						  vma->obj);
 		break;
 
 	case I915_GTT_VIEW_PARTIAL:
@@ -1360,15 +1364,48 @@ void vma_invalidate_tlb(struct i915_address_space *vm, u32 *tlb)
 			   intel_gt_next_invalidate_tlb_full(gt));
 }
 
+static void free_view_pages(struct sg_table *pages)
+{
+	if (!pages)
+		return;
+
+	sg_free_table(pages);
+	kfree(pages);
+}
+
+/**
+ * i915_vma_release_cached_pages - free the pages kept from the last binding
+ * @vma: the vma
+ *
+ * Must be called before the obj->mm.pages the cached pages were built from
+ * are released, and may be called at any other time to reclaim the memory.
+ */
+void i915_vma_release_cached_pages(struct i915_vma *vma)
+{
+	free_view_pages(xchg(&vma->cached_pages, NULL));
+}
+
 static void __vma_put_pages(struct i915_vma *vma, unsigned int count)
 {
 	/* We allocate under vma_get_pages, so beware the shrinker */
 	GEM_BUG_ON(atomic_read(&vma->pages_count) < count);
 
 	if (atomic_sub_return(count, &vma->pages_count) == 0) {
-		if (vma->pages != vma->obj->mm.pages) {
-			sg_free_table(vma->pages);
-			kfree(vma->pages);
+		/*
+		 * Rebuilding a rotated or remapped view walks the whole
+		 * object, so hang on to it until the object pages go away
+		 * in case the same view is bound again, as is the common
+		 * case for framebuffers.
+		 */
+		switch (vma->gtt_view.type) {
+		case I915_GTT_VIEW_ROTATED:
+		case I915_GTT_VIEW_REMAPPED:
+			free_view_pages(xchg(&vma->cached_pages, vma->pages));
+			break;
+		default:
+			if (vma->pages != vma->obj->mm.pages)
+				free_view_pages(vma->pages);
+			break;
 		}
 		vma->pages = NULL;
 
@@ -1733,6 +1770,8 @@ static void release_references(struct i915_vma *vma, struct intel_gt *gt,
 
 	spin_unlock(&obj->vma.lock);
 
+	i915_vma_release_cached_pages(vma);
+
 	spin_lock_irq(&gt->closed_lock);
 	__i915_vma_remove_closed(vma);
 	spin_unlock_irq(&gt->closed_lock);
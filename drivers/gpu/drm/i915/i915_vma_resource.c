@@ -11,7 +11,9 @@
 #include "i915_drv.h"
 #include "intel_memory_region.h"
 
+#include "gt/intel_gt.h"
 #include "gt/intel_gtt.h"
+#include "gt/intel_tlb.h"
 
 static struct kmem_cache *slab_vma_resources;
 
@@ -170,18 +172,47 @@ bool i915_vma_resource_hold(struct i915_vma_resource *vma_res,
 	return held;
 }
 
+static void i915_vma_resource_tlb_done(struct intel_tlb_inval *inval)
+{
+	struct i915_vma_resource *vma_res =
+		container_of(inval - inval->gt->info.id,
+			     typeof(*vma_res), tlb_inval[0]);
+
+	__i915_vma_resource_unhold(vma_res);
+	i915_vma_resource_put(vma_res);
+}
+
 static void i915_vma_resource_unbind_work(struct work_struct *work)
 {
 	struct i915_vma_resource *vma_res =
 		container_of(work, typeof(*vma_res), work);
 	struct i915_address_space *vm = vma_res->vm;
 	bool lockdep_cookie;
+	struct intel_gt *gt;
+	int id;
 
 	lockdep_cookie = dma_fence_begin_signalling();
 	if (likely(!vma_res->skip_pte_rewrite))
 		vma_res->ops->unbind_vma(vm, vma_res);
 
 	dma_fence_end_signalling(lockdep_cookie);
+
+	/*
+	 * Only signal the unbind once no TLB refers to the old PTE anymore,
+	 * sharing the invalidation with every other unbind queued at the
+	 * same time. Then, by the time the pages are released, the TLB
+	 * seqno recorded by unbind_vma for each GT has already been passed.
+	 * Every request holds the fence and a reference of its own.
+	 */
+	if (vma_res->tlb && !vma_res->skip_pte_rewrite && !i915_is_ggtt(vm)) {
+		for_each_gt(gt, vm->i915, id) {
+			refcount_inc(&vma_res->hold_count);
+			i915_vma_resource_get(vma_res);
+			intel_gt_invalidate_tlb_async(gt, &vma_res->tlb_inval[id],
+						      i915_vma_resource_tlb_done);
+		}
+	}
+
 	__i915_vma_resource_unhold(vma_res);
 	i915_vma_resource_put(vma_res);
 }
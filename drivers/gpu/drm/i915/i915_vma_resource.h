@@ -9,6 +9,9 @@
 #include <linux/dma-fence.h>
 #include <linux/refcount.h>
 
+#include "gt/intel_gt_defines.h"
+#include "gt/intel_tlb_types.h"
+
 #include "i915_gem.h"
 #include "i915_scatterlist.h"
 #include "i915_sw_fence.h"
@@ -93,6 +96,8 @@ struct i915_vma_bindinfo {
  * @skip_pte_rewrite: During ggtt suspend and vm takedown pte rewriting
  * needs to be skipped for unbind.
  * @tlb: pointer for obj->mm.tlb, if async unbind. Otherwise, NULL
+ * @tlb_inval: Requests for the TLB invalidation on each GT after an async
+ * unbind, each holding back the unbind fence until it completes.
  *
  * The lifetime of a struct i915_vma_resource is from a binding request to
  * the actual possible asynchronous unbind has completed.
@@ -136,6 +141,7 @@ struct i915_vma_resource {
 	bool skip_pte_rewrite:1;
 
 	u32 *tlb;
+	struct intel_tlb_inval tlb_inval[I915_MAX_GT];
 };
 
 bool i915_vma_resource_hold(struct i915_vma_resource *vma_res,
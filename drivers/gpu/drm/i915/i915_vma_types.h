@@ -189,6 +189,13 @@ struct i915_vma {
 	struct drm_i915_gem_object *obj;
 
 	struct sg_table *pages;
+	/*
+	 * Rotated and remapped pages are kept here after the last unbind, so
+	 * that binding the same view again skips rebuilding them. They are
+	 * only valid for as long as the obj->mm.pages they were built from,
+	 * see i915_gem_object_release_cached_views().
+	 */
+	struct sg_table *cached_pages;
 	void __iomem *iomap;
 	void *private; /* owned by creator */
 
@@ -13,6 +13,7 @@
 
 #include "gem/i915_gem_region.h"
 #include "gem/i915_gem_ttm.h" /* For the funcs/ops export only */
+#include "gem/i915_gem_ttm_move.h"
 /**
  * DOC: TTM support structure
  *
@@ -94,6 +95,21 @@ int intel_region_ttm_init(struct intel_memory_region *mem)
 
 	mem->region_private = ttm_manager_type(bdev, mem_type);
 
+	/*
+	 * Keep some lmem cleared ahead of time, so that new objects do not
+	 * have to wait for the blitter to clear them.
+	 */
+	if (mem->type == INTEL_MEMORY_LOCAL) {
+		u64 low = min_t(u64, resource_size(&mem->region) / 64, SZ_256M);
+
+		i915_ttm_buddy_man_init_pool(mem->region_private,
+					     max_t(u64, mem->min_page_size,
+						   SZ_2M),
+					     low, 2 * low,
+					     i915_ttm_clear_blocks, mem);
+		i915_ttm_buddy_man_enable_pool(mem->region_private, true);
+	}
+
 	return 0;
 }
 
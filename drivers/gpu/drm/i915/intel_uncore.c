@@ -937,20 +937,222 @@ static int fw_range_cmp(u32 offset, const struct intel_forcewake_range *entry)
 	result__;                                                       \
 })
 
+/*
+ * The forcewake and shadow tables are flattened at probe into a per-page
+ * lookup. Pages covered by a single range store their domains directly;
+ * pages shared between several ranges point to a block of split entries
+ * at FW_LOOKUP_SPLIT_SIZE granularity, the alignment every range in the
+ * tables respects. Pages containing shadowed registers additionally point
+ * to a bitmap of the shadowed bytes within that page.
+ */
+#define FW_LOOKUP_PAGE_SHIFT	12
+#define FW_LOOKUP_PAGE_SIZE	BIT(FW_LOOKUP_PAGE_SHIFT)
+#define FW_LOOKUP_SPLIT_SHIFT	4
+#define FW_LOOKUP_SPLIT_SIZE	BIT(FW_LOOKUP_SPLIT_SHIFT)
+#define FW_LOOKUP_SPLIT_COUNT	(FW_LOOKUP_PAGE_SIZE / FW_LOOKUP_SPLIT_SIZE)
+
+#define FW_LOOKUP_DOMAINS	GENMASK(15, 0) /* or index into split[] */
+#define FW_LOOKUP_SHADOW	GENMASK(29, 16) /* index + 1 into shadow[] */
+#define FW_LOOKUP_SPLIT		BIT(31)
+
+static void fw_lookup_fini(struct intel_uncore_fw_lookup *lookup)
+{
+	kfree(lookup->page);
+	kfree(lookup->split);
+	bitmap_free(lookup->shadow);
+	memset(lookup, 0, sizeof(*lookup));
+}
+
+static int fw_lookup_init(struct intel_uncore_fw_lookup *lookup,
+			  const struct intel_forcewake_range *ranges,
+			  unsigned int num_ranges,
+			  const struct i915_range *shadow,
+			  unsigned int num_shadow)
+{
+	unsigned long *split_pages, *shadow_pages;
+	unsigned int num_split, num_shadowed;
+	unsigned int i, p, idx;
+	u32 end = 0;
+	int err;
+
+	BUILD_BUG_ON(FORCEWAKE_ALL > FIELD_MAX(FW_LOOKUP_DOMAINS));
+
+	memset(lookup, 0, sizeof(*lookup));
+
+	for (i = 0; i < num_ranges; i++) {
+		/* Boundaries must fall on a split entry */
+		if (!IS_ALIGNED(ranges[i].start, FW_LOOKUP_SPLIT_SIZE) ||
+		    !IS_ALIGNED(ranges[i].end + 1, FW_LOOKUP_SPLIT_SIZE))
+			return -EINVAL;
+
+		end = max(end, ranges[i].end);
+	}
+	for (i = 0; i < num_shadow; i++)
+		end = max(end, shadow[i].end);
+	if (!num_ranges)
+		return 0;
+
+	lookup->num_pages = (end >> FW_LOOKUP_PAGE_SHIFT) + 1;
+
+	split_pages = bitmap_zalloc(lookup->num_pages, GFP_KERNEL);
+	shadow_pages = bitmap_zalloc(lookup->num_pages, GFP_KERNEL);
+	if (!split_pages || !shadow_pages) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < num_ranges; i++) {
+		if (!IS_ALIGNED(ranges[i].start, FW_LOOKUP_PAGE_SIZE))
+			__set_bit(ranges[i].start >> FW_LOOKUP_PAGE_SHIFT,
+				  split_pages);
+		if (!IS_ALIGNED(ranges[i].end + 1, FW_LOOKUP_PAGE_SIZE))
+			__set_bit(ranges[i].end >> FW_LOOKUP_PAGE_SHIFT,
+				  split_pages);
+	}
+
+	for (i = 0; i < num_shadow; i++)
+		bitmap_set(shadow_pages,
+			   shadow[i].start >> FW_LOOKUP_PAGE_SHIFT,
+			   (shadow[i].end >> FW_LOOKUP_PAGE_SHIFT) -
+			   (shadow[i].start >> FW_LOOKUP_PAGE_SHIFT) + 1);
+
+	num_split = bitmap_weight(split_pages, lookup->num_pages);
+	num_shadowed = bitmap_weight(shadow_pages, lookup->num_pages);
+	if (num_split > FIELD_MAX(FW_LOOKUP_DOMAINS) + 1 ||
+	    num_shadowed > FIELD_MAX(FW_LOOKUP_SHADOW)) {
+		err = -E2BIG;
+		goto out;
+	}
+
+	lookup->page = kcalloc(lookup->num_pages, sizeof(*lookup->page),
+			       GFP_KERNEL);
+	lookup->split = kcalloc(num_split * FW_LOOKUP_SPLIT_COUNT,
+				sizeof(*lookup->split), GFP_KERNEL);
+	lookup->shadow = bitmap_zalloc(num_shadowed * FW_LOOKUP_PAGE_SIZE,
+				       GFP_KERNEL);
+	if (!lookup->page ||
+	    (num_split && !lookup->split) ||
+	    (num_shadowed && !lookup->shadow)) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	idx = 0;
+	for_each_set_bit(p, split_pages, lookup->num_pages)
+		lookup->page[p] = FW_LOOKUP_SPLIT | idx++;
+
+	idx = 0;
+	for_each_set_bit(p, shadow_pages, lookup->num_pages)
+		lookup->page[p] |= FIELD_PREP(FW_LOOKUP_SHADOW, ++idx);
+
+	for (i = 0; i < num_ranges; i++) {
+		u32 offset = ranges[i].start;
+
+		while (offset <= ranges[i].end) {
+			u32 next = min(round_up(offset + 1, FW_LOOKUP_PAGE_SIZE),
+				       ranges[i].end + 1);
+			u32 *page = &lookup->page[offset >> FW_LOOKUP_PAGE_SHIFT];
+
+			if (*page & FW_LOOKUP_SPLIT) {
+				u16 *split = lookup->split +
+					FIELD_GET(FW_LOOKUP_DOMAINS, *page) *
+					FW_LOOKUP_SPLIT_COUNT;
+
+				for (; offset < next; offset += FW_LOOKUP_SPLIT_SIZE)
+					split[(offset & (FW_LOOKUP_PAGE_SIZE - 1)) >>
+					      FW_LOOKUP_SPLIT_SHIFT] = ranges[i].domains;
+			} else {
+				*page |= ranges[i].domains;
+			}
+
+			offset = next;
+		}
+	}
+
+	for (i = 0; i < num_shadow; i++) {
+		u32 offset = shadow[i].start;
+
+		while (offset <= shadow[i].end) {
+			u32 next = min(round_up(offset + 1, FW_LOOKUP_PAGE_SIZE),
+				       shadow[i].end + 1);
+			u32 page = lookup->page[offset >> FW_LOOKUP_PAGE_SHIFT];
+
+			bitmap_set(lookup->shadow,
+				   (FIELD_GET(FW_LOOKUP_SHADOW, page) - 1) *
+				   FW_LOOKUP_PAGE_SIZE +
+				   (offset & (FW_LOOKUP_PAGE_SIZE - 1)),
+				   next - offset);
+
+			offset = next;
+		}
+	}
+
+	err = 0;
+out:
+	bitmap_free(shadow_pages);
+	bitmap_free(split_pages);
+	if (err)
+		fw_lookup_fini(lookup);
+	return err;
+}
+
+static inline enum forcewake_domains
+fw_lookup_domains(const struct intel_uncore_fw_lookup *lookup, u32 offset)
+{
+	u32 page;
+
+	if (offset >= lookup->num_pages << FW_LOOKUP_PAGE_SHIFT)
+		return 0;
+
+	page = lookup->page[offset >> FW_LOOKUP_PAGE_SHIFT];
+	if (page & FW_LOOKUP_SPLIT)
+		return lookup->split[FIELD_GET(FW_LOOKUP_DOMAINS, page) *
+				     FW_LOOKUP_SPLIT_COUNT +
+				     ((offset & (FW_LOOKUP_PAGE_SIZE - 1)) >>
+				      FW_LOOKUP_SPLIT_SHIFT)];
+
+	return FIELD_GET(FW_LOOKUP_DOMAINS, page);
+}
+
+static inline bool
+fw_lookup_shadowed(const struct intel_uncore_fw_lookup *lookup, u32 offset)
+{
+	unsigned int idx;
+
+	if (offset >= lookup->num_pages << FW_LOOKUP_PAGE_SHIFT)
+		return false;
+
+	idx = FIELD_GET(FW_LOOKUP_SHADOW,
+			lookup->page[offset >> FW_LOOKUP_PAGE_SHIFT]);
+	if (!idx)
+		return false;
+
+	return test_bit((idx - 1) * FW_LOOKUP_PAGE_SIZE +
+			(offset & (FW_LOOKUP_PAGE_SIZE - 1)),
+			lookup->shadow);
+}
+
 static enum forcewake_domains
 find_fw_domain(struct intel_uncore *uncore, u32 offset)
 {
-	const struct intel_forcewake_range *entry;
+	enum forcewake_domains domains;
 
 	if (IS_GSI_REG(offset))
 		offset += uncore->gsi_offset;
 
-	entry = BSEARCH(offset,
-			uncore->fw_domains_table,
-			uncore->fw_domains_table_entries,
-			fw_range_cmp);
+	if (likely(uncore->fw_lookup.page)) {
+		domains = fw_lookup_domains(&uncore->fw_lookup, offset);
+	} else {
+		const struct intel_forcewake_range *entry;
+
+		entry = BSEARCH(offset,
+				uncore->fw_domains_table,
+				uncore->fw_domains_table_entries,
+				fw_range_cmp);
+		domains = entry ? entry->domains : 0;
+	}
 
-	if (!entry)
+	if (!domains)
 		return 0;
 
 	/*
@@ -958,14 +1160,14 @@ find_fw_domain(struct intel_uncore *uncore, u32 offset)
 	 * can't determine it statically. We use FORCEWAKE_ALL and
 	 * translate it here to the list of available domains.
 	 */
-	if (entry->domains == FORCEWAKE_ALL)
+	if (domains == FORCEWAKE_ALL)
 		return uncore->fw_domains;
 
-	drm_WARN(&uncore->i915->drm, entry->domains & ~uncore->fw_domains,
+	drm_WARN(&uncore->i915->drm, domains & ~uncore->fw_domains,
 		 "Uninitialized forcewake domain(s) 0x%x accessed at 0x%x\n",
-		 entry->domains & ~uncore->fw_domains, offset);
+		 domains & ~uncore->fw_domains, offset);
 
-	return entry->domains;
+	return domains;
 }
 
 /*
@@ -1202,6 +1404,9 @@ static bool is_shadowed(struct intel_uncore *uncore, u32 offset)
 	if (IS_GSI_REG(offset))
 		offset += uncore->gsi_offset;
 
+	if (likely(uncore->fw_lookup.page))
+		return fw_lookup_shadowed(&uncore->fw_lookup, offset);
+
 	return BSEARCH(offset,
 		       uncore->shadowed_reg_table,
 		       uncore->shadowed_reg_table_entries,
@@ -2682,6 +2887,17 @@ int intel_uncore_init_mmio(struct intel_uncore *uncore)
 		ret = uncore_forcewake_init(uncore);
 		if (ret)
 			return ret;
+
+		/* Without the lookup we just fall back to searching the tables */
+		ret = fw_lookup_init(&uncore->fw_lookup,
+				     uncore->fw_domains_table,
+				     uncore->fw_domains_table_entries,
+				     uncore->shadowed_reg_table,
+				     uncore->shadowed_reg_table_entries);
+		if (ret)
+			drm_dbg(&i915->drm,
+				"Failed to build forcewake lookup (%d), using tables\n",
+				ret);
 	}
 
 	/* make sure fw funcs are set if and only if we have fw*/
@@ -2836,6 +3052,7 @@ void intel_uncore_fini_mmio(struct drm_device *dev, void *data)
 		intel_uncore_forcewake_reset(uncore);
 		intel_uncore_fw_domains_fini(uncore);
 		iosf_mbi_punit_release();
+		fw_lookup_fini(&uncore->fw_lookup);
 	}
 
 	if (intel_uncore_needs_flr_on_fini(uncore))
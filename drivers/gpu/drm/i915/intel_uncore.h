@@ -165,6 +165,18 @@ struct intel_uncore {
 	const struct i915_range *shadowed_reg_table;
 	unsigned int shadowed_reg_table_entries;
 
+	/*
+	 * Direct-indexed copy of the forcewake and shadow tables above,
+	 * built once at probe so the mmio fast paths can resolve an offset
+	 * without a binary search. Falls back to the tables if not built.
+	 */
+	struct intel_uncore_fw_lookup {
+		u32 *page; /* one entry per 4KiB of mmio space */
+		u16 *split; /* per 16 bytes of the pages shared by ranges */
+		unsigned long *shadow; /* per byte of the shadowed pages */
+		unsigned int num_pages;
+	} fw_lookup;
+
 	struct notifier_block pmic_bus_access_nb;
 	const struct intel_uncore_fw_get *fw_get_funcs;
 	struct intel_uncore_funcs funcs;
@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "i915_selftest.h"
+
+#include "selftests/mock_gem_device.h"
+
+static struct intel_engine_cs *mock_parser_engine(struct drm_i915_private *i915)
+{
+	struct intel_engine_cs *engine;
+
+	engine = kzalloc(sizeof(*engine), GFP_KERNEL);
+	if (!engine)
+		return NULL;
+
+	engine->i915 = i915;
+	engine->class = COPY_ENGINE_CLASS;
+	strscpy(engine->name, "mock-bcs", sizeof(engine->name));
+
+	engine->get_cmd_length_mask = gen9_blt_get_cmd_length_mask;
+	engine->reg_tables = gen9_blt_reg_tables;
+	engine->reg_table_count = ARRAY_SIZE(gen9_blt_reg_tables);
+	if (init_hash_table(engine, gen9_blt_cmd_table,
+			    ARRAY_SIZE(gen9_blt_cmd_table))) {
+		fini_hash_table(engine);
+		kfree(engine);
+		return NULL;
+	}
+
+	return engine;
+}
+
+static void mock_parser_engine_free(struct intel_engine_cs *engine)
+{
+	cmd_cache_destroy(engine->cmd_cache);
+	fini_hash_table(engine);
+	kfree(engine);
+}
+
+static u32 *fill_batch(u32 *cs, u32 length)
+{
+	const u32 gpr = i915_mmio_reg_offset(GEN8_RING_CS_GPR(BLT_RING_BASE, 0));
+	u32 *end = cs + length / sizeof(*cs) - 1;
+	u32 *lri = NULL;
+
+	while (cs + 4 <= end) {
+		lri = cs;
+		*cs++ = MI_LOAD_REGISTER_IMM(1);
+		*cs++ = gpr;
+		*cs++ = 0xc0ffee;
+		*cs++ = MI_NOOP;
+	}
+	while (cs < end)
+		*cs++ = MI_NOOP;
+	*cs = MI_BATCH_BUFFER_END;
+
+	return lri;
+}
+
+static int igt_parser_cache(void *arg)
+{
+	struct drm_i915_private *i915 = arg;
+	struct intel_engine_cs *engine;
+	u32 *batch, *lri;
+	int err;
+
+	/*
+	 * A cached verdict must never leak onto a batch with different
+	 * contents, so check that changing a single register access to a
+	 * forbidden one is caught after the original was cached.
+	 */
+
+	engine = mock_parser_engine(i915);
+	if (!engine)
+		return -ENOMEM;
+
+	engine->cmd_cache = cmd_cache_create();
+	batch = kmalloc(SZ_4K, GFP_KERNEL);
+	if (!engine->cmd_cache || !batch) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	lri = fill_batch(batch, SZ_4K);
+	err = parse_batch(engine, batch, SZ_4K, 0, 0, false);
+	if (err) {
+		pr_err("Valid batch rejected, err=%d\n", err);
+		goto out;
+	}
+
+	err = parse_batch(engine, batch, SZ_4K, 0, 0, false);
+	if (err) {
+		pr_err("Cached batch rejected, err=%d\n", err);
+		goto out;
+	}
+
+	if (engine->cmd_cache->hits != 1 || engine->cmd_cache->misses != 1) {
+		pr_err("Unexpected cache hits:%lu, misses:%lu\n",
+		       engine->cmd_cache->hits, engine->cmd_cache->misses);
+		err = -EINVAL;
+		goto out;
+	}
+
+	lri[1] = i915_mmio_reg_offset(RING_START(BLT_RING_BASE));
+	err = parse_batch(engine, batch, SZ_4K, 0, 0, false);
+	if (err != -EACCES) {
+		pr_err("Modified batch not rejected, err=%d\n", err);
+		err = -EINVAL;
+		goto out;
+	}
+
+	err = 0;
+out:
+	kfree(batch);
+	mock_parser_engine_free(engine);
+	return err;
+}
+
+static int igt_parser_throughput(void *arg)
+{
+	static const u32 sizes[] = { SZ_4K, SZ_64K, SZ_256K };
+	struct drm_i915_private *i915 = arg;
+	struct intel_engine_cs *engine;
+	unsigned int n;
+	u32 *batch;
+	int err = 0;
+
+	engine = mock_parser_engine(i915);
+	if (!engine)
+		return -ENOMEM;
+
+	batch = kvmalloc(SZ_256K, GFP_KERNEL);
+	if (!batch) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	for (n = 0; n < ARRAY_SIZE(sizes); n++) {
+		const unsigned int loops = 64;
+		ktime_t dt[2];
+		unsigned int pass;
+
+		fill_batch(batch, sizes[n]);
+		for (pass = 0; pass < ARRAY_SIZE(dt); pass++) {
+			unsigned int i;
+
+			if (pass)
+				engine->cmd_cache = cmd_cache_create();
+
+			dt[pass] = ktime_get_raw();
+			for (i = 0; i < loops; i++) {
+				err = parse_batch(engine, batch, sizes[n],
+						  0, 0, false);
+				if (err)
+					break;
+			}
+			dt[pass] = ktime_sub(ktime_get_raw(), dt[pass]);
+
+			cmd_cache_destroy(fetch_and_zero(&engine->cmd_cache));
+			if (err) {
+				pr_err("Failed to parse batch of %u bytes, err=%d\n",
+				       sizes[n], err);
+				goto out;
+			}
+		}
+
+		pr_info("%s: %uKiB batch, %lluMiB/s uncached, %lluMiB/s cached\n",
+			__func__, sizes[n] >> 10,
+			div64_u64(mul_u32_u32(sizes[n], loops) * NSEC_PER_SEC,
+				  ktime_to_ns(dt[0]) * SZ_1M + 1),
+			div64_u64(mul_u32_u32(sizes[n], loops) * NSEC_PER_SEC,
+				  ktime_to_ns(dt[1]) * SZ_1M + 1));
+	}
+
+out:
+	kvfree(batch);
+	mock_parser_engine_free(engine);
+	return err;
+}
+
+int i915_cmd_parser_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_parser_cache),
+		SUBTEST(igt_parser_throughput),
+	};
+	struct drm_i915_private *i915;
+	int err;
+
+	i915 = mock_gem_device();
+	if (!i915)
+		return -ENOMEM;
+
+	err = i915_subtests(tests, i915);
+
+	mock_destroy_device(i915);
+	return err;
+}
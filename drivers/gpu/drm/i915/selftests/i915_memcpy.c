@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include <linux/sort.h>
+#include <linux/vmalloc.h>
+
+#include "i915_selftest.h"
+
+#define MEMCPY_BUFSZ (SZ_1M + SZ_4K)
+
+struct memcpy_buf {
+	struct page **pages;
+	unsigned int count;
+	void *wc;
+	void *wb;
+};
+
+static void memcpy_buf_fini(struct memcpy_buf *buf)
+{
+	unsigned int i;
+
+	if (buf->wc)
+		vunmap(buf->wc);
+	for (i = 0; i < buf->count; i++)
+		__free_page(buf->pages[i]);
+	kvfree(buf->pages);
+	vfree(buf->wb);
+}
+
+static int memcpy_buf_init(struct memcpy_buf *buf)
+{
+	const unsigned int count = MEMCPY_BUFSZ >> PAGE_SHIFT;
+
+	memset(buf, 0, sizeof(*buf));
+
+	buf->pages = kvmalloc_array(count, sizeof(*buf->pages), GFP_KERNEL);
+	if (!buf->pages)
+		goto err;
+
+	for (buf->count = 0; buf->count < count; buf->count++) {
+		buf->pages[buf->count] = alloc_page(GFP_KERNEL);
+		if (!buf->pages[buf->count])
+			goto err;
+	}
+
+	/* Same as I915_MAP_WC for shmem objects */
+	buf->wc = vmap(buf->pages, count, VM_MAP,
+		       pgprot_writecombine(PAGE_KERNEL_IO));
+	buf->wb = vmalloc(MEMCPY_BUFSZ);
+	if (!buf->wc || !buf->wb)
+		goto err;
+
+	return 0;
+
+err:
+	memcpy_buf_fini(buf);
+	return -ENOMEM;
+}
+
+static void memcpy_kernel_memcpy(void *dst, const void *src, unsigned long len)
+{
+	memcpy(dst, src, len << 4);
+}
+
+static const struct memcpy_kernel {
+	const char *name;
+	void (*copy)(void *dst, const void *src, unsigned long len);
+	struct static_key_false *key;
+	unsigned int align;
+	bool to_wc;
+} memcpy_kernels[] = {
+	{ "memcpy", memcpy_kernel_memcpy, NULL, 1, false },
+	{ "ntdqa", __memcpy_ntdqa, &has_movntdqa, 16, false },
+	{ "ntdqa_avx2", __memcpy_ntdqa_avx2, &has_avx2, 32, false },
+	{ "ntdqa_avx512", __memcpy_ntdqa_avx512, &has_avx512, 64, false },
+	{ "memcpy", memcpy_kernel_memcpy, NULL, 1, true },
+	{ "ntdq", __memcpy_ntdq, &has_movntdq, 16, true },
+	{ "ntdq_avx2", __memcpy_ntdq_avx2, &has_avx2, 32, true },
+	{ "ntdq_avx512", __memcpy_ntdq_avx512, &has_avx512, 64, true },
+};
+
+static int wrap_ktime_compare(const void *A, const void *B)
+{
+	const ktime_t *a = A, *b = B;
+
+	return ktime_compare(*a, *b);
+}
+
+static int igt_memcpy_correctness(void *arg)
+{
+	static const unsigned int lengths[] = { 16, 48, 112, 272, 4096, 4112 };
+	struct memcpy_buf buf;
+	unsigned int k, n;
+	int err;
+
+	err = memcpy_buf_init(&buf);
+	if (err)
+		return err;
+
+	for (k = 0; k < ARRAY_SIZE(memcpy_kernels); k++) {
+		const struct memcpy_kernel *mk = &memcpy_kernels[k];
+
+		if (mk->key && !static_key_enabled(mk->key))
+			continue;
+
+		for (n = 0; n < ARRAY_SIZE(lengths); n++) {
+			const unsigned int len = lengths[n];
+			void *src, *dst;
+
+			if (mk->to_wc) {
+				src = buf.wb + 8 * (mk->align > 1);
+				dst = buf.wc + mk->align;
+			} else {
+				src = buf.wc + mk->align;
+				dst = buf.wb + mk->align;
+			}
+
+			get_random_bytes(buf.wb + SZ_512K, len);
+			memcpy(src, buf.wb + SZ_512K, len);
+			memset(dst, 0xc5, len + 16);
+
+			mk->copy(dst, src, len >> 4);
+
+			if (memcmp(dst, buf.wb + SZ_512K, len) ||
+			    memchr_inv(dst + len, 0xc5, 16)) {
+				pr_err("%s %s wc failed for length %u\n",
+				       mk->name, mk->to_wc ? "to" : "from", len);
+				err = -EINVAL;
+				goto out;
+			}
+		}
+	}
+
+out:
+	memcpy_buf_fini(&buf);
+	return err;
+}
+
+static int perf_memcpy_wc(void *arg)
+{
+	static const unsigned int sizes[] = { SZ_4K, SZ_64K, SZ_1M };
+	static const unsigned int offsets[] = { 0, 16, 32 };
+	struct memcpy_buf buf;
+	unsigned int k, n, o;
+	int err;
+
+	err = memcpy_buf_init(&buf);
+	if (err)
+		return err;
+
+	memset(buf.wb, 0x5a, MEMCPY_BUFSZ);
+	memset(buf.wc, 0xa5, MEMCPY_BUFSZ);
+
+	for (k = 0; k < ARRAY_SIZE(memcpy_kernels); k++) {
+		const struct memcpy_kernel *mk = &memcpy_kernels[k];
+
+		if (mk->key && !static_key_enabled(mk->key))
+			continue;
+
+		for (n = 0; n < ARRAY_SIZE(sizes); n++) {
+			for (o = 0; o < ARRAY_SIZE(offsets); o++) {
+				const unsigned int offset = offsets[o];
+				void *src, *dst;
+				ktime_t t[5];
+				int pass;
+
+				if (!IS_ALIGNED(offset, mk->align))
+					continue;
+
+				if (mk->to_wc) {
+					src = buf.wb + offset;
+					dst = buf.wc + offset;
+				} else {
+					src = buf.wc + offset;
+					dst = buf.wb + offset;
+				}
+
+				for (pass = 0; pass < ARRAY_SIZE(t); pass++) {
+					ktime_t t0 = ktime_get();
+
+					mk->copy(dst, src, sizes[n] >> 4);
+					t[pass] = ktime_sub(ktime_get(), t0);
+				}
+
+				sort(t, ARRAY_SIZE(t), sizeof(*t),
+				     wrap_ktime_compare, NULL);
+				if (t[0] <= 0)
+					continue;
+
+				pr_info("%s %14s %s wc, %4u KiB copy, +%2u offset: %5lld MiB/s\n",
+					__func__, mk->name,
+					mk->to_wc ? "to" : "from",
+					sizes[n] >> 10, offset,
+					div64_u64(mul_u32_u32(4 * sizes[n],
+							      1000 * 1000 * 1000),
+						  t[1] + 2 * t[2] + t[3]) >> 20);
+			}
+		}
+
+		cond_resched();
+	}
+
+	memcpy_buf_fini(&buf);
+	return 0;
+}
+
+int i915_memcpy_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_memcpy_correctness),
+		SUBTEST(perf_memcpy_wc),
+	};
+
+	return i915_subtests(tests, NULL);
+}
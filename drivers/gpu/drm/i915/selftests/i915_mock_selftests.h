@@ -20,16 +20,27 @@ selftest(shmem, shmem_utils_mock_selftests)
 selftest(fence, i915_sw_fence_mock_selftests)
 selftest(scatterlist, scatterlist_mock_selftests)
 selftest(syncmap, i915_syncmap_mock_selftests)
+selftest(memcpy, i915_memcpy_mock_selftests)
 selftest(uncore, intel_uncore_mock_selftests)
 selftest(ring, intel_ring_mock_selftests)
 selftest(engine, intel_engine_cs_mock_selftests)
 selftest(timelines, intel_timeline_mock_selftests)
+selftest(tlb, intel_tlb_mock_selftests)
+selftest(guc_ct, intel_guc_ct_mock_selftests)
 selftest(requests, i915_request_mock_selftests)
+selftest(scheduler, i915_scheduler_mock_selftests)
+selftest(cmd_parser, i915_cmd_parser_mock_selftests)
 selftest(objects, i915_gem_object_mock_selftests)
 selftest(phys, i915_gem_phys_mock_selftests)
+selftest(userptr, i915_gem_userptr_mock_selftests)
 selftest(dmabuf, i915_gem_dmabuf_mock_selftests)
+selftest(execbuf, i915_gem_execbuffer_mock_selftests)
 selftest(vma, i915_vma_mock_selftests)
 selftest(evict, i915_gem_evict_mock_selftests)
 selftest(gtt, i915_gem_gtt_mock_selftests)
 selftest(hugepages, i915_gem_huge_page_mock_selftests)
 selftest(memory_region, intel_memory_region_mock_selftests)
+selftest(atomic_plane, intel_atomic_plane_mock_selftests)
+selftest(dsb, intel_dsb_mock_selftests)
+selftest(color, intel_color_mock_selftests)
+selftest(psr, intel_psr_mock_selftests)
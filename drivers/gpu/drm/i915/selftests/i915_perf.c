@@ -5,6 +5,7 @@
  */
 
 #include <linux/kref.h>
+#include <linux/mman.h>
 
 #include "gem/i915_gem_pm.h"
 #include "gt/intel_gt.h"
@@ -89,7 +90,7 @@ get_empty_config(struct i915_perf *perf)
 }
 
 static struct i915_perf_stream *
-test_stream(struct i915_perf *perf)
+__test_stream(struct i915_perf *perf, int period_exponent, bool oa_buffer_mmap)
 {
 	struct drm_i915_perf_open_param param = {};
 	struct i915_oa_config *oa_config = get_empty_config(perf);
@@ -100,6 +101,10 @@ test_stream(struct i915_perf *perf)
 		.sample_flags = SAMPLE_OA_REPORT,
 		.oa_format = GRAPHICS_VER(perf->i915) == 12 ?
 		I915_OA_FORMAT_A32u40_A4u32_B8_C8 : I915_OA_FORMAT_C4_B8,
+		.oa_periodic = period_exponent >= 0,
+		.oa_period_exponent = period_exponent,
+		.poll_oa_period = DEFAULT_POLL_PERIOD_NS,
+		.oa_buffer_mmap = oa_buffer_mmap,
 	};
 	struct i915_perf_stream *stream;
 	struct intel_gt *gt;
@@ -121,6 +126,7 @@ test_stream(struct i915_perf *perf)
 	}
 
 	stream->perf = perf;
+	stream->poll_oa_period = props.poll_oa_period;
 
 	mutex_lock(&gt->perf.lock);
 	if (i915_oa_stream_init(stream, &param, &props)) {
@@ -134,6 +140,12 @@ test_stream(struct i915_perf *perf)
 	return stream;
 }
 
+static struct i915_perf_stream *
+test_stream(struct i915_perf *perf)
+{
+	return __test_stream(perf, -1, false);
+}
+
 static void stream_destroy(struct i915_perf_stream *stream)
 {
 	struct intel_gt *gt = stream->engine->gt;
@@ -417,12 +429,130 @@ static int live_noa_gpr(void *arg)
 	return err;
 }
 
+static unsigned long oa_consume_read(struct i915_perf_stream *stream,
+				     char __user *buf, size_t count)
+{
+	size_t offset = 0;
+
+	mutex_lock(&stream->lock);
+	stream->ops->read(stream, buf, count, &offset);
+	mutex_unlock(&stream->lock);
+
+	return offset / stream->sample_size;
+}
+
+static unsigned long oa_consume_mmap(struct i915_perf_stream *stream)
+{
+	struct drm_i915_perf_oa_buffer_mmap *ctl = stream->oa_buffer.mmap;
+	u32 tail = smp_load_acquire(&ctl->tail);
+	u32 head = READ_ONCE(ctl->head);
+	unsigned long count;
+
+	/* Parsing the reports in place costs the same as parsing a copy */
+	count = OA_TAKEN(tail, head) / ctl->report_size;
+	WRITE_ONCE(ctl->head, tail);
+
+	/* Hand the space back now, as a read() would */
+	oa_buffer_check_unlocked(stream);
+
+	return count;
+}
+
+static int __live_oa_throughput(struct i915_perf *perf, int exponent,
+				bool oa_buffer_mmap, char __user *buf,
+				size_t count)
+{
+	struct i915_perf_stream *stream;
+	unsigned long reports = 0;
+	IGT_TIMEOUT(end_time);
+	ktime_t busy = 0;
+	ktime_t dt;
+
+	stream = __test_stream(perf, exponent, oa_buffer_mmap);
+	if (!stream)
+		return -EINVAL;
+
+	mutex_lock(&stream->lock);
+	i915_perf_enable_locked(stream);
+	mutex_unlock(&stream->lock);
+
+	dt = ktime_get_raw();
+	do {
+		ktime_t t;
+
+		wait_event_timeout(stream->poll_wq, READ_ONCE(stream->pollin),
+				   HZ / 10);
+		stream->pollin = false;
+
+		t = ktime_get_raw();
+		if (oa_buffer_mmap)
+			reports += oa_consume_mmap(stream);
+		else
+			reports += oa_consume_read(stream, buf, count);
+		busy = ktime_add(busy, ktime_sub(ktime_get_raw(), t));
+	} while (!__igt_timeout(end_time, NULL));
+	dt = ktime_sub(ktime_get_raw(), dt);
+
+	stream_destroy(stream);
+
+	pr_info("%s: %s, period %lluns: %llu reports/s, %lluns of cpu per report\n",
+		__func__, oa_buffer_mmap ? "mmap" : "read",
+		oa_exponent_to_ns(perf, exponent),
+		div64_u64((u64)reports * NSEC_PER_SEC,
+			  ktime_to_ns(dt) + 1),
+		div64_u64(ktime_to_ns(busy), reports + 1));
+
+	if (!reports) {
+		pr_err("No OA reports received with periodic sampling\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int live_oa_mmap_throughput(void *arg)
+{
+	const size_t count = SZ_1M;
+	struct drm_i915_private *i915 = arg;
+	struct i915_perf *perf = &i915->perf;
+	unsigned long addr;
+	int exponent = 0;
+	int err;
+
+	/*
+	 * Sample as fast as is sensible and compare the sustained rate at
+	 * which we can consume reports, and the cpu time that takes, between
+	 * copying them out with read() and parsing them in place.
+	 */
+
+	if (GRAPHICS_VER(i915) < 8 || !current->mm)
+		return 0;
+
+	while (exponent < OA_EXPONENT_MAX &&
+	       oa_exponent_to_ns(perf, exponent) < 10 * NSEC_PER_USEC)
+		exponent++;
+
+	addr = vm_mmap(NULL, 0, count, PROT_READ | PROT_WRITE,
+		       MAP_ANONYMOUS | MAP_PRIVATE, 0);
+	if (IS_ERR_VALUE(addr))
+		return addr;
+
+	err = __live_oa_throughput(perf, exponent, false,
+				   u64_to_user_ptr(addr), count);
+	if (err == 0)
+		err = __live_oa_throughput(perf, exponent, true, NULL, 0);
+
+	vm_munmap(addr, count);
+	return err;
+}
+
 int i915_perf_live_selftests(struct drm_i915_private *i915)
 {
 	static const struct i915_subtest tests[] = {
 		SUBTEST(live_sanitycheck),
 		SUBTEST(live_noa_delay),
 		SUBTEST(live_noa_gpr),
+		SUBTEST(live_oa_mmap_throughput),
 	};
 	struct i915_perf *perf = &i915->perf;
 	int err;
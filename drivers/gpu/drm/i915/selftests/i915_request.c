@@ -539,6 +539,65 @@ static int mock_breadcrumbs_smoketest(void *arg)
 	return ret;
 }
 
+static int igt_wait_budget(void *arg)
+{
+	const unsigned long max = 8000;
+	struct intel_engine_wait_hist h = {};
+	unsigned long budget;
+	unsigned int n;
+
+	/*
+	 * The busywait budget should follow what the engine's history says
+	 * about how quickly its requests complete: spin briefly for quick
+	 * requests, the full budget when it often pays off, and not at all
+	 * when waits almost always outlast it.
+	 */
+
+	budget = wait_hist_budget(&h, max);
+	if (budget != max) {
+		pr_err("Budget %lu without any history, expected %lu\n",
+		       budget, max);
+		return -EINVAL;
+	}
+
+	for (n = 0; n < WAIT_HIST_MIN_SAMPLES; n++)
+		wait_hist_record(&h, 1500);
+	budget = wait_hist_budget(&h, max);
+	if (budget != wait_bucket_ns(wait_bucket(1500))) {
+		pr_err("Budget %lu for 1.5us waits, expected %lu\n",
+		       budget, wait_bucket_ns(wait_bucket(1500)));
+		return -EINVAL;
+	}
+
+	for (n = 0; n < WAIT_HIST_MIN_SAMPLES; n++)
+		wait_hist_record(&h, 100 * NSEC_PER_USEC);
+	budget = wait_hist_budget(&h, max);
+	if (budget != max) {
+		pr_err("Budget %lu for half quick waits, expected %lu\n",
+		       budget, max);
+		return -EINVAL;
+	}
+
+	/* Old history decays, and we stop spinning for slow requests */
+	for (n = 0; n < 4 * WAIT_HIST_MAX_SAMPLES; n++)
+		wait_hist_record(&h, 100 * NSEC_PER_USEC);
+	budget = wait_hist_budget(&h, max);
+	if (budget) {
+		pr_err("Budget %lu for 100us waits, expected 0\n", budget);
+		return -EINVAL;
+	}
+
+	for (n = 0; n < INTEL_ENGINE_WAIT_BUCKETS; n++) {
+		if (h.count[n] > WAIT_HIST_MAX_SAMPLES) {
+			pr_err("History bucket %u overflowed: %u\n",
+			       n, h.count[n]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 int i915_request_mock_selftests(void)
 {
 	static const struct i915_subtest tests[] = {
@@ -546,6 +605,7 @@ int i915_request_mock_selftests(void)
 		SUBTEST(igt_wait_request),
 		SUBTEST(igt_fence_wait),
 		SUBTEST(igt_request_rewind),
+		SUBTEST(igt_wait_budget),
 		SUBTEST(mock_breadcrumbs_smoketest),
 	};
 	struct drm_i915_private *i915;
@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: MIT
+/*
+ * Copyright © 2024 Intel Corporation
+ */
+
+#include "gt/intel_engine.h"
+
+#include "i915_random.h"
+#include "i915_selftest.h"
+
+/*
+ * A synthetic dependency graph of requests that are never submitted, so
+ * that we can exercise priority inheritance in isolation. Every request
+ * depends on its predecessor, and on up to fanin - 1 earlier requests.
+ */
+struct sched_dag {
+	struct intel_engine_cs engine;
+	struct i915_request *rq;
+	struct i915_dependency *deps;
+	unsigned int count;
+	u32 hwsp;
+};
+
+static void mock_boost_tasklet(struct tasklet_struct *t)
+{
+	struct i915_sched_engine *sched_engine =
+		from_tasklet(sched_engine, t, tasklet);
+
+	i915_sched_engine_flush_boosts(sched_engine);
+}
+
+static void dag_destroy(struct sched_dag *dag)
+{
+	unsigned int i;
+
+	for (i = 0; i < dag->count; i++)
+		i915_sched_node_fini(&dag->rq[i].sched);
+
+	if (dag->engine.sched_engine)
+		i915_sched_engine_put(dag->engine.sched_engine);
+	kvfree(dag->deps);
+	kvfree(dag->rq);
+	kfree(dag);
+}
+
+static struct sched_dag *
+dag_create(unsigned int count, unsigned int fanin, u32 seed)
+{
+	struct rnd_state prng = I915_RND_STATE_INITIALIZER(seed);
+	struct i915_dependency *dep;
+	struct sched_dag *dag;
+	unsigned int f;
+
+	dag = kzalloc(sizeof(*dag), GFP_KERNEL);
+	if (!dag)
+		return NULL;
+
+	dag->engine.sched_engine = i915_sched_engine_create(ENGINE_MOCK);
+	dag->rq = kvcalloc(count, sizeof(*dag->rq), GFP_KERNEL);
+	dag->deps = kvcalloc(count * fanin, sizeof(*dag->deps), GFP_KERNEL);
+	if (!dag->engine.sched_engine || !dag->rq || !dag->deps) {
+		dag_destroy(dag);
+		return NULL;
+	}
+
+	tasklet_setup(&dag->engine.sched_engine->tasklet, mock_boost_tasklet);
+
+	dep = dag->deps;
+	for (dag->count = 0; dag->count < count; dag->count++) {
+		struct i915_request *rq = &dag->rq[dag->count];
+
+		/* Never started, never completed */
+		rq->engine = &dag->engine;
+		rq->hwsp_seqno = &dag->hwsp;
+		rq->fence.seqno = 2;
+
+		i915_sched_node_init(&rq->sched);
+		rq->sched.attr.priority = I915_PRIORITY_NORMAL;
+
+		for (f = 0; f < fanin && dag->count; f++) {
+			unsigned int j = dag->count - 1;
+
+			if (f)
+				j = i915_prandom_u32_max_state(dag->count, &prng);
+
+			__i915_sched_node_add_dependency(&rq->sched,
+							 &dag->rq[j].sched,
+							 dep++, 0);
+		}
+	}
+
+	return dag;
+}
+
+static void dag_boost_immediate(struct sched_dag *dag,
+				const unsigned int *idx, const int *prio,
+				unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		const struct i915_sched_attr attr = { .priority = prio[i] };
+
+		spin_lock_irq(&schedule_lock);
+		__i915_schedule(&dag->rq[idx[i]].sched, &attr);
+		spin_unlock_irq(&schedule_lock);
+	}
+}
+
+static void dag_boost_deferred(struct sched_dag *dag,
+			       const unsigned int *idx, const int *prio,
+			       unsigned int count)
+{
+	struct i915_sched_engine *sched_engine = dag->engine.sched_engine;
+	unsigned int i;
+
+	/* Keep the tasklet from racing with us, we flush the batch */
+	tasklet_disable(&sched_engine->tasklet);
+	for (i = 0; i < count; i++) {
+		const struct i915_sched_attr attr = { .priority = prio[i] };
+
+		defer_schedule(&dag->rq[idx[i]], &attr);
+	}
+	i915_sched_engine_flush_boosts(sched_engine);
+	tasklet_enable(&sched_engine->tasklet);
+}
+
+static int dag_check(struct sched_dag *dag,
+		     const unsigned int *idx, const int *prio,
+		     unsigned int count, const char *mode)
+{
+	unsigned int i;
+	int *expect;
+	int err = 0;
+
+	expect = kvmalloc_array(dag->count, sizeof(*expect), GFP_KERNEL);
+	if (!expect)
+		return -ENOMEM;
+
+	for (i = 0; i < dag->count; i++)
+		expect[i] = I915_PRIORITY_NORMAL;
+	for (i = 0; i < count; i++)
+		expect[idx[i]] = max(expect[idx[i]], prio[i]);
+
+	/* Signalers always precede their waiters in the dag */
+	for (i = dag->count; i--; ) {
+		struct i915_dependency *dep;
+
+		list_for_each_entry(dep, &dag->rq[i].sched.signalers_list,
+				    signal_link) {
+			unsigned int j = node_to_request(dep->signaler) - dag->rq;
+
+			expect[j] = max(expect[j], expect[i]);
+		}
+	}
+
+	for (i = 0; i < dag->count; i++) {
+		if (dag->rq[i].sched.attr.priority != expect[i]) {
+			pr_err("%s: request %u has priority %d, expected %d\n",
+			       mode, i, dag->rq[i].sched.attr.priority,
+			       expect[i]);
+			err = -EINVAL;
+			break;
+		}
+
+		if (!list_empty(&dag->rq[i].sched.boost_link)) {
+			pr_err("%s: request %u still has a pending boost\n",
+			       mode, i);
+			err = -EINVAL;
+			break;
+		}
+	}
+
+	kvfree(expect);
+	return err;
+}
+
+static int igt_schedule_deferred(void *arg)
+{
+	const unsigned int count = 1024, boosts = 256;
+	I915_RND_STATE(prng);
+	struct sched_dag *dag;
+	unsigned int *idx, i;
+	int *prio;
+	u32 seed;
+	int err;
+
+	/*
+	 * Priority inheritance must reach every signaler of each boosted
+	 * request, whether we apply each boost immediately or coalesce
+	 * them into a single batch.
+	 */
+
+	idx = kmalloc_array(boosts, sizeof(*idx), GFP_KERNEL);
+	prio = kmalloc_array(boosts, sizeof(*prio), GFP_KERNEL);
+	if (!idx || !prio) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < boosts; i++) {
+		idx[i] = i915_prandom_u32_max_state(count, &prng);
+		prio[i] = 1 + i915_prandom_u32_max_state(I915_PRIORITY_MAX, &prng);
+	}
+	seed = prandom_u32_state(&prng);
+
+	dag = dag_create(count, 4, seed);
+	if (!dag) {
+		err = -ENOMEM;
+		goto out;
+	}
+	dag_boost_immediate(dag, idx, prio, boosts);
+	err = dag_check(dag, idx, prio, boosts, "immediate");
+	dag_destroy(dag);
+	if (err)
+		goto out;
+
+	dag = dag_create(count, 4, seed);
+	if (!dag) {
+		err = -ENOMEM;
+		goto out;
+	}
+	dag_boost_deferred(dag, idx, prio, boosts);
+	err = dag_check(dag, idx, prio, boosts, "deferred");
+	dag_destroy(dag);
+
+out:
+	kfree(prio);
+	kfree(idx);
+	return err;
+}
+
+static int perf_schedule_deferred(void *arg)
+{
+	static const struct {
+		const char *name;
+		unsigned int count;
+		unsigned int fanin;
+	} shapes[] = {
+		{ "chain", 4096, 1 },
+		{ "dag", 4096, 4 },
+		{ "wide", 1024, 16 },
+	};
+	I915_RND_STATE(prng);
+	unsigned int idx[64], n, i;
+	const unsigned int boosts = ARRAY_SIZE(idx);
+	int prio[ARRAY_SIZE(idx)];
+
+	for (n = 0; n < ARRAY_SIZE(shapes); n++) {
+		const u32 seed = prandom_u32_state(&prng);
+		struct sched_dag *dag;
+		ktime_t dt[2];
+
+		/* Repeatedly boost the tail, revisiting the same subgraph */
+		for (i = 0; i < boosts; i++) {
+			idx[i] = shapes[n].count - 1 -
+				i915_prandom_u32_max_state(16, &prng);
+			prio[i] = 1 + i;
+		}
+
+		dag = dag_create(shapes[n].count, shapes[n].fanin, seed);
+		if (!dag)
+			return -ENOMEM;
+
+		dt[0] = ktime_get_raw();
+		dag_boost_immediate(dag, idx, prio, boosts);
+		dt[0] = ktime_sub(ktime_get_raw(), dt[0]);
+		dag_destroy(dag);
+
+		dag = dag_create(shapes[n].count, shapes[n].fanin, seed);
+		if (!dag)
+			return -ENOMEM;
+
+		dt[1] = ktime_get_raw();
+		dag_boost_deferred(dag, idx, prio, boosts);
+		dt[1] = ktime_sub(ktime_get_raw(), dt[1]);
+		dag_destroy(dag);
+
+		pr_info("%s: %s of %u requests, %u boosts: %lluus immediate, %lluus deferred\n",
+			__func__, shapes[n].name, shapes[n].count, boosts,
+			div_u64(ktime_to_ns(dt[0]), NSEC_PER_USEC),
+			div_u64(ktime_to_ns(dt[1]), NSEC_PER_USEC));
+
+		cond_resched();
+	}
+
+	return 0;
+}
+
+int i915_scheduler_mock_selftests(void)
+{
+	static const struct i915_subtest tests[] = {
+		SUBTEST(igt_schedule_deferred),
+		SUBTEST(perf_schedule_deferred),
+	};
+
+	return i915_subtests(tests, NULL);
+}
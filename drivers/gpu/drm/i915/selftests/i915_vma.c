@@ -710,6 +710,99 @@ static int igt_vma_rotate_remap(void *arg)
 	return err;
 }
 
+static int igt_vma_cached_views(void *arg)
+{
+	struct i915_ggtt *ggtt = arg;
+	struct i915_address_space *vm = &ggtt->vm;
+	struct drm_i915_gem_object *obj;
+	struct i915_gtt_view view = {
+		.type = I915_GTT_VIEW_ROTATED,
+		.rotated.plane[0] = {
+			.width = 4, .height = 4,
+			.src_stride = 4, .dst_stride = 4,
+		},
+	};
+	struct sg_table *pages;
+	struct i915_vma *vma;
+	int pass, err;
+
+	/*
+	 * Rebinding a rotated view after an unbind should reuse the pages
+	 * built for the previous binding, until the object pages they were
+	 * built from are released.
+	 */
+
+	obj = i915_gem_object_create_internal(vm->i915, 16 * PAGE_SIZE);
+	if (IS_ERR(obj))
+		return PTR_ERR(obj);
+
+	vma = checked_vma_instance(obj, vm, &view);
+	if (IS_ERR(vma)) {
+		err = PTR_ERR(vma);
+		goto out_object;
+	}
+
+	pages = NULL;
+	for (pass = 0; pass < 3; pass++) {
+		err = i915_vma_pin(vma, 0, 0, PIN_GLOBAL);
+		if (err) {
+			pr_err("Failed to pin VMA, err=%d\n", err);
+			goto out_object;
+		}
+
+		if (pages && (vma->pages != pages || vma->cached_pages)) {
+			pr_err("Rebinding pass %d did not reuse the cached pages\n", pass);
+			err = -EINVAL;
+		}
+
+		if (!err && IS_ERR(assert_rotated(obj, &view.rotated, 0,
+						  vma->pages->sgl))) {
+			pr_err("Inconsistent rotated VMA pages on pass %d\n", pass);
+			err = -EINVAL;
+		}
+
+		pages = vma->pages;
+		i915_vma_unpin(vma);
+		if (err)
+			goto out_object;
+
+		err = i915_vma_unbind_unlocked(vma);
+		if (err) {
+			pr_err("Unbinding returned %i\n", err);
+			goto out_object;
+		}
+
+		if (vma->cached_pages != pages) {
+			pr_err("Unbinding pass %d did not keep the rotated pages\n", pass);
+			err = -EINVAL;
+			goto out_object;
+		}
+
+		/* Drop the object pages, so the last pass has to rebuild the view */
+		if (pass == 1) {
+			i915_gem_object_lock(obj, NULL);
+			err = __i915_gem_object_put_pages(obj);
+			i915_gem_object_unlock(obj);
+			if (err) {
+				pr_err("Failed to release object pages, err=%d\n", err);
+				goto out_object;
+			}
+
+			if (vma->cached_pages) {
+				pr_err("Cached pages outlived the object pages\n");
+				err = -EINVAL;
+				goto out_object;
+			}
+
+			pages = NULL;
+		}
+	}
+
+out_object:
+	i915_gem_object_put(obj);
+	return err;
+}
+
 static bool assert_partial(struct drm_i915_gem_object *obj,
 			   struct i915_vma *vma,
 			   unsigned long offset,
@@ -920,6 +1013,7 @@ int i915_vma_mock_selftests(void)
 		SUBTEST(igt_vma_create),
 		SUBTEST(igt_vma_pin1),
 		SUBTEST(igt_vma_rotate_remap),
+		SUBTEST(igt_vma_cached_views),
 		SUBTEST(igt_vma_partial),
 	};
 	struct drm_i915_private *i915;
@@ -671,6 +671,110 @@ static int igt_mock_io_size(void *arg)
 	return err;
 }
 
+static int mock_clear_blocks(void *data, struct drm_buddy *mm,
+			     struct list_head *blocks)
+{
+	struct drm_buddy_block *block;
+	u64 *cleared = data;
+
+	list_for_each_entry(block, blocks, link)
+		*cleared += drm_buddy_block_size(mm, block);
+
+	return 0;
+}
+
+static int igt_mock_cleared_pool(void *arg)
+{
+	struct intel_memory_region *mem = arg;
+	struct drm_i915_private *i915 = mem->i915;
+	const u64 total = SZ_256M;
+	struct i915_ttm_buddy_resource *res;
+	struct drm_i915_gem_object *obj;
+	u64 avail, visible_avail;
+	LIST_HEAD(objects);
+	u64 cleared = 0;
+	int err = 0;
+
+	/*
+	 * Objects allocated while the pool has enough cleared blocks must
+	 * come from it, and everything else must still be allocatable by
+	 * draining the pool when we run out of space. The pool must not
+	 * reduce the memory reported as available.
+	 */
+
+	mem = mock_region_create(i915, 0, total, I915_GTT_PAGE_SIZE_4K,
+				 0, total);
+	if (IS_ERR(mem)) {
+		pr_err("failed to create memory region\n");
+		return PTR_ERR(mem);
+	}
+
+	i915_ttm_buddy_man_init_pool(mem->region_private, SZ_2M,
+				     SZ_8M, SZ_16M,
+				     mock_clear_blocks, &cleared);
+	i915_ttm_buddy_man_enable_pool(mem->region_private, true);
+	i915_ttm_buddy_man_flush_pool(mem->region_private);
+	if (cleared != SZ_16M) {
+		pr_err("%s pool filled with %llu bytes, expected %u\n",
+		       __func__, cleared, SZ_16M);
+		err = -EINVAL;
+		goto out_close;
+	}
+
+	i915_ttm_buddy_man_avail(mem->region_private, &avail, &visible_avail);
+	if (avail != total >> PAGE_SHIFT ||
+	    visible_avail != total >> PAGE_SHIFT) {
+		pr_err("%s pool reduced the available pages to %llu (%llu visible), expected %llu\n",
+		       __func__, avail, visible_avail, total >> PAGE_SHIFT);
+		err = -EINVAL;
+		goto out_close;
+	}
+
+	obj = igt_object_create(mem, &objects, SZ_4M, 0);
+	if (IS_ERR(obj)) {
+		err = PTR_ERR(obj);
+		goto out_close;
+	}
+
+	res = to_ttm_buddy_resource(obj->mm.res);
+	if (!res->cleared) {
+		pr_err("%s object not allocated from the pool\n", __func__);
+		err = -EINVAL;
+		goto out_close;
+	}
+
+	obj = igt_object_create(mem, &objects, SZ_1M, 0);
+	if (IS_ERR(obj)) {
+		err = PTR_ERR(obj);
+		goto out_close;
+	}
+
+	res = to_ttm_buddy_resource(obj->mm.res);
+	if (res->cleared) {
+		pr_err("%s unaligned object allocated from the pool\n",
+		       __func__);
+		err = -EINVAL;
+		goto out_close;
+	}
+
+	close_objects(mem, &objects);
+	i915_ttm_buddy_man_flush_pool(mem->region_private);
+
+	obj = igt_object_create(mem, &objects, total, 0);
+	if (IS_ERR(obj)) {
+		pr_err("%s failed to allocate all of the region, err=%ld\n",
+		       __func__, PTR_ERR(obj));
+		err = PTR_ERR(obj);
+		goto out_close;
+	}
+
+out_close:
+	close_objects(mem, &objects);
+	i915_ttm_buddy_man_enable_pool(mem->region_private, false);
+	intel_memory_region_destroy(mem);
+	return err;
+}
+
 static int igt_gpu_write_dw(struct intel_context *ce,
 			    struct i915_vma *vma,
 			    u32 dword,
@@ -1355,6 +1459,7 @@ int intel_memory_region_mock_selftests(void)
 		SUBTEST(igt_mock_splintered_region),
 		SUBTEST(igt_mock_max_segment),
 		SUBTEST(igt_mock_io_size),
+		SUBTEST(igt_mock_cleared_pool),
 	};
 	struct intel_memory_region *mem;
 	struct drm_i915_private *i915;
@@ -107,6 +107,87 @@ static int intel_shadow_table_check(void)
 	return 0;
 }
 
+static enum forcewake_domains
+fw_bsearch_domains(const struct intel_forcewake_range *ranges,
+		   unsigned int num_ranges, u32 offset)
+{
+	const struct intel_forcewake_range *entry;
+
+	entry = BSEARCH(offset, ranges, num_ranges, fw_range_cmp);
+	return entry ? entry->domains : 0;
+}
+
+static int intel_fw_lookup_check(const char *name,
+				 const struct intel_forcewake_range *ranges,
+				 unsigned int num_ranges,
+				 const struct i915_range *shadow,
+				 unsigned int num_shadow)
+{
+	struct intel_uncore_fw_lookup lookup;
+	u64 sum[2] = {};
+	ktime_t dt[2];
+	u32 offset, end;
+	int err;
+
+	err = fw_lookup_init(&lookup, ranges, num_ranges, shadow, num_shadow);
+	if (err) {
+		pr_err("%s: failed to build lookup for %s, err=%d\n",
+		       __func__, name, err);
+		return err;
+	}
+
+	/* Check every byte, including a page beyond the end of the tables */
+	end = (lookup.num_pages + 1) << FW_LOOKUP_PAGE_SHIFT;
+	for (offset = 0; offset < end; offset++) {
+		enum forcewake_domains expected, found;
+
+		expected = fw_bsearch_domains(ranges, num_ranges, offset);
+		found = fw_lookup_domains(&lookup, offset);
+		if (found != expected) {
+			pr_err("%s: %s lookup of %06x gave domains %x, expected %x\n",
+			       __func__, name, offset, found, expected);
+			err = -EINVAL;
+			goto out;
+		}
+
+		if (fw_lookup_shadowed(&lookup, offset) !=
+		    !!BSEARCH(offset, shadow, num_shadow, mmio_range_cmp)) {
+			pr_err("%s: %s lookup of %06x mismatched shadowing\n",
+			       __func__, name, offset);
+			err = -EINVAL;
+			goto out;
+		}
+
+		if (IS_ALIGNED(offset + 1, FW_LOOKUP_PAGE_SIZE))
+			cond_resched();
+	}
+
+	dt[0] = ktime_get_raw();
+	for (offset = 0; offset < end; offset += 4)
+		sum[0] += fw_bsearch_domains(ranges, num_ranges, offset);
+	dt[0] = ktime_sub(ktime_get_raw(), dt[0]);
+
+	dt[1] = ktime_get_raw();
+	for (offset = 0; offset < end; offset += 4)
+		sum[1] += fw_lookup_domains(&lookup, offset);
+	dt[1] = ktime_sub(ktime_get_raw(), dt[1]);
+
+	if (sum[0] != sum[1]) {
+		pr_err("%s: %s lookup checksum mismatch\n", __func__, name);
+		err = -EINVAL;
+		goto out;
+	}
+
+	pr_info("%s: %s %u ranges, bsearch %lluns, lookup %lluns per 1K registers\n",
+		__func__, name, num_ranges,
+		div64_u64(ktime_to_ns(dt[0]) * 1024, end / 4),
+		div64_u64(ktime_to_ns(dt[1]) * 1024, end / 4));
+
+out:
+	fw_lookup_fini(&lookup);
+	return err;
+}
+
 int intel_uncore_mock_selftests(void)
 {
 	struct {
@@ -124,6 +205,28 @@ int intel_uncore_mock_selftests(void)
 		{ __mtl_fw_ranges, ARRAY_SIZE(__mtl_fw_ranges), true },
 		{ __xelpmp_fw_ranges, ARRAY_SIZE(__xelpmp_fw_ranges), true },
 	};
+#define FW_LOOKUP(fw__, shadow__) \
+	{ #fw__, fw__, ARRAY_SIZE(fw__), shadow__, ARRAY_SIZE(shadow__) }
+	struct {
+		const char *name;
+		const struct intel_forcewake_range *ranges;
+		unsigned int num_ranges;
+		const struct i915_range *shadow;
+		unsigned int num_shadow;
+	} lookup[] = {
+		FW_LOOKUP(__gen6_fw_ranges, gen8_shadowed_regs),
+		{ "__vlv_fw_ranges", __vlv_fw_ranges, ARRAY_SIZE(__vlv_fw_ranges) },
+		FW_LOOKUP(__chv_fw_ranges, gen8_shadowed_regs),
+		FW_LOOKUP(__gen9_fw_ranges, gen8_shadowed_regs),
+		FW_LOOKUP(__gen11_fw_ranges, gen11_shadowed_regs),
+		FW_LOOKUP(__gen12_fw_ranges, gen12_shadowed_regs),
+		FW_LOOKUP(__xehp_fw_ranges, gen12_shadowed_regs),
+		FW_LOOKUP(__dg2_fw_ranges, dg2_shadowed_regs),
+		FW_LOOKUP(__pvc_fw_ranges, pvc_shadowed_regs),
+		FW_LOOKUP(__mtl_fw_ranges, mtl_shadowed_regs),
+		FW_LOOKUP(__xelpmp_fw_ranges, xelpmp_shadowed_regs),
+	};
+#undef FW_LOOKUP
 	int err, i;
 
 	for (i = 0; i < ARRAY_SIZE(fw); i++) {
@@ -138,6 +241,16 @@ int intel_uncore_mock_selftests(void)
 	if (err)
 		return err;
 
+	for (i = 0; i < ARRAY_SIZE(lookup); i++) {
+		err = intel_fw_lookup_check(lookup[i].name,
+					    lookup[i].ranges,
+					    lookup[i].num_ranges,
+					    lookup[i].shadow,
+					    lookup[i].num_shadow);
+		if (err)
+			return err;
+	}
+
 	return 0;
 }
 
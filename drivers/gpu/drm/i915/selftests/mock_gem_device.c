@@ -199,7 +199,10 @@ struct drm_i915_private *mock_gem_device(void)
 
 	spin_lock_init(&i915->gpu_error.lock);
 
-	i915_gem_init__mm(i915);
+	ret = i915_gem_init__mm(i915);
+	if (ret)
+		goto err_mm;
+
 	intel_root_gt_init_early(i915);
 	mock_uncore_init(&i915->uncore, i915);
 	atomic_inc(&to_gt(i915)->wakeref.count); /* disable; no hw support */
@@ -255,6 +258,7 @@ struct drm_i915_private *mock_gem_device(void)
 	intel_region_ttm_device_fini(i915);
 err_ttm:
 	intel_gt_driver_late_release_all(i915);
+err_mm:
 	intel_memory_regions_driver_release(i915);
 	drm_mode_config_cleanup(&i915->drm);
 	mock_destroy_device(i915);
@@ -269,3 +273,22 @@ void mock_destroy_device(struct drm_i915_private *i915)
 	devres_release_group(dev, NULL);
 	put_device(dev);
 }
+
+int __mock_gem_device_subtests(const char *caller,
+			       const struct i915_subtest *st,
+			       unsigned int count)
+{
+	struct drm_i915_private *i915;
+	int err;
+
+	i915 = mock_gem_device();
+	if (!i915)
+		return -ENOMEM;
+
+	err = __i915_subtests(caller,
+			      __i915_nop_setup, __i915_nop_teardown,
+			      st, count, i915);
+
+	mock_destroy_device(i915);
+	return err;
+}
@@ -3,10 +3,18 @@
 #define __MOCK_GEM_DEVICE_H__
 
 struct drm_i915_private;
+struct i915_subtest;
 
 struct drm_i915_private *mock_gem_device(void);
 void mock_device_flush(struct drm_i915_private *i915);
 
 void mock_destroy_device(struct drm_i915_private *i915);
 
+/* Run the subtests against a fresh mock device, passed as their argument */
+int __mock_gem_device_subtests(const char *caller,
+			       const struct i915_subtest *st,
+			       unsigned int count);
+#define mock_gem_device_subtests(T) \
+	__mock_gem_device_subtests(__func__, T, ARRAY_SIZE(T))
+
 #endif /* !__MOCK_GEM_DEVICE_H__ */
@@ -806,6 +806,13 @@ typedef struct drm_i915_irq_wait {
  */
 #define I915_PARAM_PXP_STATUS		 58
 
+/*
+ * Query whether DRM_I915_GEM_EXECBUFFER2 supports registering a per-context
+ * resident set through drm_i915_gem_execbuffer_ext_resident_set. See
+ * I915_EXEC_USE_EXTENSIONS.
+ */
+#define I915_PARAM_HAS_EXEC_RESIDENT_SET 59
+
 /* Must be kept compact -- no holes and well documented */
 
 /**
@@ -1372,6 +1379,47 @@ struct drm_i915_gem_execbuffer_ext_timeline_fences {
 	__u64 values_ptr;
 };
 
+/**
+ * struct drm_i915_gem_execbuffer_ext_resident_set - Resident set for
+ * execbuf ioctl.
+ *
+ * Clients that submit the same, large list of objects over and over can
+ * register that list once as the resident set of the context. Later
+ * submissions carrying this extension reuse the cached handle to vma
+ * lookup and validation for every element of &drm_i915_gem_execbuffer2.buffers_ptr
+ * that matches the element at the same index in the resident set (same
+ * handle, flags, alignment and pad_to_size, and for EXEC_OBJECT_PINNED the
+ * same offset). Any element that differs is looked up and validated as
+ * usual, so the resident set is only ever a hint and never changes the
+ * outcome of the execbuf.
+ *
+ * Only the lookup and validation are skipped. Every object is still locked,
+ * has its binding checked and gets the request fence on each submission,
+ * so that part of the cost remains proportional to the number of objects.
+ *
+ * The resident set is dropped whenever any object handle used by the
+ * context is closed, after which it must be registered again.
+ */
+struct drm_i915_gem_execbuffer_ext_resident_set {
+#define DRM_I915_GEM_EXECBUFFER_EXT_RESIDENT_SET 1
+	/** @base: Extension link. See struct i915_user_extension. */
+	struct i915_user_extension base;
+
+	/**
+	 * @flags: Resident set flags.
+	 *
+	 * I915_EXEC_RESIDENT_SET_UPDATE: Replace the resident set of the
+	 * context with the object list of this execbuf, once it has been
+	 * successfully submitted.
+	 */
+	__u32 flags;
+#define I915_EXEC_RESIDENT_SET_UPDATE (1u << 0)
+#define __I915_EXEC_RESIDENT_SET_UNKNOWN_FLAGS (-(I915_EXEC_RESIDENT_SET_UPDATE << 1))
+
+	/** @rsvd: Reserved, must be zero. */
+	__u32 rsvd;
+};
+
 /**
  * struct drm_i915_gem_execbuffer2 - Structure for DRM_I915_GEM_EXECBUFFER2
  * ioctl.
@@ -2831,9 +2879,57 @@ enum drm_i915_perf_property_id {
 	 */
 	DRM_I915_PERF_PROP_OA_ENGINE_INSTANCE,
 
+	/**
+	 * Specifying this property lets userspace mmap() the OA buffer of the
+	 * stream and consume reports in place, instead of having them copied
+	 * out with read(). See struct drm_i915_perf_oa_buffer_mmap.
+	 *
+	 * Only supported for streams that are not filtered for a single
+	 * context, since reports are exposed exactly as the OA unit wrote
+	 * them, and not before Gen8. read() then only returns
+	 * DRM_I915_PERF_RECORD_OA_BUFFER_LOST and
+	 * DRM_I915_PERF_RECORD_OA_REPORT_LOST status records and never blocks.
+	 *
+	 * This property is available in perf revision 8.
+	 */
+	DRM_I915_PERF_PROP_OA_BUFFER_MMAP,
+
 	DRM_I915_PERF_PROP_MAX /* non-ABI */
 };
 
+/**
+ * struct drm_i915_perf_oa_buffer_mmap - OA buffer control page
+ *
+ * Streams opened with DRM_I915_PERF_PROP_OA_BUFFER_MMAP expose this page,
+ * read-write, at mmap() offset 0 of the stream fd. The OA buffer itself can
+ * be mapped read-only, in full, at @offset.
+ *
+ * Reports in [@head, @tail) have landed and belong to userspace. Once
+ * consumed, userspace advances @head by a multiple of @report_size, wrapping
+ * modulo @size, and the kernel picks it up on its next poll of the OA buffer
+ * (or on read()). Note that a report may wrap around the end of the buffer
+ * if @report_size isn't a power of two.
+ *
+ * After a DRM_I915_PERF_RECORD_OA_BUFFER_LOST status record, or re-enabling
+ * the stream, both @head and @tail restart at 0.
+ */
+struct drm_i915_perf_oa_buffer_mmap {
+	/** @head: Offset of the oldest unconsumed report, set by userspace. */
+	__u32 head;
+
+	/** @tail: Offset just past the newest landed report, set by i915. */
+	__u32 tail;
+
+	/** @size: Size of the OA buffer in bytes. */
+	__u32 size;
+
+	/** @report_size: Size of a single OA report in bytes. */
+	__u32 report_size;
+
+	/** @offset: mmap() offset of the OA buffer. */
+	__u64 offset;
+};
+
 struct drm_i915_perf_open_param {
 	__u32 flags;
 #define I915_PERF_FLAG_FD_CLOEXEC	(1<<0)